@@ -0,0 +1,44 @@
+#!/bin/bash
+die() { echo "$@" >&2; exit 1
+}
+
+echo 'Testing the implementations of rowBitDifference'
+
+REG_DIR=`pwd`/regression-tests/BitKernels
+[ -d "$REG_DIR" ] || die "should be run from top-level directory of the SANA repo"
+[ -x "$EXE" ] || die "can't find executable '$EXE'"
+TMPDIR=/tmp/regression-bitkernels.$$
+trap "/bin/rm -rf $TMPDIR" 0 1 2 3 15
+mkdir $TMPDIR
+
+# EC alone counts the aligned edges with rowBitDifference (see SANA::aligEdgesBitRowsChangeOp).
+# fixed iterations, schedule and seed, so that the runs are deterministic
+ARGS="-g1 syeast0 -g2 syeast05 -ec 1 -s3 0 -itm 5 -tinitial 1 -tdecay 5 -seed 7 -profile"
+NUM_FAILS=0
+
+KERNELS=scalar
+grep -qw avx2 /proc/cpuinfo && KERNELS="$KERNELS avx2"
+grep -qw avx512f /proc/cpuinfo && KERNELS="$KERNELS avx512"
+
+for kernel in $KERNELS; do
+    echo "Testing $kernel"
+    ROW_BIT_DIFFERENCE=$kernel "$EXE" $ARGS -o $TMPDIR/$kernel &> $TMPDIR/$kernel.progress || die "the run with $kernel failed"
+    if ! fgrep -q "\"aligned edges kernel\": \"$kernel\"" $TMPDIR/$kernel.profile.json; then
+	echo "the run with ROW_BIT_DIFFERENCE=$kernel did not use it"
+	(( NUM_FAILS++ ))
+    fi
+    # the incremental EC is checked against a full evaluation at each progress report
+    if fgrep -q 'internal error' $TMPDIR/$kernel.progress; then
+	echo "the incremental score with $kernel does not match the evaluation:"
+	fgrep 'internal error' $TMPDIR/$kernel.progress | head -3
+	(( NUM_FAILS++ ))
+    fi
+    # every move is accepted or rejected the same way, so the alignments are the same
+    if ! cmp -s $TMPDIR/scalar.align $TMPDIR/$kernel.align; then
+	echo "the alignment with $kernel differs from the one with scalar"
+	(( NUM_FAILS++ ))
+    fi
+done
+
+echo "Done testing the implementations of rowBitDifference; $NUM_FAILS failures"
+exit $NUM_FAILS
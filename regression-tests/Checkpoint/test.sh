@@ -0,0 +1,44 @@
+#!/bin/bash
+die() { echo "$@" >&2; exit 1
+}
+
+echo 'Testing checkpoint and resume'
+
+REG_DIR=`pwd`/regression-tests/Checkpoint
+[ -d "$REG_DIR" ] || die "should be run from top-level directory of the SANA repo"
+[ -x "$EXE" ] || die "can't find executable '$EXE'"
+TMPDIR=/tmp/regression-checkpoint.$$
+trap "/bin/rm -rf $TMPDIR" 0 1 2 3 15
+mkdir $TMPDIR
+
+# fixed iterations, schedule and seed, so that the runs are deterministic
+ARGS="-g1 syeast0 -g2 syeast05 -s3 1 -itm 40 -tinitial 1 -tdecay 5 -seed 7"
+NUM_FAILS=0
+
+echo "Test 1: full run"
+"$EXE" $ARGS -o $TMPDIR/full &> $TMPDIR/full.progress || die "the full run failed"
+
+echo "Test 2: the same run, stopped after a second with a checkpoint"
+(sleep 1; echo stop > $TMPDIR/control) &
+"$EXE" $ARGS -checkpoint $TMPDIR/run.checkpoint -controlfile $TMPDIR/control -o $TMPDIR/stopped &> $TMPDIR/stopped.progress || die "the stopped run failed"
+wait
+if ! fgrep -q 'Stop requested' $TMPDIR/stopped.progress; then
+    echo "the run ended before it was stopped; increase -itm in $0"
+    (( NUM_FAILS++ ))
+fi
+
+echo "Test 3: resumed from the checkpoint"
+"$EXE" $ARGS -resume $TMPDIR/run.checkpoint -o $TMPDIR/resumed &> $TMPDIR/resumed.progress || die "the resumed run failed"
+if ! cmp -s $TMPDIR/full.align $TMPDIR/resumed.align; then
+    echo "the resumed run did not end with the alignment of the full run"
+    (( NUM_FAILS++ ))
+fi
+
+echo "Test 4: resuming with a different objective function is refused"
+if "$EXE" $ARGS -combinedScoreAs product -resume $TMPDIR/run.checkpoint -o $TMPDIR/product &> $TMPDIR/product.progress; then
+    echo "the checkpoint was resumed with a different score aggregation"
+    (( NUM_FAILS++ ))
+fi
+
+echo "Done testing checkpoint and resume; $NUM_FAILS failures"
+exit $NUM_FAILS
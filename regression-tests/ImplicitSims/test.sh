@@ -0,0 +1,30 @@
+#!/bin/bash
+die() { echo "$@" >&2; exit 1
+}
+
+echo 'Testing implicit similarities'
+
+REG_DIR=`pwd`/regression-tests/ImplicitSims
+[ -d "$REG_DIR" ] || die "should be run from top-level directory of the SANA repo"
+[ -x "$EXE" ] || die "can't find executable '$EXE'"
+TMPDIR=/tmp/regression-implicitsims.$$
+trap "/bin/rm -rf $TMPDIR" 0 1 2 3 15
+mkdir $TMPDIR
+
+ARGS="-g1 syeast0 -g2 syeast05 -itm 3 -tinitial 1 -tdecay 5 -seed 7"
+NUM_FAILS=0
+
+# a single implicit measure, two of them, and implicit measures mixed with one that has a matrix
+for weights in "-s3 0.7 -edgec 0.3" "-s3 0.5 -edgec 0.25 -noded 0.25" "-s3 0.5 -edgec 0.2 -importance 0.2 -graphletnorm 0.1"; do
+    name=`echo $weights | tr -d ' .-'`
+    echo "Testing $weights"
+    "$EXE" $ARGS $weights -o $TMPDIR/$name-dense &> $TMPDIR/$name-dense.progress || die "the dense run with $weights failed"
+    "$EXE" $ARGS $weights -implicitsims -o $TMPDIR/$name-implicit &> $TMPDIR/$name-implicit.progress || die "the implicit run with $weights failed"
+    if ! cmp -s $TMPDIR/$name-dense.align $TMPDIR/$name-implicit.align; then
+	echo "the alignment with $weights -implicitsims differs from the one with dense matrices"
+	(( NUM_FAILS++ ))
+    fi
+done
+
+echo "Done testing implicit similarities; $NUM_FAILS failures"
+exit $NUM_FAILS
@@ -0,0 +1,39 @@
+#!/bin/bash
+die() { echo "$@" >&2; exit 1
+}
+
+echo 'Testing the incremental evaluation of JS'
+
+REG_DIR=`pwd`/regression-tests/JaccardSimilarity
+[ -d "$REG_DIR" ] || die "should be run from top-level directory of the SANA repo"
+[ -x "$EXE" ] || die "can't find executable '$EXE'"
+TMPDIR=/tmp/regression-js.$$
+trap "/bin/rm -rf $TMPDIR" 0 1 2 3 15
+mkdir $TMPDIR
+
+ARGS="-g1 syeast0 -g2 syeast05 -itm 5 -tinitial 1 -tdecay 5 -seed 7"
+NUM_FAILS=0
+
+# SANA evaluates the alignment from scratch at each progress report and prints an internal error
+# if the incrementally computed score differs; JS alone, and fused with EC and S3
+for weights in "-s3 0 -js 1" "-s3 0 -ec 0.5 -js 0.5" "-s3 0.5 -js 0.5"; do
+    name=`echo $weights | tr -d ' .-'`
+    echo "Testing $weights"
+    "$EXE" $ARGS $weights -o $TMPDIR/$name &> $TMPDIR/$name.progress || die "the run with $weights failed"
+    if fgrep -q 'internal error' $TMPDIR/$name.progress; then
+        echo "the incremental score with $weights does not match the evaluation:"
+        fgrep 'internal error' $TMPDIR/$name.progress | head -3
+        (( NUM_FAILS++ ))
+    fi
+done
+
+# with JS alone, the last score of the run is the JS of the final alignment in the report
+final=`grep 'score = ' $TMPDIR/s30js1.progress | tail -1 | sed 's/.*score = \([^ ]*\).*/\1/'`
+reported=`awk '$1=="js:"{print $2}' $TMPDIR/s30js1.out`
+if [ "$final" != "$reported" ]; then
+    echo "the final incremental JS is $final but the report says $reported"
+    (( NUM_FAILS++ ))
+fi
+
+echo "Done testing the incremental evaluation of JS; $NUM_FAILS failures"
+exit $NUM_FAILS
@@ -0,0 +1,43 @@
+#!/bin/bash
+die() { echo "$@" >&2; exit 1
+}
+
+echo 'Testing the cache of similarity matrices'
+
+REG_DIR=`pwd`/regression-tests/SimCache
+[ -d "$REG_DIR" ] || die "should be run from top-level directory of the SANA repo"
+[ -x "$EXE" ] || die "can't find executable '$EXE'"
+EXE=`cd \`dirname "$EXE"\` && pwd`/`basename "$EXE"`
+NETS=`pwd`/networks
+TMPDIR=/tmp/regression-simcache.$$
+trap "/bin/rm -rf $TMPDIR" 0 1 2 3 15
+mkdir $TMPDIR
+
+ARGS="-fg1 $NETS/syeast0/syeast0.el -fg2 $NETS/syeast05/syeast05.el -s3 0.5 -edgec 0.25 -importance 0.25 -itm 3 -tinitial 1 -tdecay 5 -seed 7"
+NUM_FAILS=0
+
+# each mode runs in its own directory, so that the first run starts with an empty autogenerated/matrices/
+for mode in dense topk; do
+    extra=''
+    [ $mode = topk ] && extra='-simtopk 20'
+    mkdir $TMPDIR/$mode
+    for run in miss hit nosimcache; do
+	flags="$extra"
+	[ $run = nosimcache ] && flags="$flags -nosimcache"
+	echo "Testing $mode, cache $run"
+	(cd $TMPDIR/$mode && "$EXE" $ARGS $flags -o $run &> $run.progress) || die "the $mode run ($run) failed"
+    done
+    if ! fgrep -q 'Loading binary sim matrix' $TMPDIR/$mode/hit.progress; then
+	echo "$mode: the second run did not use the cache"
+	(( NUM_FAILS++ ))
+    fi
+    for run in hit nosimcache; do
+	if ! cmp -s $TMPDIR/$mode/miss.align $TMPDIR/$mode/$run.align; then
+	    echo "$mode: the alignment with the cache $run differs from the one with the cache miss"
+	    (( NUM_FAILS++ ))
+	fi
+    done
+done
+
+echo "Done testing the cache of similarity matrices; $NUM_FAILS failures"
+exit $NUM_FAILS
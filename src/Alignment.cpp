@@ -1,3 +1,4 @@
+#include <limits>
 #include "Alignment.hpp"
 #include "Graph.hpp"
 #include "utils/utils.hpp"
@@ -259,6 +260,11 @@ void Alignment::printDefinitionErrors(const Graph& G1, const Graph& G2) {
 //precondition: a valid color-restricted matching exists between G1 and G2
 //equivalently: every color in G1 has at least as many nodes in G2
 Alignment Alignment::randomColorRestrictedAlignment(const Graph& G1, const Graph& G2) {
+    Xoshiro256 gen(randInt(0, numeric_limits<int>::max()));
+    return randomColorRestrictedAlignment(G1, G2, gen);
+}
+
+Alignment Alignment::randomColorRestrictedAlignment(const Graph& G1, const Graph& G2, Xoshiro256& gen) {
     vector<uint> g2ColIdToG1ColId = G2.myColorIdsToOtherGraphColorIds(G1);
     vector<vector<uint>> g1ColIdToG2Nodes(G1.numColors());
     for (uint g2Node = 0; g2Node < G2.getNumNodes(); g2Node++) {
@@ -267,8 +273,11 @@ Alignment Alignment::randomColorRestrictedAlignment(const Graph& G1, const Graph
         if (g1ColId == Graph::INVALID_COLOR_ID) continue;
         g1ColIdToG2Nodes[g1ColId].push_back(g2Node);
     }
+    //Fisher-Yates shuffle of each color (std::shuffle would need a uniform_int_distribution over
+    //the 64-bit numbers of gen, which some versions of libstdc++ reject in strict ANSI mode)
     for (uint g1ColId = 0; g1ColId < G1.numColors(); g1ColId++) {
-        randomShuffle(g1ColIdToG2Nodes[g1ColId]);
+        vector<uint>& nodes = g1ColIdToG2Nodes[g1ColId];
+        for (uint i = nodes.size(); i > 1; i--) swap(nodes[i-1], nodes[gen.boundedInt(i)]);
     }
     
     vector<uint> A(0);
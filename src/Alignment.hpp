@@ -8,6 +8,8 @@
 #include <iostream>
 #include <cassert>
 #include <algorithm>
+#include <random>
+#include "utils/Xoshiro256.hpp"
 #include "Graph.hpp"
 #include "utils/utils.hpp"
 
@@ -32,6 +34,8 @@ public:
     static Alignment loadPartialEdgeList(const Graph& G1, const Graph& G2, const string& fileName, bool byName);
     static Alignment loadMapping(const string& fileName);
     static Alignment randomColorRestrictedAlignment(const Graph& G1, const Graph& G2);
+    //same, but drawing from 'gen' instead of the global generator (safe to use from several threads)
+    static Alignment randomColorRestrictedAlignment(const Graph& G1, const Graph& G2, Xoshiro256& gen);
     
     //returns a random alignment from a graph with n1 nodes to a graph with nodes n2 >= n1 nodes
     static Alignment random(uint n1, uint n2);
@@ -15,12 +15,40 @@
 #include <errno.h>
 #include <unistd.h>
 #include <regex>
+#include <type_traits>
 
 using namespace std;
 
 //static attributes
 const string Graph::DEFAULT_COLOR_NAME = "__default"; 
 const uint Graph::INVALID_COLOR_ID = 9999999;
+const size_t Graph::MAX_DENSE_ADJACENCY_BYTES = 512*1024*1024;
+string Graph::adjacencyRepresentation = "auto";
+
+void Graph::setAdjacencyRepresentation(const string& representation) {
+    if (representation != "auto" and representation != "dense" and representation != "hybrid")
+        throw runtime_error("unknown adjacency representation '"+representation+"' (should be auto, dense or hybrid)");
+    adjacencyRepresentation = representation;
+}
+
+#ifndef SPARSE
+//hubLength of the HybridMatrix of a graph with numNodes nodes and numEntries entries in its adjacency
+//lists (see setAdjacencyRepresentation). 0 means a dense matrix
+static uint adjacencyHubLength(uint numNodes, size_t numEntries, const string& representation) {
+    if (representation == "dense") return 0;
+    //bytes of a dense row, and of each entry of a sorted neighbor array (the neighbor and the weight)
+    const bool bitPacked = is_same<EDGE_T, bool>::value;
+    double rowBytes = bitPacked ? numNodes/8.0 : (double) numNodes*sizeof(EDGE_T);
+    double entryBytes = sizeof(uint) + (bitPacked ? 1/8.0 : sizeof(EDGE_T));
+    if (representation == "auto") {
+        double denseBytes = rowBytes*numNodes;
+        double hybridBytes = numEntries*entryBytes + (double) numNodes*(sizeof(uint)+sizeof(size_t));
+        if (denseBytes <= Graph::MAX_DENSE_ADJACENCY_BYTES or hybridBytes >= denseBytes/2) return 0;
+    }
+    //a node gets a dense row if its sorted neighbor array would not be smaller
+    return max(1u, (uint) ceil(rowBytes/entryBytes));
+}
+#endif
 
 Graph::Graph(const string& graphName, const string& optionalFilePath,
              const vector<array<uint, 2>>& edgeList,
@@ -59,7 +87,11 @@ Graph::Graph(const string& graphName, const string& optionalFilePath,
     assert(uniformWeights or optionalEdgeWeights.size() == edgeList.size());
 
     adjLists.resize(numNodes);
-    adjMatrix = Matrix<EDGE_T>(numNodes);
+#ifdef SPARSE
+    adjMatrix = AdjacencyMatrix(numNodes);
+#else
+    vector<vector<EDGE_T>> adjWeights(uniformWeights ? 0 : numNodes); //parallel to adjLists
+#endif
     totalWeight = vector<double>(numNodes, 0.0);
     totalEdgeWeight = 0;
     for (uint i = 0; i < edgeList.size(); i++) {
@@ -73,13 +105,39 @@ Graph::Graph(const string& graphName, const string& optionalFilePath,
         if (uniformWeights) weight = 1;
         else weight = optionalEdgeWeights[i];
         if (weight == 0) throw runtime_error("edges with weight 0 are not supported");
+#ifdef SPARSE
         if (adjMatrix[node1][node2] != 0 or adjMatrix[node2][node1] != 0)
             throw runtime_error("repeated edge in edge list passed to graph constructor");
         adjMatrix[node1][node2] = adjMatrix[node2][node1] = weight;
+#else
+        if (not uniformWeights) {
+            adjWeights[node1].push_back(weight);
+            if (node1 != node2) adjWeights[node2].push_back(weight);
+        }
+#endif
 	totalWeight[node1] += weight;
 	totalWeight[node2] += weight;
         totalEdgeWeight += weight;
     }
+#ifndef SPARSE
+    size_t numEntries = 0;
+    for (const auto& nbrs : adjLists) numEntries += nbrs.size();
+    uint hubLength = adjacencyHubLength(numNodes, numEntries, adjacencyRepresentation);
+    try {
+        adjMatrix = AdjacencyMatrix(numNodes, adjLists, adjWeights, hubLength);
+    } catch (const runtime_error&) {
+        throw runtime_error("repeated edge in edge list passed to graph constructor");
+    }
+#endif
+#if defined(BIT_ADJACENCY) and defined(MULTI_PAIRWISE)
+    if (adjMatrix.isDense()) {
+        adjBits = BitMatrix(numNodes, numNodes);
+        for (const auto& edge : edgeList) {
+            adjBits.set(edge[0], edge[1], true);
+            adjBits.set(edge[1], edge[0], true);
+        }
+    }
+#endif
     initColorDataStructs(partialNodeColorPairs);
 }   
 
@@ -408,6 +466,17 @@ vector<string> Graph::commonNodeNames(const Graph& other) const {
     res.shrink_to_fit();
     return res;
 }
+uint64_t Graph::contentHash() const {
+    uint64_t hash = 14695981039346656037ULL;
+    for (const string& name : nodeNames) hash = hashString(name, hash);
+    hash = hashBytes(edgeList.data(), edgeList.size()*sizeof(edgeList[0]), hash);
+    for (const auto& edge : edgeList) {
+        EDGE_T w = getEdgeWeight(edge[0], edge[1]);
+        hash = hashBytes(&w, sizeof(w), hash);
+    }
+    for (const string& colorName : colorNames) hash = hashString(colorName, hash);
+    return hashBytes(nodeColors.data(), nodeColors.size()*sizeof(nodeColors[0]), hash);
+}
 
 // NODE COLOR SYSTEM
 
@@ -457,7 +526,11 @@ void Graph::debugPrint() const {
     for (uint i = 0; i < min(adjLists[0].size(), MAX_LEN); i++) cerr<<adjLists[0][i]<<' ';
     if (MAX_LEN < adjLists[0].size()) cerr<<"..."; cerr<<endl;
 
-    cerr<<"adjMatrix size: "<<adjMatrix.size()<<endl;
+    cerr<<"adjMatrix size: "<<adjMatrix.size();
+#ifndef SPARSE
+    if (not adjMatrix.isDense()) cerr<<" (hybrid, with "<<adjMatrix.numHubRows()<<" dense rows)";
+#endif
+    cerr<<endl;
 
     cerr<<"nodeNames (size "<<nodeNames.size()<<"): ";
     for (uint i = 0; i < min(nodeNames.size(), MAX_LEN); i++) cerr<<nodeNames[i]<<' ';
@@ -15,6 +15,8 @@
 #include "utils/Timer.hpp"
 #include "computeGraphlets.hpp"
 #include "utils/Matrix.hpp"
+#include "utils/SparseMatrix.hpp"
+#include "utils/HybridMatrix.hpp"
 
 using namespace std;
 
@@ -34,6 +36,22 @@ using namespace std;
   #endif
 #endif
 
+//unless built with "make SPARSE=1", the adjacency matrix is a HybridMatrix whose representation is chosen
+//in the constructor of each graph: dense (and bit-packed for unweighted graphs) if it is small enough,
+//or else dense rows for the hubs and sorted neighbor arrays for the other nodes (see setAdjacencyRepresentation)
+#ifdef SPARSE
+typedef SparseMatrix<EDGE_T> AdjacencyMatrix;
+#else
+typedef HybridMatrix<EDGE_T> AdjacencyMatrix;
+#endif
+
+//BIT_ADJACENCY: whether the edges can be available as a bit matrix (see hasAdjBits and getAdjBits), which is
+//the case in the default (unweighted) and multi-pairwise builds when the adjacency matrix is dense.
+//For unweighted graphs, it is the adjacency matrix itself
+#if not defined(SPARSE) and not defined(FLOAT_WEIGHTS)
+  #define BIT_ADJACENCY
+#endif
+
 class Graph {
 public:
     /* All-purpose constructor
@@ -82,7 +100,13 @@ public:
     uint getNumNodes() const { return adjLists.size(); }
     uint getNumEdges() const { return edgeList.size(); }
     //note: edges with weight 0 are not supported
+#if defined(BIT_ADJACENCY) and defined(MULTI_PAIRWISE)
+    bool hasEdge(uint node1, uint node2) const {
+        return hasAdjBits() ? adjBits.get(node1, node2) : adjMatrix.get(node1, node2) != 0;
+    }
+#else
     bool hasEdge(uint node1, uint node2) const { return adjMatrix.get(node1, node2) != 0; }
+#endif
     //returns 0 if there is no edge; the order of the arguments is irrelevant
     EDGE_T getEdgeWeight(uint node1, uint node2) const { return adjMatrix.get(node1, node2); }
     bool hasNodeName(const string& nodeName) const { return nodeNameToIndexMap.count(nodeName); }
@@ -91,14 +115,25 @@ public:
     uint getNumNbrs(uint node) const { return adjLists[node].size(); }
     double getTotalEdgeWeight() const { return totalEdgeWeight; }
     double getTotalWeight(uint node) const { return totalWeight[node]; }
-    bool hasSelfLoop(uint node) const { return adjMatrix.get(node, node) != 0; }
+    bool hasSelfLoop(uint node) const { return hasEdge(node, node); }
     
     //large data structures are returned as const pointers
     //recommendation: use the getters above instead, when possible
     const vector<uint>* getAdjList(uint node) const { return &adjLists.at(node); }
     const vector<vector<uint>>* getAdjLists() const { return &adjLists; }
     const vector<array<uint, 2>>* getEdgeList() const { return &edgeList; }
-    const Matrix<EDGE_T>* getAdjMatrix() const { return &adjMatrix; }
+    const AdjacencyMatrix* getAdjMatrix() const { return &adjMatrix; }
+#ifdef BIT_ADJACENCY
+    //whether getAdjBits can be called, i.e., whether the adjacency matrix is dense
+    bool hasAdjBits() const { return adjMatrix.isDense(); }
+    //row i has bit j set iff there is an edge between i and j. kernels can read the rows
+    //directly (see BitMatrix::row and rowBitDifference)
+  #ifdef MULTI_PAIRWISE
+    const BitMatrix& getAdjBits() const { return adjBits; }
+  #else
+    const BitMatrix& getAdjBits() const { return adjMatrix.getDenseRows().getBits(); }
+  #endif
+#endif
     const vector<string>* getNodeNames() const { return &nodeNames; }
     const unordered_map<string,uint>* getNodeNameToIndexMap() const { return &nodeNameToIndexMap; }
 
@@ -113,6 +148,9 @@ public:
     vector<uint> nodesAround(uint node, uint maxDist) const;
     bool hasSameNodeNamesAs(const Graph& other) const;
     vector<string> commonNodeNames(const Graph& other) const;
+    //hash of the node names, edges, edge weights and colors (but not the graph name), to recognize
+    //the same network in caches. it depends on the order of the nodes and edges in the file
+    uint64_t contentHash() const;
     
     // COLOR SYSTEM
     //colors have arbitrary strings as names. internally, they also have a numeric
@@ -144,6 +182,15 @@ public:
     //creates the vector of pairs that the constructor needs
     vector<array<string, 2>> colorsAsNodeColorNamePairs() const;
 
+    /* Representation of the adjacency matrix of the graphs constructed afterwards (except in SPARSE builds):
+    - "dense": a dense matrix, bit-packed for unweighted graphs
+    - "hybrid": dense rows for the nodes whose sorted neighbor array would take more memory than a dense row,
+      and sorted neighbor arrays for the rest (see HybridMatrix)
+    - "auto" (default): dense if it takes at most MAX_DENSE_ADJACENCY_BYTES or the graph is so dense
+      that the hybrid matrix would not take less than half of it; hybrid otherwise */
+    static void setAdjacencyRepresentation(const string& representation);
+    static const size_t MAX_DENSE_ADJACENCY_BYTES;
+
     //check for internal consistency. good practice to keep it in an "assert"
     //after constructing or modifying a graph
     bool isWellDefined() const;
@@ -156,7 +203,11 @@ private:
     vector<array<uint, 2>> edgeList; //edges in no particular order, no repetitions
     vector<string> nodeNames;
     vector<vector<uint>> adjLists; //neighbors in no particular order, no repetitions
-    Matrix<EDGE_T> adjMatrix;
+    AdjacencyMatrix adjMatrix;
+#if defined(BIT_ADJACENCY) and defined(MULTI_PAIRWISE)
+    BitMatrix adjBits; //the edges of adjMatrix, whatever their weight. Empty if adjMatrix is not dense
+#endif
+    static string adjacencyRepresentation;
     unordered_map<string, uint> nodeNameToIndexMap; //reverse of nodeNames
 
     //each edge has a weight in the range of type EDGE_T, but their sum may be beyond that range
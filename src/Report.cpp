@@ -2,6 +2,7 @@
 #include "utils/utils.hpp"
 #include "utils/randomSeed.hpp"
 #include "utils/FileIO.hpp"
+#include "utils/Profiler.hpp"
 #include "arguments/GraphLoader.hpp"
 #include "measures/EdgeCorrectness.hpp"
 #include "measures/InducedConservedStructure.hpp"
@@ -176,6 +177,12 @@ void Report::saveLocalMeasures(const Graph& G1, const Graph& G2, const Alignment
     cout << "Took " << T.elapsed() << " seconds to save the alignment and scores." << endl;
 }
 
+void Report::saveProfile(const Graph& G1, const Graph& G2, const Alignment& A, const Method* method,
+                    const string& outputFileName) {
+    string fileName = formattedFileName(outputFileName, "profile.json", G1.getName(), G2.getName(), method, A);
+    Profiler::writeJSON(fileName);
+}
+
 void Report::saveCoreScore(const Graph& G1, const Graph& G2, const Alignment& A, const Method* method,
         CoreScoreData& csd, const string& outputFileName)
 {
@@ -18,6 +18,10 @@ static void saveReport(const Graph& G1, const Graph& G2, const Alignment& A,
 static void saveLocalMeasures(const Graph& G1, const Graph& G2, const Alignment& A,
     const MeasureCombination& M, const Method* method, const string& localMeasureFile);
 
+//saves the profile of the run (see Profiler) as JSON, with the same name as the report and extension .profile.json
+static void saveProfile(const Graph& G1, const Graph& G2, const Alignment& A, const Method* method,
+    const string& outputFileName);
+
 /*Some pair of nodes dubbed as "core alignment" appear to have greater affinity
   for aligning with each other as opposed to other nodes. We've tried to
   measure this affinity across iterations by assigning scores based on
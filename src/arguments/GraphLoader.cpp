@@ -2,6 +2,7 @@
 #include <chrono>
 #include <iostream>
 #include <set>
+#include <unordered_map>
 #include <sstream>
 #include <sys/types.h>
 #include <sys/stat.h>
@@ -606,18 +607,21 @@ Graph GraphLoader::pruneG1FromG2(const Graph& G1, const Graph& G2, const vector<
     if (G1ToG2NodeMap.size() != G1.getNumNodes())
         throw runtime_error("G1ToG2NodeMap size ("+to_string(G1ToG2NodeMap.size())+
                             ") not same as G1's number of nodes ("+to_string(G1.getNumNodes())+")");
-    //subtract the weights from the edges in 'G1' from a copy of G2's adjacency matrix
-    auto adjMat = *(G2.getAdjMatrix());
+    //subtract the weights from the edges in 'G1' from the weights of the corresponding edges of G2
+    //(G2's adjacency matrix cannot be modified, so the new weights of those edges are kept apart)
+    unordered_map<uint64_t, EDGE_T> prunedWeights;
+    auto edgeKey = [](uint u, uint v) { return u < v ? ((uint64_t) u << 32) | v : ((uint64_t) v << 32) | u; };
     uint numEdgesDownTo0 = 0;
     for (const auto& g1Edge : *(G1.getEdgeList())) {
         assert(G1.getEdgeWeight(g1Edge[0], g1Edge[1]) == 1 and "G1 is not unweighted");
         uint g2Node1 = G1ToG2NodeMap.at(g1Edge[0]), g2Node2 = G1ToG2NodeMap.at(g1Edge[1]);
         assert(g2Node1 < G2.getNumNodes() and g2Node2 < G2.getNumNodes());
-        assert(G2.getEdgeWeight(g2Node1, g2Node2) >= 1 and "edge cannot be pruned");            
-        assert(G2.getEdgeWeight(g2Node1, g2Node2) == adjMat[g2Node1][g2Node2] and "edge has already been pruned");
-        adjMat[g2Node1][g2Node2] -= 1;
-        adjMat[g2Node2][g2Node1] -= 1;
-        if (adjMat[g2Node1][g2Node2] == 0) numEdgesDownTo0++;        
+        assert(G2.getEdgeWeight(g2Node1, g2Node2) >= 1 and "edge cannot be pruned");
+        uint64_t key = edgeKey(g2Node1, g2Node2);
+        assert(prunedWeights.count(key) == 0 and "edge has already been pruned");
+        EDGE_T newWeight = G2.getEdgeWeight(g2Node1, g2Node2) - 1;
+        prunedWeights[key] = newWeight;
+        if (newWeight == 0) numEdgesDownTo0++;
     }
     //keep the edges in G2's edge list that still have positive weight
     vector<array<uint, 2>> newEdgeList;
@@ -626,7 +630,8 @@ Graph GraphLoader::pruneG1FromG2(const Graph& G1, const Graph& G2, const vector<
     newEdgeList.reserve(newNumEdges);
     newEdgeWeights.reserve(newNumEdges);
     for (const auto& g2Edge : *(G2.getEdgeList())) {
-        EDGE_T newWeight = adjMat.get(g2Edge[0], g2Edge[1]);
+        auto pruned = prunedWeights.find(edgeKey(g2Edge[0], g2Edge[1]));
+        EDGE_T newWeight = pruned == prunedWeights.end() ? G2.getEdgeWeight(g2Edge[0], g2Edge[1]) : pruned->second;
         assert(newWeight >= 0);
         if (newWeight > 0) {
             newEdgeList.push_back({g2Edge[0], g2Edge[1]});
@@ -5,9 +5,12 @@
 #include "measureSelector.hpp"
 
 #include "../utils/Timer.hpp"
+#include "../utils/Profiler.hpp"
 #include "../methods/NoneMethod.hpp"
 #include "../methods/HillClimbing.hpp"
 #include "../methods/SANA.hpp"
+#include "../methods/ReplicaExchange.hpp"
+#include "../methods/Portfolio.hpp"
 #include "../methods/RandomAligner.hpp"
 #include "../methods/wrappers/NETALWrapper.hpp"
 #include "../methods/wrappers/MIGRAALWrapper.hpp"
@@ -25,6 +28,7 @@
 #include "../methods/wrappers/CytoGEDEVOWrapper.hpp"
 
 #include "../schedulemethods/ScheduleMethod.hpp"
+#include "../schedulemethods/ScheduleCache.hpp"
 #include "../schedulemethods/scheduleUtils.hpp"
 #include "../schedulemethods/LinearRegressionVintage.hpp"
 
@@ -44,6 +48,10 @@ Method* MethodSelector::initMethod(const Graph& G1, const Graph& G2, ArgumentPar
                          or args.strings["-fcolor2"] != ""))
         cerr <<"Warning: only sana takes colors into consideration" << endl;
 
+    if (name == "sana" and args.doubles["-replicas"] > 1)
+        return static_cast<Method*>(initReplicaExchange(G1, G2, args, M, startAligName));
+    if (name == "sana" and args.doubles["-chains"] > 1)
+        return static_cast<Method*>(initPortfolio(G1, G2, args, M, startAligName));
     if (name == "sana")        return static_cast<Method*>(initSANA(G1, G2, args, M, startAligName));
     if (name == "hc")          return new HillClimbing(&G1, &G2, &M, startAligName);
     if (name == "random")      return new RandomAligner(&G1, &G2);
@@ -139,27 +147,92 @@ SANA* MethodSelector::initSANA(const Graph& G1, const Graph& G2,
         args.bools["-add-hill-climbing"], &M, args.strings["-combinedScoreAs"],
         startAlig, args.strings["-o"], args.strings["-localScoresFile"]);
 
-    if (useMethodForTIni or useMethodForTDecay) {
+    //when resuming, the temperature schedule is read from the checkpoint
+    bool resuming = (args.strings["-resume"] != "");
+    if ((useMethodForTIni or useMethodForTDecay) and not resuming) {
         if (scheduleMethodName == "auto" ) { //if user uses 'auto', choose for them
             scheduleMethodName = LinearRegressionVintage::NAME;
         }
         ScheduleMethod::setSana(sana);
+        ScheduleMethod::setWarmStart(args.bools["-warmstartpbad"]);
         auto scheduleMethod = getScheduleMethod(scheduleMethodName);
         scheduleMethod->setSampleTime(2);
-        ScheduleMethod::Resources maxRes(60, 200.0); //#samples, seconds
-        if (useMethodForTIni) {
-            sana->setTInitial(scheduleMethod->computeTInitial(maxRes));
-        }
-        if (useMethodForTDecay) {
-            sana->setTFinal(scheduleMethod->computeTFinal(maxRes));
-            sana->setTDecayFromTempRange();
+
+        //the schedule only depends on the networks and the objective function,
+        //so runs that differ only in the seed or the running time reuse it
+        bool useCache = not args.bools["-noschedulecache"];
+        string cacheFileName;
+        if (useCache) cacheFileName = ScheduleCache::fileName(G1, G2, M, args.strings["-combinedScoreAs"],
+            scheduleMethod->getName()+(ScheduleMethod::getWarmStart() ? " warmstart" : ""),
+            scheduleMethod->getTargetInitialPBad(), scheduleMethod->getTargetFinalPBad());
+        ScheduleCache::Entry cached;
+        if (useCache and ScheduleCache::load(cacheFileName, cached)) {
+            cout << "Using the temperature schedule cached in " << cacheFileName << endl;
+            if (useMethodForTIni) sana->setTInitial(cached.TInitial);
+            if (useMethodForTDecay) {
+                sana->setTFinal(cached.TFinal);
+                sana->setTDecayFromTempRange();
+            }
+        } else {
+            //the samples of a previous run with another schedule method or other target pBads
+            string curveFileName;
+            if (useCache) curveFileName = ScheduleCache::curveFileName(G1, G2, M, args.strings["-combinedScoreAs"],
+                ScheduleMethod::getWarmStart());
+            if (useCache and ScheduleCache::load(curveFileName, cached)) {
+                cout << "Warm-starting the temperature search from the " << cached.tempToPBad.size()
+                     << " pBad samples cached in " << curveFileName << endl;
+                scheduleMethod->addPBadSamples(cached.tempToPBad);
+            }
+            ScheduleMethod::Resources maxRes(60, 200.0); //#samples, seconds
+            Profiler::ScopedPhase phase("schedule estimation");
+            ScheduleMethod::setNumThreads((uint) args.doubles["-schedulethreads"]);
+            if (useMethodForTIni) {
+                sana->setTInitial(scheduleMethod->computeTInitial(maxRes));
+            }
+            if (useMethodForTDecay) {
+                sana->setTFinal(scheduleMethod->computeTFinal(maxRes));
+                sana->setTDecayFromTempRange();
+            }
+            ScheduleMethod::deleteWorkers();
+            scheduleMethod->printScheduleStatistics();
+            //only complete schedules are cached
+            if (useCache and useMethodForTIni and useMethodForTDecay) {
+                ScheduleCache::Entry entry = {sana->getTInitial(), sana->getTFinal(), scheduleMethod->getTempToPBad()};
+                ScheduleCache::save(cacheFileName, entry);
+                ScheduleCache::save(curveFileName, entry);
+            }
         }
-        scheduleMethod->printScheduleStatistics();
     }
     if (args.bools["-dynamictdecay"]) sana->setDynamicTDecay();
+    sana->setPBadSampleInterval((uint) args.doubles["-pbadsample"]);
+    if (args.strings["-checkpoint"] != "")
+        sana->setCheckpoints(args.strings["-checkpoint"], args.doubles["-checkpointinterval"]);
+    if (resuming) sana->setResumeFile(args.strings["-resume"]);
+    if (args.strings["-controlfile"] != "") sana->setControlFile(args.strings["-controlfile"]);
+    if (args.bools["-noipscache"]) sana->setUseIpsCache(false);
+    if (args.doubles["-topkmoves"] > 0) sana->setTopKMoveProb(args.doubles["-topkmoves"]);
     return sana;
 }
 
+ReplicaExchange* MethodSelector::initReplicaExchange(const Graph& G1, const Graph& G2,
+        ArgumentParser& args, MeasureCombination& M, string startAligName) {
+    if (args.bools["-dynamictdecay"])
+        throw runtime_error("-replicas cannot be combined with -dynamictdecay (replicas use fixed temperatures)");
+    if (args.doubles["-chains"] > 1) throw runtime_error("use only one of -replicas and -chains");
+    if (args.strings["-checkpoint"] != "" or args.strings["-resume"] != "")
+        throw runtime_error("-replicas cannot be combined with -checkpoint or -resume");
+    SANA* sana = initSANA(G1, G2, args, M, startAligName);
+    return new ReplicaExchange(&G1, &G2, sana, (uint) args.doubles["-replicas"]);
+}
+
+Portfolio* MethodSelector::initPortfolio(const Graph& G1, const Graph& G2,
+        ArgumentParser& args, MeasureCombination& M, string startAligName) {
+    if (args.strings["-checkpoint"] != "" or args.strings["-resume"] != "")
+        throw runtime_error("-chains cannot be combined with -checkpoint or -resume");
+    SANA* sana = initSANA(G1, G2, args, M, startAligName);
+    return new Portfolio(&G1, &G2, sana, (uint) args.doubles["-chains"]);
+}
+
 LGraalWrapper* MethodSelector::initLgraalWrapper(const Graph& G1,const Graph& G2, ArgumentParser& args) {
     string objFunType = args.strings["-objfuntype"];
     double alpha;
@@ -8,6 +8,8 @@
 #include "../methods/wrappers/LGraalWrapper.hpp"
 #include "../methods/wrappers/HubAlignWrapper.hpp"
 #include "../methods/wrappers/SANAPISWAPWrapper.hpp"
+#include "../methods/ReplicaExchange.hpp"
+#include "../methods/Portfolio.hpp"
 
 class MethodSelector {
 public:
@@ -20,6 +22,8 @@ static void validateTimeOrIterLimit(ArgumentParser& args);
 private:
 
 static SANA* initSANA(const Graph& G1, const Graph& G2, ArgumentParser& args, MeasureCombination& M, string startAligName=""); 
+static ReplicaExchange* initReplicaExchange(const Graph& G1, const Graph& G2, ArgumentParser& args, MeasureCombination& M, string startAligName);
+static Portfolio* initPortfolio(const Graph& G1, const Graph& G2, ArgumentParser& args, MeasureCombination& M, string startAligName);
 static LGraalWrapper* initLgraalWrapper(const Graph& G1,const Graph& G2, ArgumentParser& args);
 static HubAlignWrapper* initHubAlignWrapper(const Graph& G1, const Graph& G2, ArgumentParser& args);
 
@@ -32,7 +32,9 @@ vector<string> defaultArguments = {
 "-sec 0",
 "-maxGraphletSize 4",
 "-ms3_numer default",
-"-ms3_denom default"
+"-ms3_denom default",
+"-adjacency auto",
+"-simPrecision fp32"
 };
 
 //This file contains every argument supported by SANA contained basically inside an array, each element in the array contains 6 fields.
@@ -97,6 +99,25 @@ vector<array<string, 6>> supportedArguments = {
     { "-schedulemethod", "string", "auto", "Method to compute temperature schedule parameters automatically", "Specify the method to use set up the initial temperature and decay rate when they are set to 'auto'", "0" },
     { "-combinedScoreAs", "string", "sum", "Score Combo Method", "If multiple objectives are specified, this specifies how to combine them. Choices are: sum, product, inverse, max, min, maxFactor.", "1" },
     { "-dynamictdecay", "bool", "0", "Dynamically control temperature decay", "Whether or not tdecay is set to auto, this Boolean specifies if we should dynamically adjust the temperature schedule as the anneal progresses. Gives potentially better results than fixed decay rate.", "1" },
+    { "-replicas", "intD", "1", "Replica Exchange", "Number of SANA replicas to run in parallel threads (parallel tempering). Each replica iterates at a fixed temperature of a geometric ladder between the initial and final temperatures, and neighbouring replicas periodically exchange temperatures. 1 means a normal single-threaded anneal.", "0" },
+    { "-chains", "intD", "1", "Portfolio of Anneals", "Number of independent SANA anneals to run in parallel threads with different seeds. The graphs and similarity matrices are shared by all of them, and the best resulting alignment is kept. 1 means a single anneal.", "0" },
+    { "-pbadsample", "intD", "16", "pBad Sample Interval", "During the anneal, the pBad of only one in every this many bad moves is computed and used for the reported pBad statistics. It does not affect which moves are accepted. 1 means every bad move. The estimation of the temperature schedule always uses every bad move.", "0" },
+    { "-checkpoint", "string", "", "Checkpoint File", "If set, SANA periodically saves its full state to this binary file, so that the run can be continued with -resume if it is stopped. Only for single anneals (not -replicas or -chains).", "0" },
+    { "-checkpointinterval", "double", "600", "Checkpoint Interval", "Minimum number of seconds between two checkpoints (see -checkpoint).", "0" },
+    { "-resume", "string", "", "Resume from Checkpoint", "Continues the run saved in this checkpoint file (see -checkpoint) instead of starting a new one. The rest of the arguments should be the same as in the original run. The temperature schedule is read from the checkpoint, so it is not computed again.", "0" },
+    { "-controlfile", "string", "", "Control File", "If set, SANA checks periodically if this file exists. If it does, SANA deletes it and executes the first word in it: 'snapshot' saves a report of the current alignment (named with the time stamp) without pausing the run, and 'stop' ends the run and saves the alignment as usual. The signals SIGUSR1 and SIGUSR2 have the same effects.", "0" },
+    { "-profile", "bool", "false", "Profile", "Measures the time spent in each phase of the run (graph loading, similarity matrices, temperature schedule estimation, annealing, report, etc.) and, on a small sample of SANA's iterations, the time of each incremental evaluation function, the accept ratio and the fraction of changes vs swaps. It also records which SIMD kernel counts the aligned edges, if one is used. The result is saved in JSON format next to the .out file, with extension .profile.json.", "0" },
+    { "-hugepages", "bool", "false", "Huge Pages", "Asks the operating system to back the large matrices (adjacency and similarity matrices of at least 2 MB) with transparent huge pages, which makes their random lookups in SANA's main loop faster for large networks. It has no effect if the system does not support them.", "0" },
+    { "-adjacency", "string", "auto", "Adjacency Matrix Representation", "How the adjacency matrices of the networks are stored. 'dense' is a matrix with a bit per pair of nodes (or a weight, for weighted networks), which is the fastest but takes n^2/8 bytes for n nodes. 'hybrid' stores dense rows only for the nodes of high degree, and sorted lists of neighbors for the rest, so that networks of hundreds of thousands of nodes fit in memory at the cost of slower lookups. 'auto' uses dense for each network whose matrix takes at most 512 MB (or that is dense enough that hybrid would not save much) and hybrid otherwise. It has no effect in SPARSE builds.", "0" },
+    { "-noipscache", "bool", "false", "Measure Iteration Speed", "With a time limit (e.g., -t), SANA needs its iterations per second to know how many iterations to do. By default, the speed measured in previous runs with the same networks, objective function, build and CPU is read from autogenerated/ips/ and updated at the end of each run. With this flag, the speed is always measured at the start of the run (which takes a few seconds) and the cache is not used.", "0" },
+    { "-nosimcache", "bool", "false", "Recompute Similarity Matrices", "By default, the similarity matrix of each local measure (e.g., nodec, graphlet, importance) is saved in autogenerated/matrices/ the first time it is computed, and later runs with the same networks and measure parameters memory-map it instead of computing it again (concurrent runs share a single copy in memory). With this flag, the matrices are always computed and the cache is not used.", "0" },
+    { "-simtopk", "intD", "0", "Top-k Similarities", "If positive, the similarity matrix of each local measure (and their weighted sum, which is what SANA optimizes) is replaced by one that keeps only the k most similar nodes of G2 for each node of G1, and the average similarity of the rest. It makes the sums of local measures approximate, but it takes 8*k bytes per node of G1 instead of 4 bytes per pair of nodes, so it allows aligning with local measures against networks of hundreds of thousands of nodes. The graphlet measures, nodec, edgec, noded and edged compute their similarities one row at a time, so their full matrices are never built nor saved in the cache. 0 (the default) keeps the full matrices.", "0" },
+    { "-topkmoves", "double", "0", "Top-k Move Probability", "Only with -simtopk. The probability that a move of SANA is drawn among the k most similar nodes of G2 for a random node of G1, rather than uniformly: the node is moved to that hole if it is unassigned, or swapped with the node that is aligned to it otherwise. It focuses the search on the pairs that contribute to the local measures, but the moves are no longer symmetric. 0 (the default) draws every move uniformly.", "0" },
+    { "-simPrecision", "string", "fp32", "Similarity Precision", "Precision in which the similarity matrices of the local measures (and of wec) are kept in memory: 'fp32' (32-bit floats, the default), 'fp16' (16-bit floats relative to the largest similarity, about 3 significant digits) or 'u8' (256 evenly spaced levels between the smallest and the largest similarity). fp16 and u8 take 2 and 4 times less memory, and more of the matrix fits in the CPU caches, but the scores of the local measures become approximate. The matrices saved in autogenerated/matrices/ are always in fp32.", "0" },
+    { "-implicitsims", "bool", "false", "Implicit Similarities", "The local measures whose similarity between two nodes is a cheap function of a few numbers per node (nodec, edgec, noded, edged and graphletnorm) keep only those numbers, and SANA computes each similarity when it reads it, instead of building and storing their similarity matrices. It takes memory and time proportional to the number of nodes instead of the number of pairs of nodes, so it allows these measures on very large networks, but each iteration is slower than reading a matrix. The similarities, and thus the results, are the same as without it. -simtopk and -simPrecision do not apply to these measures.", "0" },
+    { "-noschedulecache", "bool", "false", "Recompute Temperature Schedule", "With -tinitial auto and/or -tdecay auto, SANA reuses the schedule found in a previous run with the same networks, objective function and schedule method, which is saved in autogenerated/schedules/ together with the pBad samples taken to find it. A run that only changes the schedule method or its target pBads does not reuse the schedule, but its search for the temperatures starts from those samples. With this flag, the schedule is always computed again and the cache is not used.", "0" },
+    { "-schedulethreads", "intD", "1", "Temperature Schedule Threads", "Number of threads used to estimate the temperature schedule (with -tinitial auto and/or -tdecay auto). Each thread samples the pBad of a different temperature with its own copy of the SANA state, so the schedule methods that sample several temperatures at a time (e.g., the default linear regression) finish sooner.", "0" },
+    { "-warmstartpbad", "bool", "false", "Warm-Started pBad Sweeps", "When the schedule methods sample the pBads of several temperatures at once, sample them from hottest to coldest, each one continuing from the alignment reached at the previous temperature instead of starting from a new random alignment. The samples at low temperatures get closer to equilibrium, so the estimated TInitial and TFinal change. The default starts every sample from a random alignment.", "0" },
     { "-lock", "string", "", "Node-to-Node Locking", "Specify a two column file of node pairs that are locked in the alignment.", "0" },
     { "-lock-same-names", "bool", "false", "Node-to-Node Locking", "Locks nodes with same name together.", "0" },
     { "-seed", "double", "RANDOM", "Random Seed", "Serves as a random seed in SANA.", "0" },
@@ -212,7 +212,7 @@ void printProteinPairCountInNetworks(bool BioGRIDNetworks) {
     cout << endl;
 }
 
-void fillTableColumn(vector<vector<string>>& table, uint col, vector<vector<float>>* simMatrix,
+void fillTableColumn(vector<vector<string>>& table, uint col, Matrix<float>* simMatrix,
     const vector<vector<uint>>& complementProteins, const vector<vector<uint>>& nonComplementProteins,
     const vector<vector<uint>>& randomProteins) {
     uint nComp = complementProteins.size();
@@ -273,36 +273,36 @@ void printLocalTopologicalSimilarities(const Graph& G1, const Graph& G2, bool Bi
 
     table[0][2] = "graphlet";
     Graphlet graphletSim(&G1, &G2, 5); //graphlet max size 5
-    vector<vector<float>>* graphletSimMatrix = graphletSim.getSimMatrix();
+    Matrix<float>* graphletSimMatrix = graphletSim.getSimMatrix();
     fillTableColumn(table, 2, graphletSimMatrix,
         complementProteins, nonComplementProteins, randomProteins);
     table[0][3] = "node density";
     NodeCount NodeCountSim(&G1, &G2, {0,0,1});
-    vector<vector<float>>* NodeCountSimMatrix = NodeCountSim.getSimMatrix();
+    Matrix<float>* NodeCountSimMatrix = NodeCountSim.getSimMatrix();
     fillTableColumn(table, 3, NodeCountSimMatrix,
         complementProteins, nonComplementProteins, randomProteins);
 
     table[0][4] = "edge density";
     EdgeCount EdgeCountSim(&G1, &G2, {0,0,1});
-    vector<vector<float>>* EdgeCountSimMatrix = EdgeCountSim.getSimMatrix();
+    Matrix<float>* EdgeCountSimMatrix = EdgeCountSim.getSimMatrix();
     fillTableColumn(table, 4, EdgeCountSimMatrix,
         complementProteins, nonComplementProteins, randomProteins);
 
     table[0][5] = "importance";
     Importance importance(&G1, &G2);
-    vector<vector<float>>* importanceMatrix = importance.getSimMatrix();
+    Matrix<float>* importanceMatrix = importance.getSimMatrix();
     fillTableColumn(table, 5, importanceMatrix,
         complementProteins, nonComplementProteins, randomProteins);
 
     table[0][6] = "sequence";
     Sequence sequence(&G1, &G2);
-    vector<vector<float>>* sequenceMatrix = sequence.getSimMatrix();
+    Matrix<float>* sequenceMatrix = sequence.getSimMatrix();
     fillTableColumn(table, 6, sequenceMatrix,
         complementProteins, nonComplementProteins, randomProteins);
 
     table[0][7] = "go counts";
     GoSimilarity goSim(&G1, &G2, {1}, 1);
-    vector<vector<float>>* goSimMatrix = goSim.getSimMatrix();
+    Matrix<float>* goSimMatrix = goSim.getSimMatrix();
     fillTableColumn(table, 7, goSimMatrix,
         complementProteins, nonComplementProteins, randomProteins);
 
@@ -31,3 +31,80 @@ double EdgeDifference::adjustSumToTargetScore(double edgeDifferenceSum, uint pai
     double mean = edgeDifferenceSum / pairsCount;
     return 1 - mean / 2;
 }
+
+const char* EdgeDifference::Incremental::NAME = "ed";
+
+void EdgeDifference::Incremental::setUp(const Graph* G1, const Graph* G2, MeasureCombination*) {
+    this->G1 = G1;
+    this->G2 = G2;
+    uint n1 = G1->getNumNodes();
+    pairsCount = (n1 * (n1 + 1)) / 2;
+}
+
+void EdgeDifference::Incremental::reset(const Alignment& A) {
+    sum = getEdgeDifferenceSum(G1, G2, A);
+}
+
+void EdgeDifference::Incremental::proposeChange(const vector<uint>& A, uint peg, uint oldHole, uint newHole) {
+    double edgeDifferenceIncDiff = 0;
+    double c = 0;
+    for (uint node2 : *(G1->getAdjList(peg))) {
+        double y = -abs(G1->getEdgeWeight(peg, node2) - G2->getEdgeWeight(oldHole, A[node2])) - c;
+        double t = edgeDifferenceIncDiff + y;
+        c = (t - edgeDifferenceIncDiff) - y;
+        edgeDifferenceIncDiff = t;
+
+        uint node2Hole = node2 == peg ? newHole : A[node2];
+        y = +abs(G1->getEdgeWeight(peg, node2) - G2->getEdgeWeight(newHole, node2Hole)) - c;
+        t = edgeDifferenceIncDiff + y;
+        c = (t - edgeDifferenceIncDiff) - y;
+        edgeDifferenceIncDiff = t;
+    }
+    proposedSum = sum + edgeDifferenceIncDiff;
+}
+
+/* We swap the mapping of two nodes peg1 and peg2
+ * We can first handle peg1, then do the same with peg2
+ * Subtract old edge difference with edge (peg1, hole1)
+ * Add new edge difference with edge (peg1, hole2) */
+void EdgeDifference::Incremental::proposeSwap(const vector<uint>& A, uint peg1, uint peg2, uint hole1, uint hole2) {
+    if (peg1 == peg2) {
+        proposedSum = sum;
+        return;
+    }
+    // Handle peg1
+    double edgeDifferenceIncDiff = 0;
+    double c = 0;
+    for (uint node2 : *(G1->getAdjList(peg1))) {
+        double y = -abs(G1->getEdgeWeight(peg1, node2) - G2->getEdgeWeight(hole1, A[node2])) - c;
+        double t = edgeDifferenceIncDiff + y;
+        c = (t - edgeDifferenceIncDiff) - y;
+        edgeDifferenceIncDiff = t;
+
+        // Determine the new target hole for node2
+        uint node2Hole = 0;
+        if (node2 == peg1) node2Hole = hole2;
+        else if (node2 == peg2) node2Hole = hole1;
+        else node2Hole = A[node2];
+
+        y = +abs(G1->getEdgeWeight(peg1, node2) - G2->getEdgeWeight(hole2, node2Hole)) - c;
+        t = edgeDifferenceIncDiff + y;
+        c = (t - edgeDifferenceIncDiff) - y;
+        edgeDifferenceIncDiff = t;
+    }
+    // Handle peg2
+    for (uint node2 : *(G1->getAdjList(peg2))) {
+        if (node2 == peg1) continue;
+        double y = -abs(G1->getEdgeWeight(peg2, node2) - G2->getEdgeWeight(hole2, A[node2])) - c;
+        double t = edgeDifferenceIncDiff + y;
+        c = (t - edgeDifferenceIncDiff) - y;
+        edgeDifferenceIncDiff = t;
+
+        uint node2Hole = (node2 == peg2 ? hole1 : A[node2]);
+        y = +abs(G1->getEdgeWeight(peg2, node2) - G2->getEdgeWeight(hole1, node2Hole)) - c;
+        t = edgeDifferenceIncDiff + y;
+        c = (t - edgeDifferenceIncDiff) - y;
+        edgeDifferenceIncDiff = t;
+    }
+    proposedSum = sum + edgeDifferenceIncDiff;
+}
@@ -1,6 +1,7 @@
 #ifndef EDGEDIFFERENCE_HPP
 #define EDGEDIFFERENCE_HPP
 #include "Measure.hpp"
+#include "IncrementalMeasure.hpp"
 
 class EdgeDifference: public Measure {
 public:
@@ -10,6 +11,22 @@ public:
 
     static double adjustSumToTargetScore(double edgeDifferenceSum, uint pairsCount);
     static double getEdgeDifferenceSum(const Graph *G1, const Graph *G2, const Alignment &A);
+
+    //incremental evaluation of the edge difference sum (see IncrementalMeasure)
+    class Incremental: public IncrementalMeasure<Incremental> {
+    public:
+        static const char* NAME;
+        static const NonSumAggregation AGGREGATION = NonSumAggregation::SUM_ONLY;
+        void setUp(const Graph* G1, const Graph* G2, MeasureCombination* MC);
+        void reset(const Alignment& A);
+        void proposeChange(const vector<uint>& A, uint peg, uint oldHole, uint newHole);
+        void proposeSwap(const vector<uint>& A, uint peg1, uint peg2, uint hole1, uint hole2);
+        double scoreOfSum(double s) const { return adjustSumToTargetScore(s, pairsCount); }
+    private:
+        const Graph* G1;
+        const Graph* G2;
+        uint pairsCount;
+    };
 };
 
 #endif //EDGEDIFFERENCE_HPP
@@ -4,7 +4,6 @@
 uint EdgeExposure::EDGE_SUM = 2;
 uint EdgeExposure::MAX_EDGE = 1;
 uint EdgeExposure::denom = 0;
-uint EdgeExposure::numer = 0;
 
 EdgeExposure::EdgeExposure(const Graph* G1, const Graph* G2): Measure(G1, G2, "ee") {
 #ifdef MULTI_PAIRWISE
@@ -36,8 +35,6 @@ uint EdgeExposure::getMaxEdge() { return MAX_EDGE; }
 double EdgeExposure::eval(const Alignment& A) {
 #ifdef MULTI_PAIRWISE
     uint ne = numExposedEdges(A, *G1, *G2);
-    if(ne != numer) cerr << "EdgeExposure::numer should be "<<ne<<" but is "<<ne <<'\n';
-    numer = ne;
     assert(ne >= MAX_EDGE and ne <= EDGE_SUM);
     return 1 - (ne - MAX_EDGE)/(double) denom;
 #else
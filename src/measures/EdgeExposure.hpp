@@ -14,7 +14,9 @@ public:
     double eval(const Alignment& A);
 
     static uint getMaxEdge();
-    static uint numer, denom;
+    static uint denom; //set from the environment in the constructor
+
+    //SANA keeps the number of exposed edges of its own alignment incrementally
 
     static int numExposedEdges(const Alignment& A, const Graph& G1, const Graph& G2);
 private:
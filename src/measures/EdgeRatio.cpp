@@ -48,3 +48,81 @@ double EdgeRatio::getRatio(double w1, double w2) {
     assert(r >= 0 and r <= 1);
     return r;
 }
+
+const char* EdgeRatio::Incremental::NAME = "er";
+
+void EdgeRatio::Incremental::setUp(const Graph* G1, const Graph* G2, MeasureCombination*) {
+    this->G1 = G1;
+    this->G2 = G2;
+    uint n1 = G1->getNumNodes();
+    pairsCount = (n1 * (n1 + 1)) / 2;
+}
+
+void EdgeRatio::Incremental::reset(const Alignment& A) {
+    sum = getEdgeRatioSum(G1, G2, A);
+}
+
+void EdgeRatio::Incremental::proposeChange(const vector<uint>& A, uint peg, uint oldHole, uint newHole) {
+    double edgeRatioIncDiff = 0;
+    double c = 0;
+    for (uint node2 : *(G1->getAdjList(peg))) {
+        double r = getRatio(G1->getEdgeWeight(peg, node2), G2->getEdgeWeight(oldHole, A[node2]));
+        double y = -r - c;
+        double t = edgeRatioIncDiff + y;
+        c = (t - edgeRatioIncDiff) - y;
+        edgeRatioIncDiff = t;
+
+        uint node2Hole = node2 == peg ? newHole : A[node2];
+        r = getRatio(G1->getEdgeWeight(peg, node2), G2->getEdgeWeight(newHole, node2Hole));
+        y = r - c;
+        t = edgeRatioIncDiff + y;
+        c = (t - edgeRatioIncDiff) - y;
+        edgeRatioIncDiff = t;
+    }
+    proposedSum = sum + edgeRatioIncDiff;
+}
+
+void EdgeRatio::Incremental::proposeSwap(const vector<uint>& A, uint peg1, uint peg2, uint hole1, uint hole2) {
+    if (peg1 == peg2) {
+        proposedSum = sum;
+        return;
+    }
+    double edgeRatioIncDiff = 0;
+    double c = 0;
+    // Subtract peg1-hole1, add peg1-hole2
+    for (uint node2 : *(G1->getAdjList(peg1))) {
+        double r = getRatio(G1->getEdgeWeight(peg1, node2), G2->getEdgeWeight(hole1, A[node2]));
+        double y = -r - c;
+        double t = edgeRatioIncDiff + y;
+        c = (t - edgeRatioIncDiff) - y;
+        edgeRatioIncDiff = t;
+
+        uint node2Hole = 0;
+        if (node2 == peg1) node2Hole = hole2;
+        else if (node2 == peg2) node2Hole = hole1;
+        else node2Hole = A[node2];
+
+        r = getRatio(G1->getEdgeWeight(peg1, node2), G2->getEdgeWeight(hole2, node2Hole));
+        y = r - c;
+        t = edgeRatioIncDiff + y;
+        c = (t - edgeRatioIncDiff) - y;
+        edgeRatioIncDiff = t;
+    }
+    // Subtract peg2-hole2, add peg2-hole1
+    for (uint node2 : *(G1->getAdjList(peg2))) {
+        if (node2 == peg1) continue;
+        double r = getRatio(G1->getEdgeWeight(peg2, node2), G2->getEdgeWeight(hole2, A[node2]));
+        double y = -r - c;
+        double t = edgeRatioIncDiff + y;
+        c = (t - edgeRatioIncDiff) - y;
+        edgeRatioIncDiff = t;
+
+        uint node2Hole = (node2 == peg2 ? hole1 : A[node2]);
+        r = getRatio(G1->getEdgeWeight(peg2, node2), G2->getEdgeWeight(hole1, node2Hole));
+        y = r - c;
+        t = edgeRatioIncDiff + y;
+        c = (t - edgeRatioIncDiff) - y;
+        edgeRatioIncDiff = t;
+    }
+    proposedSum = sum + edgeRatioIncDiff;
+}
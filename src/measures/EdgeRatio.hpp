@@ -1,6 +1,7 @@
 #ifndef EDGERATIO_HPP
 #define EDGERATIO_HPP
 #include "Measure.hpp"
+#include "IncrementalMeasure.hpp"
 
 class EdgeRatio: public Measure {
 public:
@@ -9,6 +10,22 @@ public:
     double eval(const Alignment& A);
     static double adjustSumToTargetScore(double edgeRatioSum, uint pairsCount);
     static double getEdgeRatioSum(const Graph *G1, const Graph *G2, const Alignment &A);
+
+    //incremental evaluation of the edge ratio sum (see IncrementalMeasure)
+    class Incremental: public IncrementalMeasure<Incremental> {
+    public:
+        static const char* NAME;
+        static const NonSumAggregation AGGREGATION = NonSumAggregation::SUM_ONLY;
+        void setUp(const Graph* G1, const Graph* G2, MeasureCombination* MC);
+        void reset(const Alignment& A);
+        void proposeChange(const vector<uint>& A, uint peg, uint oldHole, uint newHole);
+        void proposeSwap(const vector<uint>& A, uint peg1, uint peg2, uint hole1, uint hole2);
+        double scoreOfSum(double s) const { return adjustSumToTargetScore(s, pairsCount); }
+    private:
+        const Graph* G1;
+        const Graph* G2;
+        uint pairsCount;
+    };
 private:
     const int kErrorScore = -2;
 
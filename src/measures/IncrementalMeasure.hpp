@@ -0,0 +1,241 @@
+#ifndef INCREMENTALMEASURE_HPP
+#define INCREMENTALMEASURE_HPP
+#include <vector>
+#include <tuple>
+#include <type_traits>
+#include "MeasureCombination.hpp"
+#include "../Graph.hpp"
+#include "../Alignment.hpp"
+#include "../utils/BinaryBuffer.hpp"
+#include "../utils/Profiler.hpp"
+
+using namespace std;
+
+/* Incremental evaluation of a measure in a local search over alignments, like SANA's.
+A move either gives a peg (G1 node) a new hole (unassigned G2 node) or swaps the holes of two pegs.
+For each move, the search calls proposeChange or proposeSwap before modifying the alignment,
+reads proposedScore(), and then calls commit() if it applies the move or rollback() if it doesn't.
+A proposal never modifies the state of the current alignment, so a rejected move leaves no trace.
+
+A measure implements it by deriving from IncrementalMeasure<itself> (CRTP) and defining:
+    static const char* NAME; //its name in the MeasureCombination
+    static const NonSumAggregation AGGREGATION; //see NonSumAggregation
+    void setUp(const Graph* G1, const Graph* G2, MeasureCombination* MC); //only called if it is used
+    void reset(const Alignment& A); //sets 'sum' for A from scratch
+    void proposeChange(const vector<uint>& A, uint peg, uint oldHole, uint newHole); //sets 'proposedSum'
+    void proposeSwap(const vector<uint>& A, uint peg1, uint peg2, uint hole1, uint hole2); //same
+    double scoreOfSum(double sum) const; //the score of an alignment from its 'sum'
+Measures whose state is not just 'sum' also define commitState, rollbackState, saveState and loadState.
+None of these are virtual: SANA calls them through IncrementalMeasureSet, which knows the types.
+
+A change of a peg often only depends on the G2 edges between its old and new holes and the holes of its
+neighbors, which the search may already be looking up for other measures. Such a measure can also set
+NEIGHBORHOOD_HOOKS to true and define:
+    void beginNeighborhoodChange(uint peg);
+    void neighborChange(uint peg, uint nbr, EDGE_T oldWeight, EDGE_T newWeight); //for each G1 neighbor
+    void endNeighborhoodChange(uint peg, uint oldHole, uint newHole); //sets 'proposedSum'
+where oldWeight and newWeight are the weights of the G2 edges between A[nbr] and oldHole and newHole.
+If the search drives these hooks from its own traversal (see IncrementalMeasureSet::setNeighborhoodDriven),
+they are called instead of proposeChange, and must give the same 'proposedSum' */
+/* How a measure enters SANA's score aggregations other than 'sum' (see -combinedScoreAs).
+They predate this interface and do not treat all the measures the same way:
+- SUM_ONLY: it is left out of them
+- ADDITIVE: weight*score is added to the score, even in 'product' and 'inverse',
+  and its change is one of those compared in 'max', 'min' and 'maxFactor'
+- FACTOR: like the measures that SANA evaluates itself: weight*score is a factor in 'product',
+  weight/score is added in 'inverse', and its change is compared in 'max', 'min' and 'maxFactor' */
+enum class NonSumAggregation { SUM_ONLY, ADDITIVE, FACTOR };
+
+template<typename Derived>
+class IncrementalMeasure {
+public:
+    static const bool NEIGHBORHOOD_HOOKS = false;
+
+    double getWeight() const { return weight; }
+    bool isUsed() const { return weight > 0; }
+
+    void init(const Graph* G1, const Graph* G2, MeasureCombination* MC) {
+        weight = MC->containsMeasure(Derived::NAME) ? MC->getWeight(Derived::NAME) : 0;
+        if (isUsed()) self().setUp(G1, G2, MC);
+    }
+    double score() const { return self().scoreOfSum(sum); }
+    double proposedScore() const { return self().scoreOfSum(proposedSum); }
+    void commit() { sum = proposedSum; self().commitState(); }
+    void rollback() { self().rollbackState(); }
+    void save(BinaryBuffer& buf) const { buf.write(sum); self().saveState(buf); }
+    void load(BinaryBuffer& buf) { sum = buf.read<double>(); self().loadState(buf); }
+
+    //defaults for the measures without NEIGHBORHOOD_HOOKS, which are never called
+    void beginNeighborhoodChange(uint) {}
+    void neighborChange(uint, uint, EDGE_T, EDGE_T) {}
+    void endNeighborhoodChange(uint, uint, uint) {}
+
+protected:
+    double weight = 0;
+    double sum = 0, proposedSum = 0;
+
+    //defaults for the measures whose whole state is 'sum'
+    void commitState() {}
+    void rollbackState() {}
+    void saveState(BinaryBuffer&) const {}
+    void loadState(BinaryBuffer&) {}
+
+private:
+    Derived& self() { return static_cast<Derived&>(*this); }
+    const Derived& self() const { return static_cast<const Derived&>(*this); }
+};
+
+/* A fixed list of incrementally evaluated measures, of which any subset can be in use.
+The list is known at compile time, so every call is resolved statically and can be inlined.
+A measure that is not in use costs one (well predicted) branch per call.
+Adding a measure to SANA only requires adding its type to SANA's list */
+template<typename... Measures>
+class IncrementalMeasureSet {
+public:
+    static const uint SIZE = sizeof...(Measures);
+    static const char* name(uint i) {
+        static const char* names[] = {Measures::NAME...};
+        return names[i];
+    }
+
+    void init(const Graph* G1, const Graph* G2, MeasureCombination* MC) { forEach(measures, Init{G1, G2, MC}); }
+    void reset(const Alignment& A) { forEach(measures, Reset{A}); }
+
+    //if 'ticks' and 'samples' are not null, the ticks taken by the proposal of the i-th measure
+    //are added to ticks[i], and samples[i] is incremented (see Profiler)
+    void proposeChange(const vector<uint>& A, uint peg, uint oldHole, uint newHole,
+            unsigned long long* ticks = nullptr, unsigned long long* samples = nullptr) {
+        forEach(measures, ProposeChange{A, peg, oldHole, newHole, ticks, samples, neighborhoodDriven});
+    }
+    void proposeSwap(const vector<uint>& A, uint peg1, uint peg2, uint hole1, uint hole2,
+            unsigned long long* ticks = nullptr, unsigned long long* samples = nullptr) {
+        forEach(measures, ProposeSwap{A, peg1, peg2, hole1, hole2, ticks, samples});
+    }
+    //if true, the change proposals of the measures with NEIGHBORHOOD_HOOKS in use are not made by
+    //proposeChange, and the caller must drive them with the three functions below instead
+    void setNeighborhoodDriven(bool driven) { neighborhoodDriven = driven; }
+    //whether any measure in use has NEIGHBORHOOD_HOOKS
+    bool usesNeighborhoodHooks() const {
+        bool res = false;
+        forEach(measures, HasHooks{res});
+        return res;
+    }
+    void beginNeighborhoodChange(uint peg) { forEach(measures, BeginNeighborhoodChange{peg}); }
+    void neighborChange(uint peg, uint nbr, EDGE_T oldWeight, EDGE_T newWeight) {
+        forEach(measures, NeighborChange{peg, nbr, oldWeight, newWeight});
+    }
+    void endNeighborhoodChange(uint peg, uint oldHole, uint newHole) {
+        forEach(measures, EndNeighborhoodChange{peg, oldHole, newHole});
+    }
+
+    void commit() { forEach(measures, Commit()); }
+    void rollback() { forEach(measures, Rollback()); }
+
+    //calls f(aggregation, weight, score, proposedScore) for each measure in use, in the order of the list,
+    //where 'aggregation' is the measure's NonSumAggregation
+    template<typename F>
+    void forEachUsed(F f) const { forEach(measures, Scores<F>{f}); }
+
+    void save(BinaryBuffer& buf) const { forEach(measures, Save{buf}); }
+    void load(BinaryBuffer& buf) { forEach(measures, Load{buf}); }
+
+private:
+    tuple<Measures...> measures;
+    bool neighborhoodDriven = false;
+
+    //calls f(measure, index) for each measure in 'ms' ('measures', which may be const)
+    template<typename Tuple, typename F>
+    static void forEach(Tuple& ms, F f) { forEach(ms, f, integral_constant<uint, 0>()); }
+    template<typename Tuple, typename F, uint I>
+    static void forEach(Tuple& ms, F& f, integral_constant<uint, I>) {
+        f(std::get<I>(ms), I);
+        forEach(ms, f, integral_constant<uint, I+1>());
+    }
+    template<typename Tuple, typename F>
+    static void forEach(Tuple&, F&, integral_constant<uint, SIZE>) {}
+
+    struct Init {
+        const Graph* G1; const Graph* G2; MeasureCombination* MC;
+        template<typename M> void operator()(M& m, uint) { m.init(G1, G2, MC); }
+    };
+    struct Reset {
+        const Alignment& A;
+        template<typename M> void operator()(M& m, uint) { if (m.isUsed()) m.reset(A); }
+    };
+    struct ProposeChange {
+        const vector<uint>& A; uint peg, oldHole, newHole;
+        unsigned long long *ticks, *samples;
+        bool neighborhoodDriven;
+        template<typename M> void operator()(M& m, uint i) {
+            if (not m.isUsed() or (M::NEIGHBORHOOD_HOOKS and neighborhoodDriven)) return;
+            if (ticks == nullptr) {
+                m.proposeChange(A, peg, oldHole, newHole);
+                return;
+            }
+            unsigned long long start = Profiler::ticks();
+            m.proposeChange(A, peg, oldHole, newHole);
+            ticks[i] += Profiler::ticks()-start;
+            samples[i]++;
+        }
+    };
+    struct ProposeSwap {
+        const vector<uint>& A; uint peg1, peg2, hole1, hole2;
+        unsigned long long *ticks, *samples;
+        template<typename M> void operator()(M& m, uint i) {
+            if (not m.isUsed()) return;
+            if (ticks == nullptr) {
+                m.proposeSwap(A, peg1, peg2, hole1, hole2);
+                return;
+            }
+            unsigned long long start = Profiler::ticks();
+            m.proposeSwap(A, peg1, peg2, hole1, hole2);
+            ticks[i] += Profiler::ticks()-start;
+            samples[i]++;
+        }
+    };
+    struct HasHooks {
+        bool& res;
+        template<typename M> void operator()(const M& m, uint) { if (M::NEIGHBORHOOD_HOOKS and m.isUsed()) res = true; }
+    };
+    struct BeginNeighborhoodChange {
+        uint peg;
+        template<typename M> void operator()(M& m, uint) {
+            if (M::NEIGHBORHOOD_HOOKS and m.isUsed()) m.beginNeighborhoodChange(peg);
+        }
+    };
+    struct NeighborChange {
+        uint peg, nbr; EDGE_T oldWeight, newWeight;
+        template<typename M> void operator()(M& m, uint) {
+            if (M::NEIGHBORHOOD_HOOKS and m.isUsed()) m.neighborChange(peg, nbr, oldWeight, newWeight);
+        }
+    };
+    struct EndNeighborhoodChange {
+        uint peg, oldHole, newHole;
+        template<typename M> void operator()(M& m, uint) {
+            if (M::NEIGHBORHOOD_HOOKS and m.isUsed()) m.endNeighborhoodChange(peg, oldHole, newHole);
+        }
+    };
+    struct Commit {
+        template<typename M> void operator()(M& m, uint) { if (m.isUsed()) m.commit(); }
+    };
+    struct Rollback {
+        template<typename M> void operator()(M& m, uint) { if (m.isUsed()) m.rollback(); }
+    };
+    template<typename F>
+    struct Scores {
+        F& f;
+        template<typename M> void operator()(M& m, uint) {
+            if (m.isUsed()) f(M::AGGREGATION, m.getWeight(), m.score(), m.proposedScore());
+        }
+    };
+    struct Save {
+        BinaryBuffer& buf;
+        template<typename M> void operator()(M& m, uint) { if (m.isUsed()) m.save(buf); }
+    };
+    struct Load {
+        BinaryBuffer& buf;
+        template<typename M> void operator()(M& m, uint) { if (m.isUsed()) m.load(buf); }
+    };
+};
+
+#endif /* INCREMENTALMEASURE_HPP */
@@ -29,3 +29,91 @@ vector<uint> JaccardSimilarityScore::getAlignedByNode(const Graph *G1, const Gra
     }
     return alignedByNode;
 }
+
+const char* JaccardSimilarityScore::Incremental::NAME = "js";
+
+void JaccardSimilarityScore::Incremental::setUp(const Graph* G1, const Graph* G2, MeasureCombination* MC) {
+    this->G1 = G1;
+    this->G2 = G2;
+    js = MC->getMeasure(NAME);
+    proposedCounts = vector<pair<uint, uint>> (2*G1->maxDegree()+2);
+    numProposedCounts = 0;
+}
+
+void JaccardSimilarityScore::Incremental::reset(const Alignment& A) {
+    sum = js->eval(A);
+    alignedByNode = getAlignedByNode(G1, G2, A);
+}
+
+void JaccardSimilarityScore::Incremental::proposeCount(uint node, uint newCount) {
+    uint degree = G1->getNumNbrs(node);
+    if (degree == 0) return;
+    proposedSum += ((double) newCount - (double) alignedByNode[node])/degree;
+    proposedCounts[numProposedCounts++] = {node, newCount};
+}
+
+uint JaccardSimilarityScore::Incremental::alignedEdgesOf(const vector<uint>& A, uint peg, uint hole,
+        uint otherPeg, uint otherHole) const {
+    uint count = 0;
+    for (uint nbr : *(G1->getAdjList(peg))) {
+        uint nbrHole = nbr == peg ? hole : (nbr == otherPeg ? otherHole : A[nbr]);
+        count += G2->getEdgeWeight(hole, nbrHole);
+    }
+    return count;
+}
+
+void JaccardSimilarityScore::Incremental::proposeChange(const vector<uint>& A, uint peg, uint oldHole, uint newHole) {
+    proposedSum = sum;
+    numProposedCounts = 0;
+    proposeCount(peg, alignedEdgesOf(A, peg, newHole, peg, newHole));
+    for (uint nbr : *(G1->getAdjList(peg))) {
+        if (nbr == peg) continue;
+        uint nbrHole = A[nbr];
+        proposeCount(nbr, alignedByNode[nbr] - G2->getEdgeWeight(oldHole, nbrHole)
+                                             + G2->getEdgeWeight(newHole, nbrHole));
+    }
+}
+
+void JaccardSimilarityScore::Incremental::beginNeighborhoodChange(uint) {
+    pegCount = 0;
+    numProposedCounts = 1; //the first entry is left for the peg
+}
+
+void JaccardSimilarityScore::Incremental::endNeighborhoodChange(uint peg, uint oldHole, uint newHole) {
+    //the peg's self-loop, if any, was looked up as an edge to oldHole, but the peg's new hole is newHole
+    if (G1->hasSelfLoop(peg)) pegCount = pegCount - G2->getEdgeWeight(newHole, oldHole) + G2->getEdgeWeight(newHole, newHole);
+    //the terms are added in the same order as in proposeChange, so that the sums are the same bit for bit.
+    //every neighbor has degree > 0, so proposeCount writes the i-th count back to the i-th entry
+    //(if the peg has degree 0, it has no neighbors either)
+    uint numNbrCounts = numProposedCounts;
+    proposedSum = sum;
+    numProposedCounts = 0;
+    proposeCount(peg, pegCount);
+    for (uint i = 1; i < numNbrCounts; i++) proposeCount(proposedCounts[i].first, proposedCounts[i].second);
+}
+
+void JaccardSimilarityScore::Incremental::proposeSwap(const vector<uint>& A, uint peg1, uint peg2, uint hole1, uint hole2) {
+    proposedSum = sum;
+    numProposedCounts = 0;
+    proposeCount(peg1, alignedEdgesOf(A, peg1, hole2, peg2, hole1));
+    proposeCount(peg2, alignedEdgesOf(A, peg2, hole1, peg1, hole2));
+    //a node adjacent to both pegs is still adjacent to both holes, so its count doesn't change
+    for (uint nbr : *(G1->getAdjList(peg1))) {
+        if (nbr == peg1 or nbr == peg2 or G1->hasEdge(nbr, peg2)) continue;
+        uint nbrHole = A[nbr];
+        proposeCount(nbr, alignedByNode[nbr] - G2->getEdgeWeight(hole1, nbrHole)
+                                             + G2->getEdgeWeight(hole2, nbrHole));
+    }
+    for (uint nbr : *(G1->getAdjList(peg2))) {
+        if (nbr == peg1 or nbr == peg2 or G1->hasEdge(nbr, peg1)) continue;
+        uint nbrHole = A[nbr];
+        proposeCount(nbr, alignedByNode[nbr] - G2->getEdgeWeight(hole2, nbrHole)
+                                             + G2->getEdgeWeight(hole1, nbrHole));
+    }
+}
+
+void JaccardSimilarityScore::Incremental::commitState() {
+    for (uint i = 0; i < numProposedCounts; i++)
+        alignedByNode[proposedCounts[i].first] = proposedCounts[i].second;
+    numProposedCounts = 0;
+}
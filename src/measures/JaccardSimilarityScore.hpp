@@ -1,6 +1,7 @@
 #ifndef JACCARDSIMILARITYSCORE_HPP
 #define JACCARDSIMILARITYSCORE_HPP
 #include "Measure.hpp"
+#include "IncrementalMeasure.hpp"
 #include <vector>
 
 class JaccardSimilarityScore: public Measure {
@@ -10,6 +11,51 @@ public:
     double eval(const Alignment& A);
     static  vector<uint> getAlignedByNode(const Graph *G1, const Graph *G2, const Alignment& A);
     // vector<uint> getAlignedByNode(const Alignment& A);
+
+    /* Incremental evaluation (see IncrementalMeasure). The score is the sum over the G1 nodes of
+    alignedByNode[node]/degree(node), so a move changes the terms of the pegs and their neighbors.
+    A proposal writes the new counts of those nodes in 'proposedCounts', and commit copies them
+    into alignedByNode, so the counts are only modified by accepted moves.
+    Nodes with degree 0 are skipped, as their term never changes.
+    A change only depends on the G2 edges between the holes and the holes of the peg's neighbors,
+    so it can also be proposed from SANA's fused neighborhood traversal (NEIGHBORHOOD_HOOKS) */
+    class Incremental: public IncrementalMeasure<Incremental> {
+    public:
+        static const char* NAME;
+        static const NonSumAggregation AGGREGATION = NonSumAggregation::ADDITIVE;
+        static const bool NEIGHBORHOOD_HOOKS = true;
+        void setUp(const Graph* G1, const Graph* G2, MeasureCombination* MC);
+        void reset(const Alignment& A);
+        void proposeChange(const vector<uint>& A, uint peg, uint oldHole, uint newHole);
+        void proposeSwap(const vector<uint>& A, uint peg1, uint peg2, uint hole1, uint hole2);
+        void beginNeighborhoodChange(uint peg);
+        void neighborChange(uint peg, uint nbr, EDGE_T oldWeight, EDGE_T newWeight) {
+            pegCount += newWeight;
+            if (nbr != peg) proposedCounts[numProposedCounts++] = {nbr, alignedByNode[nbr] - oldWeight + newWeight};
+        }
+        void endNeighborhoodChange(uint peg, uint oldHole, uint newHole);
+        double scoreOfSum(double s) const { return s; }
+
+        void commitState();
+        void saveState(BinaryBuffer& buf) const { buf.writeVector(alignedByNode); }
+        void loadState(BinaryBuffer& buf) { buf.readVector(alignedByNode); }
+    private:
+        const Graph* G1;
+        const Graph* G2;
+        Measure* js;
+        vector<uint> alignedByNode;
+        //(node, new count) for each node affected by the last proposal. preallocated for the largest
+        //possible move (a swap of two pegs of maximum degree), so that proposals don't allocate memory
+        vector<pair<uint, uint>> proposedCounts;
+        uint numProposedCounts;
+        //during a neighborhood-driven change: the new count of the peg so far. the new counts of its
+        //neighbors are collected from proposedCounts[1], and their terms are added at the end
+        uint pegCount;
+        //adds the change of the term of 'node' to proposedSum and records its new count
+        void proposeCount(uint node, uint newCount);
+        //the count of 'peg' in A modified to align 'peg' to 'hole' and 'otherPeg' to 'otherHole'
+        uint alignedEdgesOf(const vector<uint>& A, uint peg, uint hole, uint otherPeg, uint otherHole) const;
+    };
 };
 
 #endif
\ No newline at end of file
@@ -1,12 +1,13 @@
 #include "MeasureCombination.hpp"
 #include "localMeasures/LocalMeasure.hpp"
+#include "../utils/Profiler.hpp"
 #include <sstream>
 #include <algorithm>
 #include <iterator>
 #include <string>
 #include <functional>
 
-MeasureCombination::MeasureCombination(){}
+MeasureCombination::MeasureCombination(): localSimMapInit(false) {}
 MeasureCombination::~MeasureCombination() {
   for(auto m: measures) delete m;
 }
@@ -156,7 +157,25 @@ void MeasureCombination::initn1n2(uint& n1, uint& n2) const {
     if (n1 != 0 and n2 != 0) return; //already init
     for (auto m : measures) {
         if (m->isLocal()) {
-            vector<vector<float>>* mSims = ((LocalMeasure*) m)->getSimMatrix();
+            const ImplicitSims* implicitSims = ((LocalMeasure*) m)->getImplicitSims();
+            if (implicitSims) {
+                n1 = implicitSims->numRows();
+                n2 = implicitSims->numCols();
+                return;
+            }
+            const QuantizedMatrix* quantizedSims = ((LocalMeasure*) m)->getQuantizedSims();
+            if (quantizedSims) {
+                n1 = quantizedSims->numRows();
+                n2 = quantizedSims->numCols();
+                return;
+            }
+            const TopKSimMatrix* topSims = ((LocalMeasure*) m)->getTopSims();
+            if (topSims) {
+                n1 = topSims->numRows();
+                n2 = topSims->numCols();
+                return;
+            }
+            Matrix<float>* mSims = ((LocalMeasure*) m)->getSimMatrix();
             n1 = mSims->size();
             n2 = (*mSims)[0].size();
             return;
@@ -165,83 +184,142 @@ void MeasureCombination::initn1n2(uint& n1, uint& n2) const {
     throw runtime_error("There are no local measures");
 }
 
-typedef vector<vector<float>> SimMatrix;
-typedef function<void(SimMatrix &, uint const &, uint const &)> SimMatrixRecipe;
+vector<uint> MeasureCombination::weightedLocalMeasures(bool withImplicitSims) const {
+    vector<uint> res;
+    for (uint i = 0; i < numMeasures(); i++) {
+        if (not measures[i]->isLocal() or weights[i] <= 0) continue;
+        if (withImplicitSims or not ((LocalMeasure*) measures[i])->getImplicitSims()) res.push_back(i);
+    }
+    return res;
+}
 
 //Returns a reference to the similarity matrix of the weighted sum of local measures.
 //Only initializes the matrix on the first call.
-vector<vector<float>>& MeasureCombination::getAggregatedLocalSims() {
-    //A flag to check if the map has been initialized.
-    static bool is_init = false;
-    //The "recipe" that describes how to create the sim matrix,
-    //namely to combine all locals into a new localdo.
-    static function<void(vector<vector<float>> &, uint const &, uint const &)> const initFunc =
-      [this] (vector<vector<float>> & sim, uint const & n1, uint const & n2) {
-        Measure* m;
-        double w;
-        for (uint i = 0; i < numMeasures(); i++) {
-            m = measures[i];
-            w = weights[i];
-            if (m->isLocal() and w > 0) {
-                vector<vector<float>>* mSims = ((LocalMeasure*) m)->getSimMatrix();
-                for (uint i = 0; i < n1; i++) {
-                    for (uint j = 0; j < n2; j++) {
-                        sim[i][j] += w * (*mSims)[i][j];
-                    }
+const Matrix<float>& MeasureCombination::getAggregatedLocalSims() {
+    //the matrix is never empty once initialized
+    if (localAggregatedSim.empty()) {
+        Profiler::ScopedPhase phase("local similarity aggregation");
+        vector<uint> locals = weightedLocalMeasures(false);
+        if (aggregatedLocalSimsAreView()) {
+            localAggregatedSim = ((LocalMeasure*) measures[locals[0]])->getSimMatrix()->share();
+            return localAggregatedSim;
+        }
+        uint n1 = 0, n2 = 0;
+        initn1n2(n1, n2);
+        localAggregatedSim = Matrix<float>(n1, n2);
+        vector<float> mSims(n2);
+        for (uint k : locals) {
+            double w = weights[k];
+            for (uint i = 0; i < n1; i++) {
+                ((LocalMeasure*) measures[k])->getSimRow(i, mSims.data());
+                for (uint j = 0; j < n2; j++) {
+                    localAggregatedSim[i][j] += w * mSims[j];
                 }
             }
         }
-      };
-    if(!is_init) {
-      is_init = true;
-      localAggregatedSim = initSim(initFunc);
     }
     return localAggregatedSim;
 }
 
-//Returns a map defined as LocalMeasure (string) -> SimMatrix
+bool MeasureCombination::aggregatedLocalSimsAreView() const {
+    vector<uint> locals = weightedLocalMeasures(false);
+    return locals.size() == 1 and weights[locals[0]] == 1;
+}
+
+const TopKSimMatrix& MeasureCombination::getAggregatedLocalTopSims() {
+    if (localAggregatedTopSims.empty()) {
+        Profiler::ScopedPhase phase("local similarity aggregation");
+        vector<uint> locals = weightedLocalMeasures(false);
+        if (locals.size() == 1 and weights[locals[0]] == 1 and ((LocalMeasure*) measures[locals[0]])->getTopSims()) {
+            localAggregatedTopSims = *(((LocalMeasure*) measures[locals[0]])->getTopSims());
+        } else {
+            uint n1 = 0, n2 = 0;
+            initn1n2(n1, n2);
+            vector<float> mSims(n2);
+            //the top k of the weighted sum of the measures, not the weighted sum of their top k
+            auto row = [this, &mSims] (uint i, vector<float>& sim) { aggregatedLocalSimRow(i, sim, mSims, true); };
+            localAggregatedTopSims = TopKSimMatrix(n1, n2, LocalMeasure::getTopK(), row);
+        }
+        for (uint k : locals) ((LocalMeasure*) measures[k])->releaseDenseSims();
+    }
+    return localAggregatedTopSims;
+}
+
+const QuantizedMatrix& MeasureCombination::getAggregatedLocalQuantizedSims() {
+    if (localAggregatedQuantizedSims.empty()) {
+        Profiler::ScopedPhase phase("local similarity aggregation");
+        uint n1 = 0, n2 = 0;
+        initn1n2(n1, n2);
+        vector<float> mSims(n2);
+        auto row = [this, &mSims] (uint i, vector<float>& sim) { aggregatedLocalSimRow(i, sim, mSims); };
+        localAggregatedQuantizedSims = QuantizedMatrix(n1, n2, LocalMeasure::getPrecision(), row);
+    }
+    return localAggregatedQuantizedSims;
+}
+
+//same operations as getAggregatedLocalSims, for a single row. mSims is space for a row of a measure.
+//With exact, the rows of the measures are read before their top k are selected (see LocalMeasure::getExactSimRow)
+void MeasureCombination::aggregatedLocalSimRow(uint i, vector<float>& sim, vector<float>& mSims, bool exact) const {
+    fill(sim.begin(), sim.end(), 0);
+    for (uint k : weightedLocalMeasures(false)) {
+        double w = weights[k];
+        if (exact) ((LocalMeasure*) measures[k])->getExactSimRow(i, mSims.data());
+        else ((LocalMeasure*) measures[k])->getSimRow(i, mSims.data());
+        for (uint j = 0; j < sim.size(); j++) sim[j] += w * mSims[j];
+    }
+}
+
+map<string, pair<const QuantizedMatrix*, double>> MeasureCombination::getLocalQuantizedSimMap() const {
+    map<string, pair<const QuantizedMatrix*, double>> res;
+    for (uint i : weightedLocalMeasures(false)) {
+        Measure* m = measures[i];
+        const QuantizedMatrix* quantizedSims = ((LocalMeasure*) m)->getQuantizedSims();
+        if (not quantizedSims) throw runtime_error("Measure "+m->getName()+" has no quantized similarity matrix");
+        res[m->getName()] = {quantizedSims, weights[i]};
+    }
+    return res;
+}
+
+map<string, pair<const TopKSimMatrix*, double>> MeasureCombination::getLocalTopSimMap() const {
+    map<string, pair<const TopKSimMatrix*, double>> res;
+    for (uint i : weightedLocalMeasures(false)) {
+        Measure* m = measures[i];
+        const TopKSimMatrix* topSims = ((LocalMeasure*) m)->getTopSims();
+        if (not topSims) throw runtime_error("Measure "+m->getName()+" has no top-k similarity matrix");
+        res[m->getName()] = {topSims, weights[i]};
+    }
+    return res;
+}
+
+map<string, pair<const ImplicitSims*, double>> MeasureCombination::getLocalImplicitSimMap() const {
+    map<string, pair<const ImplicitSims*, double>> res;
+    for (uint i : weightedLocalMeasures()) {
+        const ImplicitSims* implicitSims = ((LocalMeasure*) measures[i])->getImplicitSims();
+        if (implicitSims) res[measures[i]->getName()] = {implicitSims, weights[i]};
+    }
+    return res;
+}
+
+LocalSimSum MeasureCombination::getLocalSimSum() const {
+    vector<pair<const LocalMeasure*, double>> res;
+    for (uint i : weightedLocalMeasures()) res.push_back({(LocalMeasure*) measures[i], weights[i]});
+    return LocalSimSum(res);
+}
+
+//Returns a map defined as LocalMeasure (string) -> (view of its SimMatrix, weight)
 //Returns a reference to the map, initializing it on the first call
 //and returning the existing map on subsequent calls.
-map<string, SimMatrix>& MeasureCombination::getLocalSimMap() {
-    Measure* m;
-    double w;
-    //A flag to check if the map has been initialized.
-    static bool is_init = false;
-    //The "recipe" that describes how to create the sim matrix.
-    static SimMatrixRecipe const initFunc =
-        [this, &m, &w] (SimMatrix & sim, uint const & n1, uint const & n2) {
-            SimMatrix* mSims = ((LocalMeasure*) m)->getSimMatrix();
-            for (uint i = 0; i < n1; i++) {
-                for (uint j = 0; j < n2; j++) {
-                    sim[i][j] = w * (*mSims)[i][j];
-                }
-            }
-        };
-    if(!is_init) {
-        is_init = true;
-        for (uint i = 0; i < numMeasures(); ++i) {
-            m = measures[i];
-            w = weights[i];
-            if (m->isLocal() and w > 0) {
-                localScoreSimMap[m->getName()] = initSim(initFunc);
-            }
+const map<string, pair<Matrix<float>, double>>& MeasureCombination::getLocalSimMap() {
+    if (not localSimMapInit) {
+        localSimMapInit = true;
+        for (uint i : weightedLocalMeasures(false)) {
+            Matrix<float> view = ((LocalMeasure*) measures[i])->getSimMatrix()->share();
+            localScoreSimMap.emplace(measures[i]->getName(), make_pair(move(view), weights[i]));
         }
     }
     return localScoreSimMap;
 }
 
-//Abstracts the construction of the similarity matrix. Instead of the get..()
-//functions producing possibly different implementations of similarity matrices,
-//a common type of similarity matrix is produced in initSim and populated
-//by a Recipe function.
-SimMatrix MeasureCombination::initSim(SimMatrixRecipe recipe) const {
-  static uint n1 = 0, n2 = 0;
-  initn1n2(n1, n2);
-  vector<vector<float>> sim(n1, vector<float> (n2, 0));
-  recipe(sim, n1, n2);
-  return sim;
-}
-
 int MeasureCombination::getNumberOfLocalMeasures() const {
     int res = 0;
     for (uint i = 0; i < numMeasures(); i++) {
@@ -279,36 +357,35 @@ Pairwise Alignment  LocalMeasure1       LocalMeasure2       Weighted Sum
 void MeasureCombination::writeLocalScores(ostream& ofs, 
         const Graph& G1, const Graph& G2, const Alignment& A) const {
     int const COL_WIDTH = 20, PRECISION = 3;
+    map<string, pair<const LocalMeasure*, double>> locals; //sorted by name
+    for (uint i : weightedLocalMeasures())
+        locals[measures[i]->getName()] = {(const LocalMeasure*) measures[i], weights[i]};
+
     ofs<<setw(COL_WIDTH)<<left<<"Pairwise Alignment";
-    for(auto const & mapping : localScoreSimMap)
+    for(auto const & mapping : locals)
       ofs<<setw(COL_WIDTH)<<left<<mapping.first;
     ofs<<setw(COL_WIDTH)<<left<<"Weighted Sum"<<endl;
     ostringstream edgeStream;
 
+    auto writePair = [&](uint i, uint j) {
+        edgeStream<<G1.getNodeName(i)<<"\t"<<G2.getNodeName(j);
+        ofs<<setw(COL_WIDTH)<<edgeStream.str();
+        edgeStream.str("");
+        edgeStream.clear();
+        double weightedSum = 0;
+        for (auto const & mapping : locals) {
+            double sim = mapping.second.second * mapping.second.first->getSim(i, j);
+            weightedSum += sim;
+            ofs<<setw(COL_WIDTH)<<left<<setprecision(PRECISION)<<sim;
+        }
+        ofs<<setw(COL_WIDTH)<<left<<setprecision(PRECISION)<<weightedSum<<endl;
+    };
     const bool GENERATE_FULL_SIM_FILE = false;
     if (GENERATE_FULL_SIM_FILE) {
         for (uint i = 0; i < G1.getNumNodes(); i++) {
-            for (uint j = 0; j < G2.getNumNodes(); j++) {
-                edgeStream<<G1.getNodeName(i)<<"\t"<<G2.getNodeName(j);
-                ofs<<setw(COL_WIDTH)<<edgeStream.str();
-                edgeStream.str("");
-                edgeStream.clear();
-                for (const auto& mapping : localScoreSimMap) {
-                    ofs<<setw(COL_WIDTH)<<left<<setprecision(PRECISION)<<mapping.second[i][j];
-                }
-                ofs<<setw(COL_WIDTH)<<left<<setprecision(PRECISION)<<localAggregatedSim[i][j]<<endl;
-            }
+            for (uint j = 0; j < G2.getNumNodes(); j++) writePair(i, j);
         }
     } else { // output only aligned pairs
-        for(uint i = 0; i < A.size(); ++i) {
-            edgeStream<<G1.getNodeName(i)<<"\t"<<G2.getNodeName(A[i]);
-            ofs<<setw(COL_WIDTH)<<edgeStream.str();
-            edgeStream.str("");
-            edgeStream.clear();
-            for (auto const & mapping : localScoreSimMap) {
-                ofs<<setw(COL_WIDTH)<<left<<setprecision(PRECISION)<<mapping.second[i][A[i]];
-            }
-            ofs<<setw(COL_WIDTH)<<left<<setprecision(PRECISION)<<localAggregatedSim[i][A[i]]<<endl;
-        }
+        for(uint i = 0; i < A.size(); ++i) writePair(i, A[i]);
     }
 }
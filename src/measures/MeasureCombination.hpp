@@ -12,6 +12,27 @@
 #include <iomanip>
 
 #include "Measure.hpp"
+#include "../utils/TopKSimMatrix.hpp"
+#include "../utils/QuantizedMatrix.hpp"
+#include "localMeasures/ImplicitSims.hpp"
+#include "localMeasures/LocalMeasure.hpp"
+
+/* The weighted sum of the local measures for a pair of nodes, computed when it is read with the same
+float operations, in the same order, as the entries of the aggregated matrix (see
+MeasureCombination::getAggregatedLocalSims), so that it is equal to them */
+class LocalSimSum {
+public:
+    LocalSimSum() {}
+    LocalSimSum(const vector<pair<const LocalMeasure*, double>>& measures): measures(measures) {}
+    float get(uint i, uint j) const {
+        float res = 0;
+        for (const auto& m : measures) res += m.second * m.first->getSim(i, j);
+        return res;
+    }
+    bool empty() const { return measures.empty(); }
+private:
+    vector<pair<const LocalMeasure*, double>> measures;
+};
 
 class MeasureCombination {
 public:
@@ -36,8 +57,33 @@ public:
     //to private variables, similar to C# get {}
     //The const postfix has been therefore been removed
     //because these functions can lead to state changes.
-    vector<vector<float>>& getAggregatedLocalSims();
-    map<string, vector<vector<float>> >& getLocalSimMap();
+    //The aggregated matrix is built on the first call, unless there is a single local measure
+    //with weight 1, in which case it is a view of its matrix (see Matrix::share and
+    //aggregatedLocalSimsAreView). Otherwise it is a matrix of its own, so SANA only uses it
+    //if it is a view, and reads the weighted sums from the measures otherwise (see getLocalSimSum)
+    const Matrix<float>& getAggregatedLocalSims();
+    bool aggregatedLocalSimsAreView() const;
+    //from each local measure with positive weight to a view of its matrix (not scaled) and its weight
+    const map<string, pair<Matrix<float>, double>>& getLocalSimMap();
+
+    /* Versions of the above for top-k mode (see LocalMeasure::setTopK). The aggregated matrix is
+    built row by row on the first call, without building the dense aggregated matrix, from the rows of the
+    measures before their top k are selected; then their dense matrices, if any, are freed. The map goes
+    from each local measure with positive weight to its own top-k matrix and its weight */
+    const TopKSimMatrix& getAggregatedLocalTopSims();
+    map<string, pair<const TopKSimMatrix*, double>> getLocalTopSimMap() const;
+    //same for reduced precision (see LocalMeasure::setPrecision)
+    const QuantizedMatrix& getAggregatedLocalQuantizedSims();
+    map<string, pair<const QuantizedMatrix*, double>> getLocalQuantizedSimMap() const;
+
+    /* The measures with implicit sims (see LocalMeasure::setImplicit) are left out of all the above,
+    so that their matrices are never built, and are in this map instead, from each of them with positive
+    weight to its implicit sims and its weight. The weighted sum of all the local measures is the
+    aggregated matrix plus the implicit sims of this map (there is no aggregated matrix to add if
+    getNumberOfLocalMeasures() is the size of the map) */
+    map<string, pair<const ImplicitSims*, double>> getLocalImplicitSimMap() const;
+    //all the local measures with positive weight, including those with implicit sims, summed on the fly
+    LocalSimSum getLocalSimSum() const;
 
     int getNumberOfLocalMeasures() const;
     void rebalanceWeight(string& input);
@@ -45,24 +91,24 @@ public:
     /*Writes out the local scores file in this format (example only of course):
     Pairwise Alignment  LocalMeasure1       LocalMeasure2       Weighted Sum
     821    723            0.334               0.214               0.548
+    The scores are read from the matrices of the measures and weighted on the fly
     */
     void writeLocalScores(ostream & outfile, Graph const & G1, Graph const & G2, Alignment const & A) const;
 
 private:
-    typedef vector<vector<float>> SimMatrix;
-    typedef function<void(SimMatrix &, uint const &, uint const &)> SimMatrixRecipe;
+    typedef Matrix<float> SimMatrix;
     vector<Measure*> measures;
     vector<double> weights;
     SimMatrix localAggregatedSim;
-    map<string, SimMatrix> localScoreSimMap;
+    map<string, pair<SimMatrix, double>> localScoreSimMap;
+    TopKSimMatrix localAggregatedTopSims;
+    QuantizedMatrix localAggregatedQuantizedSims;
+    void aggregatedLocalSimRow(uint i, vector<float>& sim, vector<float>& mSims, bool exact = false) const;
+    bool localSimMapInit;
     
     void initn1n2(uint& n1, uint& n2) const;
-
-    //Abstracts the construction of the similarity matrix. Instead of the get..()
-    //functions producing possibly different implementations of similarity matrices,
-    //a common type of similarity matrix is produced in initSim and populated
-    //by a Recipe function.
-    vector<vector<float>> initSim(SimMatrixRecipe Recipe) const;
+    //the indices in measures of the local measures with positive weight
+    vector<uint> weightedLocalMeasures(bool withImplicitSims = true) const;
 
     void clearWeights();
     void setWeight(const string& measureName, double weight);
@@ -4,17 +4,12 @@
 #include <iostream>
 
 uint NUM_GRAPHS;
-double MultiS3::Normalization_factor = 2;
-uint MultiS3::denom=1, MultiS3::numer=1, MultiS3::EL_k=0, MultiS3::ER_k=0, MultiS3::RA_k=0, MultiS3::RU_k=0, MultiS3::RO_k=0;
-vector<uint> MultiS3::totalInducedWeight(MAX_N2,0);
 MultiS3::NumeratorType MultiS3::numerator_type;
 MultiS3::DenominatorType MultiS3::denominator_type;
-double MultiS3::_type = 0;
-bool MultiS3::degreesInit = false;
-vector<uint> MultiS3::shadowDegree;
 
 
-MultiS3::MultiS3(const Graph* G1, const Graph* G2, NumeratorType _numerator_type, DenominatorType _denominator_type) : Measure(G1, G2, "ms3") {
+MultiS3::MultiS3(const Graph* G1, const Graph* G2, NumeratorType _numerator_type, DenominatorType _denominator_type) : Measure(G1, G2, "ms3"),
+        normalizationFactor(2) {
 #ifdef MULTI_PAIRWISE
     extern char *getetv(char*);
     char *s = getenv((char*)"NUM_GRAPHS");
@@ -71,22 +66,13 @@ MultiS3::MultiS3(const Graph* G1, const Graph* G2, NumeratorType _numerator_type
     }
     
     cout << "Multi S3: NUM_GRAPHS = " << NUM_GRAPHS << endl;
-    degreesInit = false;
+    initNormalizationFactor();
 #endif
 }
 
 MultiS3::~MultiS3() {}
 
-void MultiS3::setDenom(const Alignment& A) {
-    denom = 0;
-    const uint n1 = G1->getNumNodes();
-    for (uint i = 0; i < n1; i++) {
-        if (shadowDegree[i] > 0) denom += n1-1-i; // Nil correctly compressed this from SANA1.1 but I think SANA1.1 was wrong
-    }
-    denom /= 2;
-}
-
-void MultiS3::getNormalizationFactor() const {
+void MultiS3::initNormalizationFactor() {
 #ifdef MULTI_PAIRWISE
     double factor_denom = 0;
     uint peg1, peg2;
@@ -127,12 +113,12 @@ void MultiS3::getNormalizationFactor() const {
 	case numer_default:
         case ra_k:
         {
-            Normalization_factor = G1->getEdgeList()->size() * NUM_GRAPHS / factor_denom;
+            normalizationFactor = G1->getEdgeList()->size() * NUM_GRAPHS / factor_denom;
         }
             break;
         case la_k:
         {
-            Normalization_factor = G1->getEdgeList()->size() / factor_denom;
+            normalizationFactor = G1->getEdgeList()->size() / factor_denom;
         }
             break;
         case la_global:
@@ -143,7 +129,7 @@ void MultiS3::getNormalizationFactor() const {
                 peg1 = edge[0], peg2 = edge[1];
                 temp_max = G2->getEdgeWeight(peg1,peg2) + 1 > temp_max ? G2->getEdgeWeight(peg1,peg2) + 1 : temp_max;
             }
-            Normalization_factor = temp_max * G2->getEdgeList()->size() / factor_denom / 2;
+            normalizationFactor = temp_max * G2->getEdgeList()->size() / factor_denom / 2;
         }
             break;
         case ra_global:
@@ -154,16 +140,16 @@ void MultiS3::getNormalizationFactor() const {
                 peg1 = edge[0], peg2 = edge[1];
                 temp_max = G2->getEdgeWeight(peg1,peg2) + 1 > temp_max ? G2->getEdgeWeight(peg1,peg2) + 1 : temp_max;
             }
-            Normalization_factor = temp_max * G2->getEdgeList()->size() / factor_denom;
+            normalizationFactor = temp_max * G2->getEdgeList()->size() / factor_denom;
         }
             break;
     }
-    //cout << "Normalization factor is " << Normalization_factor << endl;
-#else
-return;
+    //cout << "Normalization factor is " << normalizationFactor << endl;
 #endif
 }
 
+double MultiS3::getNormalizationFactor() const { return normalizationFactor; }
+
 
 uint MultiS3::computeNumer(const Alignment& A) const {
 #ifdef MULTI_PAIRWISE
@@ -241,6 +227,11 @@ uint MultiS3::computeNumer(const Alignment& A) const {
 }
 
 uint MultiS3::computeDenom(const Alignment& A) const {
+    RungCounts counts;
+    return computeDenom(A, counts);
+}
+
+uint MultiS3::computeDenom(const Alignment& A, RungCounts& counts) const {
     uint ret = 0;
 #ifdef MULTI_PAIRWISE
     const uint n1 = G1->getNumNodes();
@@ -254,6 +245,7 @@ uint MultiS3::computeDenom(const Alignment& A) const {
         {
 	    // RU=rungs under non-edges; RO=rungs outside alignment
 	    uint ret0=0, ret1=0, ret2=0, RU_k1=0, RU_k2=0, RO_k2=0;
+	    uint &ER_k = counts.ER_k, &EL_k = counts.EL_k, &RA_k = counts.RA_k, &RU_k = counts.RU_k, &RO_k = counts.RO_k;
 	    ER_k = 0; // edges(rungs) = edges in G1 that have at least one associated rung 
 	    EL_k = 0; // edges(lonely) = complement of ER_k wrt E_k = lonely edges = edges with zero associated rungs
 	    RA_k = 0; // number of actual rungs associated with those in ER_k.
@@ -285,7 +277,7 @@ uint MultiS3::computeDenom(const Alignment& A) const {
 	    // METHOD 2(cheaper): loop only through all node pairs in G1
 	    RO_k2 = G2->getTotalEdgeWeight();
 	    assert(RO_k2);
-            for (uint i = 0; i < n2; ++i) totalInducedWeight[i] = 0;
+            vector<uint> totalInducedWeight(n2, 0);
 
             for (uint i = 0; i < n1; ++i) {
 		for (uint j = 0; j < i; ++j){
@@ -321,7 +313,7 @@ uint MultiS3::computeDenom(const Alignment& A) const {
 	    uint MRE = (NUM_GRAPHS)*ER_k + EL_k + RU_k1;
 	    if(denominator_type == mre_k) ret = MRE;
 	    else ret = ret2;
-	    cerr << "numer " << numer << " ra_k " << RA_k << " rt_k " << ret2 << " mre_k " << MRE << '\n';
+	    cerr << "ra_k " << RA_k << " rt_k " << ret2 << " mre_k " << MRE << '\n';
         }
 	break;
         case ee_k:
@@ -365,13 +357,6 @@ uint MultiS3::computeDenom(const Alignment& A) const {
             break;
         default:
         {
-#if 0	    //const uint n1 = G1->getNumNodes();
-	    if (not degreesInit) initDegrees(A, *G1, *G2);
-            for (uint i = 0; i < n1; i++) {
-                if (shadowDegree[i] > 0) ret += n1-1-i; // Nil correctly compressed this from SANA1.1 but I think SANA1.1 was wrong
-            } // Modified shadowDegree[i] ---> shadowDegree[A[i]]
-            ret /= 2;
-#else
 	    for (uint i = 0; i < n1-1; ++i)
 	    {
                 for (uint j = i+1; j < n1; ++j)
@@ -380,7 +365,6 @@ uint MultiS3::computeDenom(const Alignment& A) const {
 			++ret;
 		}
 	    }
-#endif
         }
             break;
     }
@@ -392,33 +376,20 @@ uint MultiS3::computeDenom(const Alignment& A) const {
 
 double MultiS3::eval(const Alignment& A) {
 #if MULTI_PAIRWISE
-    getNormalizationFactor();
-    if (not degreesInit) initDegrees(A, *G1, *G2);
-
-
-//    if (_type==1) denom = EdgeExposure::numExposedEdges(A, *G1, *G2);
-//    else if (_type==0) setDenom(A);
-    denom = computeDenom(A);
-    uint correctNumer = computeNumer(A);
-    if(correctNumer != numer) {
-        cerr<<"inc eval MS3numer wrong: should be "<<correctNumer<<" but is "<<numer<<endl;
-        numer = correctNumer;
-    }
-    return ((double) numer) / denom / Normalization_factor;//NUM_GRAPHS;
+    return ((double) computeNumer(A)) / computeDenom(A) / normalizationFactor;//NUM_GRAPHS;
 #else
     return 0.0;
 #endif
 }
 
-void MultiS3::initDegrees(const Alignment& A, const Graph& G1, const Graph& G2) {
-    shadowDegree = vector<uint>(G2.getNumNodes(), 0);
-    for (uint i = 0; i < G2.getNumNodes(); i++) shadowDegree[i] = G2.getNumNbrs(i);
-    for (const auto& edge : *(G2.getEdgeList())) {
-        auto w = G2.getEdgeWeight(edge[0],edge[1]);
+vector<uint> MultiS3::computeShadowDegrees(const Alignment& A) const {
+    vector<uint> shadowDegree(G2->getNumNodes(), 0);
+    for (uint i = 0; i < G2->getNumNodes(); i++) shadowDegree[i] = G2->getNumNbrs(i);
+    for (const auto& edge : *(G2->getEdgeList())) {
+        auto w = G2->getEdgeWeight(edge[0],edge[1]);
         shadowDegree[edge[0]] += w; // doesn't this overcount by 1 since we already set it to getNumNbrs(i) above?
         if (edge[0] != edge[1]) shadowDegree[edge[1]] += w; //avoid double-counting for self-lopos
     }
-    for (uint i = 0; i < G1.getNumNodes(); ++i) shadowDegree[A[i]] += 1;
-    degreesInit = true;
+    for (uint i = 0; i < G1->getNumNodes(); ++i) shadowDegree[A[i]] += 1;
+    return shadowDegree;
 }
-
@@ -9,8 +9,6 @@
 
 extern uint NUM_GRAPHS;
 
-static const uint MAX_N2=100000;
-
 class MultiS3 : public Measure {
 public:
     enum NumeratorType{numer_default, ra_k, la_k, la_global, ra_global};
@@ -21,25 +19,30 @@ public:
     MultiS3(const  Graph* G1, const Graph* G2, NumeratorType _numerator_type, DenominatorType _denominator_type);
     virtual ~MultiS3();
     double eval(const Alignment& A);
-    static vector<uint> shadowDegree; // sum of neighboring edge weights including G1
 
-    //denom is the number of ladders under G1
-    void setDenom(const Alignment& A);
+    //statistics about the "ladders" under the edges of G1, computed as a by-product of computeDenom
+    //for the rt_k and mre_k denominators
+    struct RungCounts {
+        uint ER_k = 0; // |ER_k| where ER_k = edges in G with at least one rung in its tower, other than itself
+        uint EL_k = 0; // |EL_k| where EL_k = complement of ER_k wrt E_k, ie., lonely edges in G
+        uint RA_k = 0; // |RA_k| where RA_k = rungs under edges, ie rungs under edges in ER_k.
+        uint RU_k = 0; // |RU_k| where RU_k = rungs under non-edges in G
+        uint RO_k = 0; // |RO_k| where RO_k = rungs outside, ie rungs with at least one endpoint not under a peg.
+    };
+
+    //the measure holds no alignment-dependent state: SANA keeps the incremental numerator, denominator
+    //and shadow degrees of its own alignment, so several SANA objects can use the same measure
     uint computeNumer(const Alignment& A) const;
     uint computeDenom(const Alignment& A) const;
-    void getNormalizationFactor() const;
+    uint computeDenom(const Alignment& A, RungCounts& counts) const;
 
-    //these don't belong here, they should be members in SANA -Nil
-    // WH: Not sure I agree, these are MS3 specific... OTOH measure *values* are associated with a specific alignment,
-    // and putting these in *either* SANA:: or here breaks when there are multiple Alignment instances.
-    static uint numer, denom, ER_k, EL_k, RA_k, RU_k, RO_k; // computed from scratch; compare to incremental values in SANA.cpp
-    static vector<uint> totalInducedWeight; // total weight of shadow node induced only on the aligned edges of G1.
-    static double Normalization_factor;
-    static double _type; //0 default ; 1 ee
+    //sum of neighboring edge weights including G1 for every node of G2
+    vector<uint> computeShadowDegrees(const Alignment& A) const;
+    double getNormalizationFactor() const;
 
 private:
-    static void initDegrees(const Alignment& A, const Graph& G1, const Graph& G2);
-    static bool degreesInit;
+    double normalizationFactor;
+    void initNormalizationFactor();
 };
 #endif
 
@@ -112,3 +112,33 @@ bool NodeCorrectness::fulfillsPrereqs(const Graph* G1, const Graph* G2) {
     return G1->hasSameNodeNamesAs(*G2);
 }
 
+
+const char* NodeCorrectness::Incremental::NAME = "nc";
+
+void NodeCorrectness::Incremental::setUp(const Graph*, const Graph*, MeasureCombination* MC) {
+    trueAWithValidCountAppended = ((NodeCorrectness*) MC->getMeasure(NAME))->getMappingforNC();
+}
+
+void NodeCorrectness::Incremental::reset(const Alignment& A) {
+    uint count = 0;
+    for (uint i = 0; i < A.size(); i++) {
+        if (A[i] == trueAWithValidCountAppended[i]) count++;
+    }
+    sum = count;
+}
+
+void NodeCorrectness::Incremental::proposeChange(const vector<uint>&, uint peg, uint oldHole, uint newHole) {
+    int change = 0;
+    if (trueAWithValidCountAppended[peg] == oldHole) change -= 1;
+    if (trueAWithValidCountAppended[peg] == newHole) change += 1;
+    proposedSum = sum + change;
+}
+
+void NodeCorrectness::Incremental::proposeSwap(const vector<uint>&, uint peg1, uint peg2, uint hole1, uint hole2) {
+    int change = 0;
+    if (trueAWithValidCountAppended[peg1] == hole1) change -= 1;
+    if (trueAWithValidCountAppended[peg2] == hole2) change -= 1;
+    if (trueAWithValidCountAppended[peg1] == hole2) change += 1;
+    if (trueAWithValidCountAppended[peg2] == hole1) change += 1;
+    proposedSum = sum + change;
+}
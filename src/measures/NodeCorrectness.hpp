@@ -2,6 +2,7 @@
 #define NODECORRECTNESS_HPP
 #include <vector>
 #include "Measure.hpp"
+#include "IncrementalMeasure.hpp"
 
 class NodeCorrectness: public Measure {
 public:
@@ -12,6 +13,20 @@ public:
     virtual vector<uint> getMappingforNC() const;
     static vector<uint> createTrueAlignment(const Graph& G1, const Graph& G2, const vector<string>& E);        
     static bool fulfillsPrereqs(const Graph* G1, const Graph* G2);
+
+    //incremental evaluation of the number of correctly aligned nodes (see IncrementalMeasure)
+    class Incremental: public IncrementalMeasure<Incremental> {
+    public:
+        static const char* NAME;
+        static const NonSumAggregation AGGREGATION = NonSumAggregation::FACTOR;
+        void setUp(const Graph* G1, const Graph* G2, MeasureCombination* MC);
+        void reset(const Alignment& A);
+        void proposeChange(const vector<uint>& A, uint peg, uint oldHole, uint newHole);
+        void proposeSwap(const vector<uint>& A, uint peg1, uint peg2, uint hole1, uint hole2);
+        double scoreOfSum(double s) const { return s / trueAWithValidCountAppended.back(); }
+    private:
+        vector<uint> trueAWithValidCountAppended;
+    };
     
 private:
     vector<uint> trueAWithValidCountAppended;
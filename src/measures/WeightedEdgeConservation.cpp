@@ -13,13 +13,12 @@ LocalMeasure* WeightedEdgeConservation::getNodeSimMeasure() {
 }
 
 double WeightedEdgeConservation::eval(const Alignment& A) {
-    vector<vector<float>>* simMatrix = nodeSim->getSimMatrix();
     double score = 0;
     for (const auto& edge: *(G1->getEdgeList())) {
         uint node1 = edge[0], node2 = edge[1];
         if (G2->hasEdge(A[node1],A[node2])) {
-            score += (*simMatrix)[node1][A[node1]];
-            score += (*simMatrix)[node2][A[node2]];
+            score += nodeSim->getSim(node1, A[node1]);
+            score += nodeSim->getSim(node2, A[node2]);
         }
     }
     //normalization factor to ensure 0 <= score <= 1
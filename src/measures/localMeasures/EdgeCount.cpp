@@ -1,5 +1,10 @@
 #include <vector>
+#include <cmath>
+#include <algorithm>
 #include <iostream>
+#include <sstream>
+#include <iomanip>
+#include <limits>
 #include "EdgeCount.hpp"
 #include "../../utils/FileIO.hpp"
 
@@ -18,43 +23,64 @@ EdgeCount::EdgeCount(const Graph* G1, const Graph* G2, const vector<double>& dis
         fileName += "_" + extractDecimals(w, 3);
     fileName += ".bin";
 
-    loadBinSimMatrix(fileName);
+    //the file name rounds the weights, so the cache key uses them in full precision
+    ostringstream parameters;
+    parameters << setprecision(numeric_limits<double>::max_digits10) << "distWeights=";
+    for (double w : normWeights)
+        parameters << " " << w;
+    loadBinSimMatrix(fileName, parameters.str());
 }
 
-void EdgeCount::initSimMatrix() {
-    uint n1 = G1->getNumNodes();
-    uint n2 = G2->getNumNodes();
+vector<vector<uint>> EdgeCount::cumulativeCounts(const Graph* G) const {
+    uint n = G->getNumNodes();
     uint k = distWeights.size();
-    vector<vector<uint>> densities1 (n1, vector<uint> (k+1));
-    vector<vector<uint>> densities2 (n2, vector<uint> (k+1));
-    for (uint i = 0; i < n1; i++) {
-        densities1[i] = G1->numEdgesAroundByLayers(i, k);
-        for (uint j = 1; j < k; j++) {
-            densities1[i][j] += densities1[i][j-1];
-        } 
-    }
-    for (uint i = 0; i < n2; i++) {
-        densities2[i] = G2->numEdgesAroundByLayers(i, k);
+    vector<vector<uint>> densities (n);
+    for (uint i = 0; i < n; i++) {
+        densities[i] = G->numEdgesAroundByLayers(i, k);
         for (uint j = 1; j < k; j++) {
-            densities2[i][j] += densities2[i][j-1];
+            densities[i][j] += densities[i][j-1];
         }
     }
-    sims = vector<vector<float>> (n1, vector<float> (n2, 0));
+    return densities;
+}
+
+void EdgeCount::initSimMatrix() {
+    initSimMatrixByRows();
+}
+
+bool EdgeCount::initSimRows() {
+    densities1 = cumulativeCounts(G1);
+    densities2 = cumulativeCounts(G2);
+    return true;
+}
+
+void EdgeCount::simRow(uint i, float* row) const {
+    uint n2 = G2->getNumNodes();
+    uint k = distWeights.size();
+    fill(row, row + n2, 0);
     for (uint h = 0; h < k; h++) {
         if (distWeights[h] > 0) {
-            for (uint i = 0; i < n1; i++) {
-                for (uint j = 0; j < n2; j++) {
-                    if (densities1[i][h] < densities2[j][h]) {
-                        sims[i][j] += ((double) densities1[i][h]/densities2[j][h]) * distWeights[h];
-                    }
-                    else {
-                        sims[i][j] += ((double) densities2[j][h]/densities1[i][h]) * distWeights[h];
-                    }
+            for (uint j = 0; j < n2; j++) {
+                if (densities1[i][h] < densities2[j][h]) {
+                    row[j] += ((double) densities1[i][h]/densities2[j][h]) * distWeights[h];
+                }
+                else {
+                    row[j] += ((double) densities2[j][h]/densities1[i][h]) * distWeights[h];
                 }
             }
         }
     }
 }
 
+void EdgeCount::initImplicitSims() {
+    vector<double> features1, features2;
+    for (const vector<uint>& densities : cumulativeCounts(G1))
+        features1.insert(features1.end(), densities.begin(), densities.end());
+    for (const vector<uint>& densities : cumulativeCounts(G2))
+        features2.insert(features2.end(), densities.begin(), densities.end());
+    //the ratio of two nodes with no edges within some distance is 0/0 (NaN), as in the matrix
+    implicitSims = ImplicitSims::weightedRatio(features1, features2, distWeights, NAN);
+}
+
 EdgeCount::~EdgeCount() {
 }
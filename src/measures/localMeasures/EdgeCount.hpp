@@ -9,6 +9,12 @@ public:
 private:
     vector<double> distWeights;
     void initSimMatrix();
+    bool initSimRows();
+    void simRow(uint i, float* row) const;
+    vector<vector<uint>> densities1, densities2;
+    void initImplicitSims();
+    //for each node, the number of edges within distance 1, 2, ..., distWeights.size()
+    vector<vector<uint>> cumulativeCounts(const Graph* G) const;
 };
 
 #endif
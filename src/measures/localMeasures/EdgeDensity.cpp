@@ -1,6 +1,7 @@
 #include "EdgeDensity.hpp"
 
 #include <vector>
+#include <cmath>
 #include <queue>
 #include <iostream>
 #include "../../utils/FileIO.hpp"
@@ -12,7 +13,7 @@ EdgeDensity::EdgeDensity(const Graph* G1, const Graph* G2, uint maxDist) : Local
     FileIO::createFolder(subfolder);
     string fileName = subfolder+G1->getName()+"_"+G2->getName()+"_edged.bin";
     this->maxDist = maxDist;
-    loadBinSimMatrix(fileName);
+    loadBinSimMatrix(fileName, "maxDist="+to_string(maxDist));
 }
 
 double EdgeDensity::calcEdgeDensity(const Graph* G, uint originNode, uint maxDist) const {
@@ -57,25 +58,32 @@ vector<double> EdgeDensity::generateVector(const Graph* G, uint maxDist) const {
     return edged;
 }
 
-float EdgeDensity::compare(double n1, double n2) {
+float EdgeDensity::compare(double n1, double n2) const {
     if (n1 > n2) return (n2 / n1);
     return (n1 / n2);
 }
 
 void EdgeDensity::initSimMatrix() {
+    initSimMatrixByRows();
+}
+
+bool EdgeDensity::initSimRows() {
     edged1 = generateVector(G1, maxDist);
     edged2 = generateVector(G2, maxDist);
-    uint size1 = edged1.size();
-    uint size2 = edged2.size();
-
-    sims = vector<vector<float>> (size1, vector<float> (size2, 0));
+    return true;
+}
 
-    for(uint i = 0; i < size1;  ++i) {
-        for(uint j = 0; j < size2;  ++j) {
-            sims[i][j] = compare(edged1[i], edged2[j]);
-        }
+void EdgeDensity::simRow(uint i, float* row) const {
+    uint size2 = edged2.size();
+    for(uint j = 0; j < size2;  ++j) {
+        row[j] = compare(edged1[i], edged2[j]);
     }
 }
 
+void EdgeDensity::initImplicitSims() {
+    //compare() is the ratio of the densities, so 0/0 (NaN) if both are 0
+    implicitSims = ImplicitSims::weightedRatio(generateVector(G1, maxDist), generateVector(G2, maxDist), {1}, NAN);
+}
+
 EdgeDensity::~EdgeDensity() {
 }
@@ -8,7 +8,10 @@ public:
     virtual ~EdgeDensity();
 private:
     void initSimMatrix();
-    float compare(double n1, double n2);
+    bool initSimRows();
+    void simRow(uint i, float* row) const;
+    void initImplicitSims();
+    float compare(double n1, double n2) const;
     double calcEdgeDensity(const Graph* G, uint originNode, uint maxDist) const;
     vector<double> generateVector(const Graph* G, uint maxDist) const;
     vector<double> edged1;
@@ -2,6 +2,7 @@
 #include "ExternalSimMatrix.hpp"
 #include "../../utils/utils.hpp"
 #include "../../utils/FileIO.hpp"
+#include "SimMatrixCache.hpp"
 
 #include <string>
 using namespace std;
@@ -11,9 +12,10 @@ ExternalSimMatrix::ExternalSimMatrix(const Graph* G1, const Graph* G2, string fi
     this->format = format;
     string subfolder = autogenMatricesFolder+getName()+"/";
     FileIO::createFolder(subfolder);
+    //the path of the input file is in the parameters, so only its name goes in the file name
     string fileName = subfolder+G1->getName()+"_"+
-        G2->getName()+"_esim_"+file;
-    loadBinSimMatrix(fileName);
+        G2->getName()+"_esim_"+FileIO::fileNameWithoutPath(file)+".bin";
+    loadBinSimMatrix(fileName, SimMatrixCache::fileStamp(file)+" format="+to_string(format));
 }
 
 void ExternalSimMatrix::initSimMatrix() {
@@ -21,7 +23,7 @@ void ExternalSimMatrix::initSimMatrix() {
     FILE* fp = FileIO::readFileAsFilePointer(file, isPiped);
     uint n1 = G1->getNumNodes();
     uint n2 = G2->getNumNodes();
-    sims = vector<vector<float>> (n1, vector<float> (n2, 0));
+    sims = Matrix<float> (n1, n2);
 
     if (fp == nullptr) {
         throw runtime_error("ExternalSimMatrix: Error opening file");
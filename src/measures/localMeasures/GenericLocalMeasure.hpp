@@ -4,7 +4,7 @@
 
 class GenericLocalMeasure: public LocalMeasure {
 public:
-    GenericLocalMeasure(const Graph* G1, const Graph* G2, string name, const vector<vector<float>>& simMatrix);
+    GenericLocalMeasure(const Graph* G1, const Graph* G2, string name, const Matrix<float>& simMatrix);
     virtual ~GenericLocalMeasure();
 private:
 
@@ -9,6 +9,7 @@
 #include <unordered_set>
 #include <unordered_map>
 #include "../../utils/FileIO.hpp"
+#include "SimMatrixCache.hpp"
 
 
 using namespace std;
@@ -33,7 +34,11 @@ GoSimilarity::GoSimilarity(const Graph* G1, const Graph* G2,
     fileName += "_frac_"+extractDecimals(occurrencesFraction, 3);
     fileName += ".bin";
 
-    loadBinSimMatrix(fileName);
+    //the GO annotations that the matrix is computed from
+    string parameters = SimMatrixCache::fileStamp(biogridGOFile);
+    for (const Graph* G : {G1, G2})
+        parameters += " "+SimMatrixCache::fileStamp("networks/"+G->getName()+"/go/"+G->getName()+"_gene_association.txt");
+    loadBinSimMatrix(fileName, parameters);
 }
 
 string GoSimilarity::getGoSimpleFileName(const Graph& G) {
@@ -203,7 +208,7 @@ vector<vector<uint>> GoSimilarity::loadGOTerms(
 void GoSimilarity::initSimMatrix() {
     uint n1 = G1->getNumNodes();
     uint n2 = G2->getNumNodes();
-    sims = vector<vector<float>> (n1, vector<float> (n2, 0));
+    sims = Matrix<float> (n1, n2);
 
     vector<vector<uint>> G1GOTerms = loadGOTerms(*G1, occurrencesFraction);
     vector<vector<uint>> G2GOTerms = loadGOTerms(*G2, occurrencesFraction);
@@ -214,7 +219,7 @@ void GoSimilarity::initSimMatrix() {
         accumulativeWeights[i] += accumulativeWeights[i-1];
     }
 
-    sims = vector<vector<float>> (n1, vector<float> (n2, 0));
+    sims = Matrix<float> (n1, n2);
     for (uint i = 0; i < n1; i++) {
         for (uint j = 0; j < n2; j++) {
             uint count = 0;
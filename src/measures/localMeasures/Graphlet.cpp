@@ -12,7 +12,7 @@ Graphlet::Graphlet(const Graph* G1, const Graph* G2, uint maxGraphletSize) :
     string subfolder = autogenMatricesFolder+getName()+"/";
     FileIO::createFolder(subfolder);
     string fileName = subfolder+G1->getName()+"_"+G2->getName()+"_graphlet.bin";
-    loadBinSimMatrix(fileName);
+    loadBinSimMatrix(fileName, "maxGraphletSize="+to_string(maxGraphletSize));
 }
 
 Graphlet::~Graphlet() {}
@@ -50,23 +50,27 @@ double Graphlet::getOrbitWeightSum() const {
 }
 
 void Graphlet::initSimMatrix() {
-    uint n1 = G1->getNumNodes();
-    uint n2 = G2->getNumNodes();
-    sims = vector<vector<float>> (n1, vector<float> (n2, 0));
-    vector<vector<uint>> gdvs1 = ComputeGraphletsWrapper::loadGraphletDegreeVectors(*G1, maxGraphletSize);
-    vector<vector<uint>> gdvs2 = ComputeGraphletsWrapper::loadGraphletDegreeVectors(*G2, maxGraphletSize);
+    initSimMatrixByRows();
+}
 
-    vector<double> orbitWeights = getOrbitWeights();
-    double weightSum = getOrbitWeightSum();
-    for (uint i = 0; i < n1; i++) {
-        for (uint j = 0; j < n2; j++) {
-            double orbitDistanceSum = 0;
-            for (uint k = 0; k < NUM_ORBITS; k++) {
-                orbitDistanceSum += orbitWeights[k] *
-                    abs(log2(gdvs1[i][k] + 1) - log2(gdvs2[j][k] + 1)) /
-                    log2(max(gdvs1[i][k], gdvs2[j][k]) + 2);
-            }
-            sims[i][j] = 1 - orbitDistanceSum/weightSum;
+bool Graphlet::initSimRows() {
+    gdvs1 = ComputeGraphletsWrapper::loadGraphletDegreeVectors(*G1, maxGraphletSize);
+    gdvs2 = ComputeGraphletsWrapper::loadGraphletDegreeVectors(*G2, maxGraphletSize);
+
+    orbitWeights = getOrbitWeights();
+    weightSum = getOrbitWeightSum();
+    return true;
+}
+
+void Graphlet::simRow(uint i, float* row) const {
+    uint n2 = G2->getNumNodes();
+    for (uint j = 0; j < n2; j++) {
+        double orbitDistanceSum = 0;
+        for (uint k = 0; k < NUM_ORBITS; k++) {
+            orbitDistanceSum += orbitWeights[k] *
+                abs(log2(gdvs1[i][k] + 1) - log2(gdvs2[j][k] + 1)) /
+                log2(max(gdvs1[i][k], gdvs2[j][k]) + 2);
         }
+        row[j] = 1 - orbitDistanceSum/weightSum;
     }
 }
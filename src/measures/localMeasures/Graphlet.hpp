@@ -12,6 +12,11 @@ private:
     const uint NUM_ORBITS = 73;
 	
     void initSimMatrix();
+    bool initSimRows();
+    void simRow(uint i, float* row) const;
+    vector<vector<uint>> gdvs1, gdvs2;
+    vector<double> orbitWeights;
+    double weightSum;
 
     vector<double> getNumbersOfAffectedOrbits() const;
     vector<double> getOrbitWeights() const;
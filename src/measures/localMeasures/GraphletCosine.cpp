@@ -12,12 +12,12 @@ GraphletCosine::GraphletCosine(const Graph* G1, const Graph* G2, uint maxGraphle
     string subfolder = autogenMatricesFolder+getName()+"/";
     FileIO::createFolder(subfolder);
     string fileName = subfolder+G1->getName()+"_"+G2->getName()+"_graphletcosine.bin";
-    loadBinSimMatrix(fileName);
+    loadBinSimMatrix(fileName, "maxGraphletSize="+to_string(maxGraphletSize));
 }
 
 GraphletCosine::~GraphletCosine() {}
 
-double GraphletCosine::magnitude(vector<uint> &vector) {
+double GraphletCosine::magnitude(const vector<uint> &vector) const {
     double res = 0;
     for(uint i = 0; i < vector.size(); ++i) {
         res += vector[i] * static_cast<double>(vector[i]);
@@ -25,7 +25,7 @@ double GraphletCosine::magnitude(vector<uint> &vector) {
     return sqrt(res);
 }
 
-double GraphletCosine::dot(vector<uint> &v1, vector<uint> &v2) {
+double GraphletCosine::dot(const vector<uint> &v1, const vector<uint> &v2) const {
     double res = 0;
     for(uint i = 0; i < v1.size(); ++i) {
         res += v1[i] * static_cast<double>(v2[i]);
@@ -33,11 +33,11 @@ double GraphletCosine::dot(vector<uint> &v1, vector<uint> &v2) {
     return res;
 }
 
-double GraphletCosine::cosineSimilarity(vector<uint> &v1, vector<uint> &v2) {
+double GraphletCosine::cosineSimilarity(const vector<uint> &v1, const vector<uint> &v2) const {
     return dot(v1, v2) / (magnitude(v1) * magnitude(v2));
 }
 
-vector<uint> GraphletCosine::reduce(vector<uint> &v) {
+vector<uint> GraphletCosine::reduce(const vector<uint> &v) const {
     vector<uint> res(11);
     res[0] = v[0];
     res[1] = v[1];
@@ -54,22 +54,25 @@ vector<uint> GraphletCosine::reduce(vector<uint> &v) {
 }
 
 void GraphletCosine::initSimMatrix() {
-    uint n1 = G1->getNumNodes();
-    uint n2 = G2->getNumNodes();
-    sims = vector<vector<float>> (n1, vector<float> (n2, 0));
-    vector<vector<uint>> gdvs1 = ComputeGraphletsWrapper::loadGraphletDegreeVectors(*G1, maxGraphletSize);
-    vector<vector<uint>> gdvs2 = ComputeGraphletsWrapper::loadGraphletDegreeVectors(*G2, maxGraphletSize);
+    initSimMatrixByRows();
+}
 
+bool GraphletCosine::initSimRows() {
+    gdvs1 = ComputeGraphletsWrapper::loadGraphletDegreeVectors(*G1, maxGraphletSize);
+    gdvs2 = ComputeGraphletsWrapper::loadGraphletDegreeVectors(*G2, maxGraphletSize);
+    return true;
+}
+
+void GraphletCosine::simRow(uint i, float* row) const {
+    uint n2 = G2->getNumNodes();
     bool shouldReduce = false;
-    for (uint i = 0; i < n1; i++) {
-        for (uint j = 0; j < n2; j++) {
-            if (shouldReduce) {
-                vector<uint> v1 = reduce(gdvs1[i]);
-                vector<uint> v2 = reduce(gdvs2[j]);
-                sims[i][j] = cosineSimilarity(v1, v2);
-            } else {
-                sims[i][j] = cosineSimilarity(gdvs1[i], gdvs2[j]);
-            }
+    for (uint j = 0; j < n2; j++) {
+        if (shouldReduce) {
+            vector<uint> v1 = reduce(gdvs1[i]);
+            vector<uint> v2 = reduce(gdvs2[j]);
+            row[j] = cosineSimilarity(v1, v2);
+        } else {
+            row[j] = cosineSimilarity(gdvs1[i], gdvs2[j]);
         }
     }
 }
@@ -10,11 +10,14 @@ public:
 private:
 	uint maxGraphletSize;
     void initSimMatrix();
-    vector<uint> reduce(vector<uint> &v);
+    bool initSimRows();
+    void simRow(uint i, float* row) const;
+    vector<vector<uint>> gdvs1, gdvs2;
+    vector<uint> reduce(const vector<uint> &v) const;
     const uint NUM_ORBITS = 73;
-    double cosineSimilarity(vector<uint> &v1, vector<uint> &v2);
-    double dot(vector<uint> &v1, vector<uint> &v2);
-    double magnitude(vector<uint> &vector);
+    double cosineSimilarity(const vector<uint> &v1, const vector<uint> &v2) const;
+    double dot(const vector<uint> &v1, const vector<uint> &v2) const;
+    double magnitude(const vector<uint> &vector) const;
 };
 
 #endif
@@ -11,7 +11,7 @@ GraphletLGraal::GraphletLGraal(const Graph* G1, const Graph* G2, uint maxGraphle
     string subfolder = autogenMatricesFolder+getName()+"/";
     FileIO::createFolder(subfolder);
     string fileName = subfolder+G1->getName()+"_"+G2->getName()+"_graphletlgraal.bin";
-    loadBinSimMatrix(fileName);
+    loadBinSimMatrix(fileName, "maxGraphletSize="+to_string(maxGraphletSize));
 }
 
 GraphletLGraal::~GraphletLGraal() {}
@@ -27,15 +27,18 @@ double GraphletLGraal::gdvSim(uint i, uint j,
 }
 
 void GraphletLGraal::initSimMatrix() {
-    uint n1 = G1->getNumNodes();
-    uint n2 = G2->getNumNodes();
-    sims = vector<vector<float>> (n1, vector<float> (n2, 0));
-    vector<vector<uint>> gdvs1 = ComputeGraphletsWrapper::loadGraphletDegreeVectors(*G1, maxGraphletSize);
-    vector<vector<uint>> gdvs2 = ComputeGraphletsWrapper::loadGraphletDegreeVectors(*G2, maxGraphletSize);
+    initSimMatrixByRows();
+}
 
-    for (uint i = 0; i < n1; i++) {
-        for (uint j = 0; j < n2; j++) {
-            sims[i][j] = gdvSim(i,j,gdvs1,gdvs2);
-        }
+bool GraphletLGraal::initSimRows() {
+    gdvs1 = ComputeGraphletsWrapper::loadGraphletDegreeVectors(*G1, maxGraphletSize);
+    gdvs2 = ComputeGraphletsWrapper::loadGraphletDegreeVectors(*G2, maxGraphletSize);
+    return true;
+}
+
+void GraphletLGraal::simRow(uint i, float* row) const {
+    uint n2 = G2->getNumNodes();
+    for (uint j = 0; j < n2; j++) {
+        row[j] = gdvSim(i,j,gdvs1,gdvs2);
     }
 }
@@ -10,6 +10,9 @@ public:
 private:
 	uint maxGraphletSize;
     void initSimMatrix();
+    bool initSimRows();
+    void simRow(uint i, float* row) const;
+    vector<vector<uint>> gdvs1, gdvs2;
     
     double gdvSim(uint i, uint j, const vector<vector<uint>>& gdvsG1,
         const vector<vector<uint>>& gdvsG2) const;
@@ -11,12 +11,12 @@ GraphletNorm::GraphletNorm(const Graph* G1, const Graph* G2, uint maxGraphletSiz
     string subfolder = autogenMatricesFolder+getName()+"/";
     FileIO::createFolder(subfolder);
     string fileName = subfolder+G1->getName()+"_"+G2->getName()+"_graphletnorm.bin";
-    loadBinSimMatrix(fileName);
+    loadBinSimMatrix(fileName, "maxGraphletSize="+to_string(maxGraphletSize));
 }
 
 GraphletNorm::~GraphletNorm() {}
 
-double GraphletNorm::magnitude(vector<uint> &vector) {
+double GraphletNorm::magnitude(const vector<uint> &vector) const {
     double res = 0;
     for(uint i = 0; i < vector.size(); ++i)
         res += vector[i] * static_cast<double>(vector[i]);
@@ -24,7 +24,7 @@ double GraphletNorm::magnitude(vector<uint> &vector) {
 }
 
 //return the unit vector of v
-vector<double> GraphletNorm::NODV(vector<uint> &v){
+vector<double> GraphletNorm::NODV(const vector<uint> &v) const {
     double mag = magnitude(v);
     if (mag == 0) {
         vector<double> empty(v.size());
@@ -35,13 +35,13 @@ vector<double> GraphletNorm::NODV(vector<uint> &v){
     return res;
 }
 
-double GraphletNorm::ODVratio(vector<double> &u, vector<double> &v, uint i){
+double GraphletNorm::ODVratio(const vector<double> &u, const vector<double> &v, uint i) const {
     if(u[i] == v[i]) return 1;
     return min(u[i], v[i]) / max(u[i], v[i]);
 }
 
 //use RMSD between the ratio vector and a vector of 1's
-double GraphletNorm::RMS_ODVdiff1(vector<uint> &u, vector<uint> &v){
+double GraphletNorm::RMS_ODVdiff1(const vector<uint> &u, const vector<uint> &v) const {
     vector<double> nU = NODV(u);
     vector<double> nV = NODV(v);
     double sum2 = 0;
@@ -52,11 +52,11 @@ double GraphletNorm::RMS_ODVdiff1(vector<uint> &u, vector<uint> &v){
     return sqrt(sum2/v.size());
 }
 
-double GraphletNorm::ODVsim(vector<uint> &u, vector<uint> &v){
+double GraphletNorm::ODVsim(const vector<uint> &u, const vector<uint> &v) const {
     return 1 - RMS_ODVdiff1(u, v);
 }
 
-vector<uint> GraphletNorm::reduce(vector<uint> &v) {
+vector<uint> GraphletNorm::reduce(const vector<uint> &v) const {
     vector<uint> res(11);
     res[0] = v[0];
     res[1] = v[1];
@@ -73,22 +73,41 @@ vector<uint> GraphletNorm::reduce(vector<uint> &v) {
 }
 
 void GraphletNorm::initSimMatrix() {
-    uint n1 = G1->getNumNodes();
-    uint n2 = G2->getNumNodes();
-    sims = vector<vector<float>> (n1, vector<float> (n2, 0));
-    vector<vector<uint>> gdvs1 = ComputeGraphletsWrapper::loadGraphletDegreeVectors(*G1, maxGraphletSize);
-    vector<vector<uint>> gdvs2 = ComputeGraphletsWrapper::loadGraphletDegreeVectors(*G2, maxGraphletSize);
+    initSimMatrixByRows();
+}
 
+bool GraphletNorm::initSimRows() {
+    gdvs1 = ComputeGraphletsWrapper::loadGraphletDegreeVectors(*G1, maxGraphletSize);
+    gdvs2 = ComputeGraphletsWrapper::loadGraphletDegreeVectors(*G2, maxGraphletSize);
+    return true;
+}
+
+void GraphletNorm::simRow(uint i, float* row) const {
+    uint n2 = G2->getNumNodes();
     bool shouldReduce = false;
-    for (uint i = 0; i < n1; i++) {
-        for (uint j = 0; j < n2; j++) {
-            if (shouldReduce) {
-                vector<uint> v1 = reduce(gdvs1[i]);
-                vector<uint> v2 = reduce(gdvs2[j]);
-                sims[i][j] = ODVsim(v1, v2);
-            } else {
-                sims[i][j] = ODVsim(gdvs1[i], gdvs2[j]);
-            }
+    for (uint j = 0; j < n2; j++) {
+        if (shouldReduce) {
+            vector<uint> v1 = reduce(gdvs1[i]);
+            vector<uint> v2 = reduce(gdvs2[j]);
+            row[j] = ODVsim(v1, v2);
+        } else {
+            row[j] = ODVsim(gdvs1[i], gdvs2[j]);
         }
     }
 }
+
+//ODVsim(u, v) is the ratioRMS of NODV(u) and NODV(v) (the GDVs are not reduced in initSimMatrix either)
+void GraphletNorm::initImplicitSims() {
+    vector<vector<uint>> gdvs1 = ComputeGraphletsWrapper::loadGraphletDegreeVectors(*G1, maxGraphletSize);
+    vector<vector<uint>> gdvs2 = ComputeGraphletsWrapper::loadGraphletDegreeVectors(*G2, maxGraphletSize);
+    vector<double> features1, features2;
+    for (vector<uint>& gdv : gdvs1) {
+        vector<double> nodv = NODV(gdv);
+        features1.insert(features1.end(), nodv.begin(), nodv.end());
+    }
+    for (vector<uint>& gdv : gdvs2) {
+        vector<double> nodv = NODV(gdv);
+        features2.insert(features2.end(), nodv.begin(), nodv.end());
+    }
+    implicitSims = ImplicitSims::ratioRMS(gdvs1[0].size(), features1, features2);
+}
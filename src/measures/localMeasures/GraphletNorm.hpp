@@ -10,13 +10,17 @@ public:
 private:
     uint maxGraphletSize;
     void initSimMatrix();
-    double magnitude(vector<uint> &vector);
+    bool initSimRows();
+    void simRow(uint i, float* row) const;
+    vector<vector<uint>> gdvs1, gdvs2;
+    void initImplicitSims();
+    double magnitude(const vector<uint> &vector) const;
     const uint NUM_ORBITS = 73;
-    vector<double> NODV(vector<uint> &v);
-    double ODVratio(vector<double> &u, vector<double> &v, uint i);
-    double RMS_ODVdiff1(vector<uint> &u, vector<uint> &v);
-    double ODVsim(vector<uint> &u, vector<uint> &v);
-    vector<uint> reduce(vector<uint> &v);
+    vector<double> NODV(const vector<uint> &v) const;
+    double ODVratio(const vector<double> &u, const vector<double> &v, uint i) const;
+    double RMS_ODVdiff1(const vector<uint> &u, const vector<uint> &v) const;
+    double ODVsim(const vector<uint> &u, const vector<uint> &v) const;
+    vector<uint> reduce(const vector<uint> &v) const;
     
 };
 
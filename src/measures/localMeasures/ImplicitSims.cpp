@@ -0,0 +1,45 @@
+#include "ImplicitSims.hpp"
+#include <stdexcept>
+
+using namespace std;
+
+ImplicitSims::ImplicitSims(): kind(WEIGHTED_RATIO), rows(0), cols(0), dim(0), bothZero(0) {}
+
+ImplicitSims::ImplicitSims(Kind kind, uint dim, const vector<double>& features1, const vector<double>& features2):
+        kind(kind), rows(0), cols(0), dim(dim), features1(features1), features2(features2), bothZero(0) {
+    if (dim == 0 or features1.size() % dim != 0 or features2.size() % dim != 0)
+        throw runtime_error("ImplicitSims: the sizes of the feature vectors do not match");
+    rows = features1.size() / dim;
+    cols = features2.size() / dim;
+}
+
+ImplicitSims ImplicitSims::weightedRatio(const vector<double>& features1, const vector<double>& features2,
+        const vector<double>& weights, double bothZero) {
+    uint dim = weights.size();
+    if (dim == 0) throw runtime_error("ImplicitSims: there are no features");
+    vector<uint> kept;
+    for (uint h = 0; h < dim; h++) {
+        if (weights[h] > 0) kept.push_back(h);
+    }
+    if (kept.empty()) throw runtime_error("ImplicitSims: all the weights are 0");
+    auto keep = [&](const vector<double>& features) {
+        vector<double> res;
+        res.reserve(features.size() / dim * kept.size());
+        for (size_t first = 0; first + dim <= features.size(); first += dim) {
+            for (uint h : kept) res.push_back(features[first+h]);
+        }
+        return res;
+    };
+    ImplicitSims res(WEIGHTED_RATIO, kept.size(), keep(features1), keep(features2));
+    for (uint h : kept) res.weights.push_back(weights[h]);
+    res.bothZero = bothZero;
+    return res;
+}
+
+ImplicitSims ImplicitSims::ratioRMS(uint dim, const vector<double>& features1, const vector<double>& features2) {
+    return ImplicitSims(RATIO_RMS, dim, features1, features2);
+}
+
+void ImplicitSims::getRow(uint i, float* out) const {
+    for (uint j = 0; j < cols; j++) out[j] = get(i, j);
+}
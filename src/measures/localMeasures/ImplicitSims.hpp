@@ -0,0 +1,66 @@
+#ifndef IMPLICITSIMS_HPP_
+#define IMPLICITSIMS_HPP_
+
+#include <vector>
+#include <cmath>
+#include <algorithm>
+
+using namespace std;
+
+/* Similarity matrix that is not stored: sim(i, j) is computed when it is read from a feature vector
+of node i of G1 and one of node j of G2, of the same dimension d. It takes 8*d bytes per node instead
+of 4 bytes per pair of nodes, and it is built in O(n1+n2) time, so it suits the measures whose sims
+are a cheap function of a few numbers per node (e.g., ratios of densities). Two functions are supported:
+ - weightedRatio: the sum over h of weights[h] * ratio(f1[h], f2[h]), with ratio(a, b) = min(a, b)/max(a, b)
+ - ratioRMS: 1 minus the root mean square of ratio(f1[h], f2[h]) - 1, with ratio(a, b) = 1 if a = b
+The entries are computed with the same operations as the dense matrices of the measures that use them,
+so they are equal to the entries of those matrices */
+class ImplicitSims {
+public:
+    ImplicitSims();
+    /* features1 and features2 hold the feature vectors of the nodes one after the other,
+    with weights.size() features each. Features with weight 0 are dropped. The sum is accumulated
+    in a float, and bothZero is the ratio when both features are 0 */
+    static ImplicitSims weightedRatio(const vector<double>& features1, const vector<double>& features2,
+                                      const vector<double>& weights, double bothZero);
+    //features1 and features2 as above, with dim features each
+    static ImplicitSims ratioRMS(uint dim, const vector<double>& features1, const vector<double>& features2);
+
+    float get(uint i, uint j) const {
+        const double* f1 = &features1[(size_t) i * dim];
+        const double* f2 = &features2[(size_t) j * dim];
+        if (kind == WEIGHTED_RATIO) {
+            float res = 0;
+            for (uint h = 0; h < dim; h++) {
+                double ratio = f1[h] == 0 and f2[h] == 0 ? bothZero : (f1[h] < f2[h] ? f1[h]/f2[h] : f2[h]/f1[h]);
+                res += ratio * weights[h];
+            }
+            return res;
+        }
+        double sum2 = 0;
+        for (uint h = 0; h < dim; h++) {
+            double ratio = f1[h] == f2[h] ? 1 : min(f1[h], f2[h]) / max(f1[h], f2[h]);
+            sum2 += (ratio - 1) * (ratio - 1);
+        }
+        return 1 - sqrt(sum2/dim);
+    }
+    //writes the numCols() entries of row i in out
+    void getRow(uint i, float* out) const;
+
+    uint numRows() const { return rows; }
+    uint numCols() const { return cols; }
+    uint numFeatures() const { return dim; }
+    bool empty() const { return rows == 0; }
+
+private:
+    enum Kind { WEIGHTED_RATIO, RATIO_RMS };
+    ImplicitSims(Kind kind, uint dim, const vector<double>& features1, const vector<double>& features2);
+
+    Kind kind;
+    uint rows, cols, dim;
+    vector<double> features1, features2;
+    vector<double> weights; //WEIGHTED_RATIO
+    double bothZero;
+};
+
+#endif /* IMPLICITSIMS_HPP_ */
@@ -4,17 +4,20 @@
 #include <cmath>
 #include <algorithm>
 #include "../../utils/FileIO.hpp"
+#include "../../utils/randomSeed.hpp"
 
 using namespace std;
 
 const uint Importance::DEG = 10;
 const double Importance::LAMBDA = 0.2; // best value according to the HubAlign paper.
+const uint Importance::NUM_SHUFFLES = 30;
 
 Importance::Importance(const Graph* G1, const Graph* G2) : LocalMeasure(G1, G2, "importance") {
     string subfolder = autogenMatricesFolder+getName()+"/";
     FileIO::createFolder(subfolder);
     string fileName = subfolder+G1->getName()+"_"+G2->getName()+"_importance.bin";
-    loadBinSimMatrix(fileName);
+    //the sims are averaged over random shuffles, so they depend on the seed
+    loadBinSimMatrix(fileName, "seed="+to_string(getRandomSeed())+" shuffles="+to_string(NUM_SHUFFLES));
 }
 Importance::~Importance() {}
 
@@ -157,9 +160,8 @@ vector<double> Importance::getImportances(const Graph& G) {
 
 void Importance::initSimMatrix() {
     uint n1 = G1->getNumNodes(), n2 = G2->getNumNodes();
-    sims = vector<vector<float>> (n1, vector<float> (n2, 0));
+    sims = Matrix<float> (n1, n2);
 
-    const uint NUM_SHUFFLES = 30;
     cout << "Creating average importances from " << NUM_SHUFFLES << " shuffles of the nodes of G1 and G2\n";
     for(uint shuf = 0 ; shuf < NUM_SHUFFLES; shuf++) {
         vector<uint> H1ToG1Map, H2ToG2Map;
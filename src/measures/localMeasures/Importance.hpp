@@ -20,6 +20,9 @@ private:
     yields a biologically more meaningful alignment */
     static const double LAMBDA;
 
+    //number of random shuffles of the nodes of G1 and G2 whose importances are averaged
+    static const uint NUM_SHUFFLES;
+
     void initSimMatrix();
 
     static vector<double> getImportances(const Graph& G);
@@ -2,11 +2,15 @@
 #include <vector>
 #include <iostream>
 #include "../../utils/FileIO.hpp"
+#include "../../utils/Profiler.hpp"
+#include "SimMatrixCache.hpp"
 
 using namespace std;
 
-//is this folder actually ever used? -Nil
 const string LocalMeasure::autogenMatricesFolder = "autogenerated/matrices/";
+uint LocalMeasure::topK = 0;
+SimPrecision LocalMeasure::precision = SimPrecision::FP32;
+bool LocalMeasure::implicit = false;
 
 LocalMeasure::LocalMeasure(const Graph* G1, const Graph* G2, const string& name) : Measure(G1, G2, name) {
     FileIO::createFolder(autogenMatricesFolder);
@@ -18,6 +22,18 @@ LocalMeasure::~LocalMeasure() {
 double LocalMeasure::eval(const Alignment& A) {
     uint n = G1->getNumNodes();
     double similaritySum = 0;
+    if (not implicitSims.empty()) {
+        for (uint i = 0; i < n; i++) similaritySum += implicitSims.get(i, A[i]);
+        return similaritySum/n;
+    }
+    if (not topSims.empty()) {
+        for (uint i = 0; i < n; i++) similaritySum += topSims.get(i, A[i]);
+        return similaritySum/n;
+    }
+    if (not quantizedSims.empty()) {
+        for (uint i = 0; i < n; i++) similaritySum += quantizedSims.get(i, A[i]);
+        return similaritySum/n;
+    }
     for (uint i = 0; i < n; i++) {
         similaritySum += sims[i][A[i]];
     }
@@ -28,23 +44,120 @@ bool LocalMeasure::isLocal() {
     return true;
 }
 
-vector<vector<float>>* LocalMeasure::getSimMatrix() {
+Matrix<float>* LocalMeasure::getSimMatrix() {
+    if (sims.empty() and not implicitSims.empty()) {
+        sims = Matrix<float>(implicitSims.numRows(), implicitSims.numCols());
+        for (uint i = 0; i < sims.numRows(); i++) implicitSims.getRow(i, sims[i].data());
+    }
+    if (sims.empty() and not quantizedSims.empty()) {
+        sims = Matrix<float>(quantizedSims.numRows(), quantizedSims.numCols());
+        for (uint i = 0; i < sims.numRows(); i++) quantizedSims.dequantizeRow(i, sims[i].data());
+    }
+    if (sims.empty() and not topSims.empty()) {
+        sims = Matrix<float>(topSims.numRows(), topSims.numCols());
+        for (uint i = 0; i < sims.numRows(); i++) topSims.getRow(i, sims[i].data());
+    }
     return &sims;
 }
 
-void LocalMeasure::loadBinSimMatrix(string simMatrixFileName) {
-    cout << "Computing " << simMatrixFileName << " ... ";
+void LocalMeasure::getSimRow(uint i, float* out) const {
+    if (not implicitSims.empty()) implicitSims.getRow(i, out);
+    else if (not quantizedSims.empty()) quantizedSims.dequantizeRow(i, out);
+    else if (sims.empty()) topSims.getRow(i, out);
+    else copy(sims[i].begin(), sims[i].end(), out);
+}
+
+void LocalMeasure::setTopK(uint k) { topK = k; }
+uint LocalMeasure::getTopK() { return topK; }
+
+const TopKSimMatrix* LocalMeasure::getTopSims() const {
+    return topSims.empty() ? nullptr : &topSims;
+}
+
+void LocalMeasure::getExactSimRow(uint i, float* out) const {
+    if (hasSimRows) simRow(i, out);
+    else if (not sims.empty()) copy(sims[i].begin(), sims[i].end(), out);
+    else getSimRow(i, out);
+}
+
+void LocalMeasure::releaseDenseSims() {
+    if (topK > 0) sims = Matrix<float>();
+}
+
+void LocalMeasure::setPrecision(SimPrecision precision) { LocalMeasure::precision = precision; }
+SimPrecision LocalMeasure::getPrecision() { return precision; }
+
+const QuantizedMatrix* LocalMeasure::getQuantizedSims() const {
+    return quantizedSims.empty() ? nullptr : &quantizedSims;
+}
+
+void LocalMeasure::setImplicit(bool implicit) { LocalMeasure::implicit = implicit; }
+bool LocalMeasure::isImplicit() { return implicit; }
+
+const ImplicitSims* LocalMeasure::getImplicitSims() const {
+    return implicitSims.empty() ? nullptr : &implicitSims;
+}
+
+void LocalMeasure::loadBinSimMatrix(string simMatrixFileName, const string& parameters) {
     Timer T;
     T.start();
-    initSimMatrix();
-    cout << "Loading binary sim matrix done (" << T.elapsedString() << ")" << endl;
+    paramsHash = hashString(parameters, hashString(getName()+" "+simMatrixFileName));
+    if (implicit) {
+        initImplicitSims();
+        if (not implicitSims.empty()) {
+            cout << "Node features of " << getName() << " for implicit sims (" << implicitSims.numFeatures()
+                 << " per node) done (" << T.elapsedString() << ")" << endl;
+            return;
+        }
+    }
+    if (topK > 0) {
+        Profiler::ScopedPhase phase("initSimMatrix ("+getName()+")");
+        hasSimRows = initSimRows();
+        if (hasSimRows) {
+            uint n1 = G1->getNumNodes(), n2 = G2->getNumNodes();
+            auto row = [this] (uint i, vector<float>& values) { simRow(i, values.data()); };
+            topSims = TopKSimMatrix(n1, n2, topK, row);
+            if (precision != SimPrecision::FP32) quantizedSims = QuantizedMatrix(n1, n2, precision, row);
+            cout << "Computing the top " << topK << " sims of " << getName() << " row by row done ("
+                 << T.elapsedString() << ")" << endl;
+            return;
+        }
+    }
+    if (SimMatrixCache::load(simMatrixFileName, *G1, *G2, paramsHash, sims)) {
+        cout << "Loading binary sim matrix " << simMatrixFileName << " done (" << T.elapsedString() << ")" << endl;
+    } else {
+        cout << "Computing " << simMatrixFileName << " ... ";
+        Profiler::ScopedPhase phase("initSimMatrix ("+getName()+")");
+        initSimMatrix();
+        phase.stop();
+        SimMatrixCache::save(simMatrixFileName, *G1, *G2, paramsHash, sims);
+        cout << "done (" << T.elapsedString() << ")" << endl;
+        //replace the computed matrix by the mapped file, whose pages can be evicted
+        if (topK > 0) SimMatrixCache::load(simMatrixFileName, *G1, *G2, paramsHash, sims);
+    }
+    if (topK > 0) {
+        T.start();
+        topSims = TopKSimMatrix(sims, topK);
+        cout << "Selecting the top " << topK << " sims of " << getName() << " done (" << T.elapsedString() << ")" << endl;
+    }
+    if (precision != SimPrecision::FP32) {
+        quantizedSims = QuantizedMatrix(sims, precision);
+        //in top-k mode, the dense matrix is kept for getExactSimRow until releaseDenseSims
+        if (topK == 0) sims = Matrix<float>();
+    }
+}
+
+void LocalMeasure::initSimMatrixByRows() {
+    initSimRows();
+    sims = Matrix<float>(G1->getNumNodes(), G2->getNumNodes());
+    for (uint i = 0; i < sims.numRows(); i++) simRow(i, sims[i].data());
 }
 
 void LocalMeasure::writeSimsWithNames(string outfile) {
     ofstream fout(outfile);
     for (uint i = 0; i < G1->getNumNodes(); i++) {
         for (uint j = 0; j < G2->getNumNodes(); j++) {
-            fout << G1->getNodeName(i) << " " << G2->getNodeName(j) << " " << sims[i][j] << endl;
+            fout << G1->getNodeName(i) << " " << G2->getNodeName(j) << " " << getSim(i, j) << endl;
         }
     }
 }
@@ -53,9 +166,12 @@ void LocalMeasure::writeSimsWithNames(string outfile) {
 double LocalMeasure::balanceWeight(){
     double totalSim = 0;
     uint simNumber = 0;
-    for(uint i = 0; i < sims.size(); i++){
-        for(uint j = 0; j < sims[i].size(); j++){
-            totalSim += sims[i][j];
+    uint n1 = G1->getNumNodes(), n2 = G2->getNumNodes();
+    vector<float> row(n2);
+    for(uint i = 0; i < n1; i++){
+        getSimRow(i, row.data());
+        for(uint j = 0; j < n2; j++){
+            totalSim += row[j];
             simNumber++;
         }
     }
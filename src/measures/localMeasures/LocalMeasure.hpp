@@ -1,6 +1,9 @@
 #ifndef LOCALMEASURE_HPP
 #define LOCALMEASURE_HPP
 #include "../Measure.hpp"
+#include "../../utils/TopKSimMatrix.hpp"
+#include "../../utils/QuantizedMatrix.hpp"
+#include "ImplicitSims.hpp"
 
 class LocalMeasure: public Measure {
 public:
@@ -8,15 +11,82 @@ public:
     virtual ~LocalMeasure() =0;
     virtual double eval(const Alignment& A);
     bool isLocal();
-    vector<vector<float>>* getSimMatrix();
+    //in reduced precision (see setPrecision) or with implicit sims (see setImplicit), the first call builds
+    //the fp32 matrix, so code that only reads some entries or rows should use getSim and getSimRow instead
+    Matrix<float>* getSimMatrix();
+    float getSim(uint i, uint j) const {
+        if (not implicitSims.empty()) return implicitSims.get(i, j);
+        if (not quantizedSims.empty()) return quantizedSims.get(i, j);
+        return sims.empty() ? topSims.get(i, j) : sims[i][j];
+    }
+    //writes row i of the sims in out, which should have space for the nodes of G2
+    void getSimRow(uint i, float* out) const;
     void writeSimsWithNames(string outfile);
     double balanceWeight();
 
+    /* With k > 0 (-simtopk), each measure also keeps a TopKSimMatrix of its sims with the k most
+    similar nodes of G2 for each node of G1, which is used by eval and by SANA instead of the dense
+    matrix. The measures whose rows can be computed one at a time (see initSimMatrixByRows) build
+    it from their rows, without the dense matrix or its cache file. The others still compute
+    the dense matrix (or map it from the cache), and keep it until releaseDenseSims is called.
+    Then getSim, getSimRow and getSimMatrix return the top-k approximation. 0 (the default) means dense */
+    static void setTopK(uint k);
+    static uint getTopK();
+    //nullptr if the measure has no top-k matrix
+    const TopKSimMatrix* getTopSims() const;
+    //in top-k mode, writes row i of the sims before the top k are selected, as long as
+    //releaseDenseSims has not been called (the aggregated top-k matrix is built from these rows)
+    void getExactSimRow(uint i, float* out) const;
+    //in top-k mode, frees the dense matrix, if any. Does nothing otherwise
+    void releaseDenseSims();
+
+    /* With -simPrecision fp16 or u8, once the sims are loaded (and their top k selected, in top-k mode),
+    they are replaced by a QuantizedMatrix, which takes 2 or 4 times less memory. The cache files
+    are always in fp32, so the precision can be changed without computing them again */
+    static void setPrecision(SimPrecision precision);
+    static SimPrecision getPrecision();
+    //nullptr if the sims are in fp32
+    const QuantizedMatrix* getQuantizedSims() const;
+
+    /* With -implicitsims, the measures whose sims are a cheap function of a few numbers per node
+    (nodec, edgec, noded, edged and graphletnorm) keep only those numbers in an ImplicitSims, and
+    the sims are computed when they are read. No matrix is computed or loaded for them, and
+    -simtopk and -simPrecision do not apply to them. The other measures are not affected */
+    static void setImplicit(bool implicit);
+    static bool isImplicit();
+    //nullptr if the measure has a matrix
+    const ImplicitSims* getImplicitSims() const;
+
+    //hash of everything the sims depend on besides the graphs (see loadBinSimMatrix),
+    //or 0 if the measure does not use loadBinSimMatrix
+    uint64_t getParamsHash() const { return paramsHash; }
+
 protected:
-    void loadBinSimMatrix(string simMatrixFileName);
+    /* Loads sims from the cache file simMatrixFileName if it is valid (see SimMatrixCache),
+    or else computes it with initSimMatrix and saves it there. parameters should include everything
+    that the matrix depends on besides the graphs and the file name (e.g., the input files, see
+    SimMatrixCache::fileStamp), so that a file computed with other parameters is not used */
+    void loadBinSimMatrix(string simMatrixFileName, const string& parameters = "");
     virtual void initSimMatrix() =0;
+    /* The measures whose rows can be computed independently of each other override initSimRows
+    to compute what the rows depend on (e.g., the graphlet degree vectors of the nodes) and return true,
+    and simRow to write row i in row, which has space for the nodes of G2. Their initSimMatrix is
+    initSimMatrixByRows, so the dense matrix and the rows of top-k mode have the same values */
+    virtual bool initSimRows() { return false; }
+    virtual void simRow(uint i, float* row) const {}
+    void initSimMatrixByRows();
+    //the measures that support implicit sims override it to set implicitSims from the features of the nodes
+    virtual void initImplicitSims() {}
     
-    vector<vector<float>> sims;
+    Matrix<float> sims;
+    TopKSimMatrix topSims;
+    QuantizedMatrix quantizedSims;
+    ImplicitSims implicitSims;
+    uint64_t paramsHash = 0;
+    bool hasSimRows = false; //whether initSimRows returned true
+    static uint topK;
+    static SimPrecision precision;
+    static bool implicit;
     static const string autogenMatricesFolder;
 };
 
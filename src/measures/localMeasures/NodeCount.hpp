@@ -10,6 +10,12 @@ private:
     vector<double> distWeights;
     
     void initSimMatrix();
+    bool initSimRows();
+    void simRow(uint i, float* row) const;
+    vector<vector<uint>> densities1, densities2;
+    void initImplicitSims();
+    //for each node, the number of nodes within distance 1, 2, ..., distWeights.size()
+    vector<vector<uint>> cumulativeCounts(const Graph* G) const;
 };
 
 #endif
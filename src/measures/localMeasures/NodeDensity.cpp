@@ -11,7 +11,7 @@ NodeDensity::NodeDensity(const Graph* G1, const Graph* G2, uint maxDist) : Local
     FileIO::createFolder(subfolder);
     string fileName = subfolder+G1->getName()+"_"+G2->getName()+"_noded.bin";
     this->maxDist = maxDist;
-    loadBinSimMatrix(fileName);
+    loadBinSimMatrix(fileName, "maxDist="+to_string(maxDist));
 }
 NodeDensity::~NodeDensity() {}
 
@@ -47,22 +47,30 @@ vector<double> NodeDensity::generateVector(const Graph* G, uint maxDist) const {
     return noded;
 }
 
-float NodeDensity::compare(double n1, double n2) {
+float NodeDensity::compare(double n1, double n2) const {
     if(n1 == 0 && n2 == 0) return 1.0;
     if (n1 > n2) return (n2 / n1);
     return (n1 / n2);
 }
 
 void NodeDensity::initSimMatrix() {
+    initSimMatrixByRows();
+}
+
+bool NodeDensity::initSimRows() {
     noded1 = generateVector(G1, maxDist);
     noded2 = generateVector(G2, maxDist);
-    uint size1 = noded1.size();
-    uint size2 = noded2.size();
+    return true;
+}
 
-    sims = vector<vector<float>> (size1, vector<float> (size2, 0));
-    for(uint i = 0; i < size1;  ++i) {
-        for(uint j = 0; j < size2;  ++j) {
-            sims[i][j] = compare(noded1[i], noded2[j]);
-        }
+void NodeDensity::simRow(uint i, float* row) const {
+    uint size2 = noded2.size();
+    for(uint j = 0; j < size2;  ++j) {
+        row[j] = compare(noded1[i], noded2[j]);
     }
 }
+
+void NodeDensity::initImplicitSims() {
+    //compare() is the ratio of the densities, and 1 if both are 0
+    implicitSims = ImplicitSims::weightedRatio(generateVector(G1, maxDist), generateVector(G2, maxDist), {1}, 1);
+}
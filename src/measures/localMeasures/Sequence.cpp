@@ -6,6 +6,7 @@
 #include <iostream>
 #include <cassert>
 #include "../../utils/FileIO.hpp"
+#include "SimMatrixCache.hpp"
 
 using namespace std;
 
@@ -13,7 +14,10 @@ Sequence::Sequence(const Graph* G1, const Graph* G2) : LocalMeasure(G1, G2, "seq
     string subfolder = autogenMatricesFolder+getName()+"/";
     FileIO::createFolder(subfolder);
     string fileName = subfolder+G1->getName()+"_"+G2->getName()+"_sequence.bin";
-    loadBinSimMatrix(fileName);
+    //the input files read by initSimMatrix
+    string g1Name = G1->getName(), g2Name = G2->getName();
+    loadBinSimMatrix(fileName, SimMatrixCache::fileStamp("sequence/scores/"+g1Name+"_"+g2Name+"_blast.out")+" "+
+        SimMatrixCache::fileStamp("sequence/"+g1Name+".fasta")+" "+SimMatrixCache::fileStamp("sequence/"+g2Name+".fasta"));
 }
 
 void Sequence::generateBitscoresFile(string bitscoresFile) {
@@ -66,7 +70,7 @@ void Sequence::initSimMatrix() {
 
     uint n1 = G1->getNumNodes();
     uint n2 = G2->getNumNodes();
-    sims = vector<vector<float>> (n1, vector<float> (n2, 0));
+    sims = Matrix<float> (n1, n2);
 
     string blastFile = "sequence/scores/"+g1Name+"_"+g2Name+"_blast.out";
     if (not FileIO::fileExists(blastFile)) {
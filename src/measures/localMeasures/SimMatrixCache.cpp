@@ -0,0 +1,83 @@
+#include "SimMatrixCache.hpp"
+#include <fstream>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+using namespace std;
+
+static_assert(sizeof(float) == 4, "the cache files store 32-bit floats");
+
+//increase it when the format or the computation of any measure changes, to invalidate old files
+const uint32_t SimMatrixCache::VERSION = 1;
+const uint32_t SimMatrixCache::DTYPE_FLOAT32 = 0;
+bool SimMatrixCache::enabled = true;
+
+static const char MAGIC[8] = {'S','A','N','A','S','I','M','\0'};
+
+void SimMatrixCache::setEnabled(bool enabled) { SimMatrixCache::enabled = enabled; }
+bool SimMatrixCache::isEnabled() { return enabled; }
+
+SimMatrixCache::Header SimMatrixCache::expectedHeader(const Graph& G1, const Graph& G2, uint64_t paramsHash) {
+    static_assert(sizeof(Header) == 64, "the header should take exactly 64 bytes");
+    Header header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.dtype = DTYPE_FLOAT32;
+    header.n1 = G1.getNumNodes();
+    header.n2 = G2.getNumNodes();
+    header.rowStride = Matrix<float>::strideFor(header.n2);
+    header.paramsHash = paramsHash;
+    header.g1Hash = G1.contentHash();
+    header.g2Hash = G2.contentHash();
+    return header;
+}
+
+bool SimMatrixCache::load(const string& fileName, const Graph& G1, const Graph& G2,
+        uint64_t paramsHash, Matrix<float>& sims) {
+    if (not enabled) return false;
+    int fd = open(fileName.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+    Header expected = expectedHeader(G1, G2, paramsHash), header;
+    size_t dataBytes = (size_t) expected.n1 * expected.rowStride * sizeof(float);
+    struct stat fileInfo;
+    bool valid = fstat(fd, &fileInfo) == 0 and (size_t) fileInfo.st_size == sizeof(Header) + dataBytes
+                 and pread(fd, &header, sizeof(header), 0) == sizeof(header)
+                 and memcmp(&header, &expected, sizeof(header)) == 0;
+    void* addr = MAP_FAILED;
+    //private and writable: writes to the matrix create private copies of the pages
+    if (valid) addr = mmap(nullptr, sizeof(Header) + dataBytes, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (addr == MAP_FAILED) return false;
+
+    size_t mappedBytes = sizeof(Header) + dataBytes;
+    shared_ptr<void> keeper(addr, [mappedBytes](void* p) { munmap(p, mappedBytes); });
+    float* elements = (float*) ((char*) addr + sizeof(Header));
+    sims = Matrix<float>(expected.n1, expected.n2, elements, keeper);
+    return true;
+}
+
+void SimMatrixCache::save(const string& fileName, const Graph& G1, const Graph& G2,
+        uint64_t paramsHash, const Matrix<float>& sims) {
+    if (not enabled) return;
+    Header header = expectedHeader(G1, G2, paramsHash);
+    if (sims.numRows() != header.n1 or sims.numCols() != header.n2 or sims.rowStride() != header.rowStride)
+        return;
+    //written under a temporary name and renamed, in case another SANA process is reading it
+    string tmpFileName = fileName+".tmp"+to_string(getpid());
+    ofstream ofs(tmpFileName, ios::binary);
+    ofs.write((const char*) &header, sizeof(header));
+    ofs.write((const char*) sims.rawData(), (size_t) header.n1 * header.rowStride * sizeof(float));
+    ofs.close();
+    if (not ofs or rename(tmpFileName.c_str(), fileName.c_str()) != 0) remove(tmpFileName.c_str());
+}
+
+string SimMatrixCache::fileStamp(const string& file) {
+    struct stat fileInfo;
+    if (stat(file.c_str(), &fileInfo) != 0) return file+":missing";
+    return file+":"+to_string(fileInfo.st_size)+":"+to_string(fileInfo.st_mtime);
+}
@@ -0,0 +1,56 @@
+#ifndef SIMMATRIXCACHE_HPP
+#define SIMMATRIXCACHE_HPP
+
+#include <string>
+#include <cstdint>
+#include "../../Graph.hpp"
+#include "../../utils/Matrix.hpp"
+
+using namespace std;
+
+/* Persistent cache of the similarity matrices of the local measures, in autogenerated/matrices/.
+Each file has a 64-byte header (see Header) followed by the rows of the matrix exactly as they are
+stored in a Matrix<float>, including the padding at the end of each row. A cached matrix is not read
+but memory-mapped, and used in place: concurrent SANA processes aligning the same networks share a
+single copy of it in the page cache, and a process only loads the pages it reads. The mapping is
+private, so a process that modifies its matrix gets its own copy of the modified pages, without
+affecting the file or the other processes.
+A file is only used if its header matches the format version, the element type, the dimensions,
+the hash of the parameters of the measure, and the content hashes of both graphs. Otherwise
+the matrix is computed again and the file is replaced */
+class SimMatrixCache {
+public:
+    //returns false if the file does not exist or does not match (in which case sims is not modified)
+    static bool load(const string& fileName, const Graph& G1, const Graph& G2,
+                     uint64_t paramsHash, Matrix<float>& sims);
+    //errors (e.g., no space left) are ignored: the matrix will be computed again next time
+    static void save(const string& fileName, const Graph& G1, const Graph& G2,
+                     uint64_t paramsHash, const Matrix<float>& sims);
+
+    //identifies the current version of an input file of a measure (its path, size and modification
+    //time), to be included in the parameters of the measures whose matrix depends on it
+    static string fileStamp(const string& file);
+
+    //disabled with -nosimcache
+    static void setEnabled(bool enabled);
+    static bool isEnabled();
+
+private:
+    struct Header {
+        char magic[8];
+        uint32_t version;
+        uint32_t dtype;
+        uint32_t n1, n2;
+        uint64_t rowStride; //elements per row, including the padding
+        uint64_t paramsHash;
+        uint64_t g1Hash, g2Hash;
+        char padding[8];
+    };
+    static Header expectedHeader(const Graph& G1, const Graph& G2, uint64_t paramsHash);
+
+    static const uint32_t VERSION;
+    static const uint32_t DTYPE_FLOAT32;
+    static bool enabled;
+};
+
+#endif
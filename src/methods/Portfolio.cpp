@@ -0,0 +1,80 @@
+#include <iostream>
+#include <stdexcept>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include "Portfolio.hpp"
+
+using namespace std;
+
+Portfolio::Portfolio(const Graph* G1, const Graph* G2, SANA* sana, uint numChains):
+        Method(G1, G2, sana->getName()+"_portfolio"),
+        numChains(numChains), chains(1, sana) {
+    if (numChains < 2) throw runtime_error("a portfolio needs at least 2 chains");
+}
+
+Portfolio::~Portfolio() {
+    for (SANA* chain : chains) delete chain;
+}
+
+Alignment Portfolio::run() {
+    //for time-limited runs, the ips is measured once here instead of once per chain
+    long long int maxIters = chains[0]->getMaxIterations();
+    //concurrent chains are slower than a single run, so their speed is not cached
+    chains[0]->setUseIpsCache(false);
+
+    for (uint i = 1; i < numChains; i++) {
+        chains.push_back(new SANA(*chains[0]));
+        chains[i]->setRandomStream(i);
+    }
+    for (uint i = 0; i < numChains; i++) {
+        chains[i]->setProgressLabel("[chain "+to_string(i)+"] ");
+        chains[i]->setSnapshotSuffix("_chain"+to_string(i));
+        chains[i]->setExternalControl();
+    }
+    cout << "Running " << numChains << " chains of " << maxIters << " iterations" << endl;
+
+    //the signals and the control file are handled here, once for all the chains
+    SANA::setInterruptSignal();
+    vector<Alignment> results(numChains);
+    vector<thread> threads;
+    mutex doneMutex;
+    condition_variable chainDone;
+    uint numDone = 0;
+    for (uint i = 0; i < numChains; i++)
+        threads.push_back(thread([this, &results, &doneMutex, &chainDone, &numDone, i]() {
+            setRandomThreadIndex(i+1);
+            results[i] = chains[i]->run();
+            lock_guard<mutex> lock(doneMutex);
+            numDone++;
+            chainDone.notify_one();
+        }));
+    unique_lock<mutex> lock(doneMutex);
+    while (numDone < numChains) {
+        lock.unlock();
+        int requests = chains[0]->pollControlRequests();
+        if (requests) for (SANA* chain : chains) chain->addControlRequests(requests);
+        lock.lock();
+        chainDone.wait_for(lock, chrono::milliseconds(100), [&]() { return numDone == numChains; });
+    }
+    lock.unlock();
+    for (thread& t : threads) t.join();
+
+    uint best = 0;
+    for (uint i = 0; i < numChains; i++) {
+        cout << "chain " << i << " final score: " << chains[i]->getCurrentScore() << endl;
+        if (chains[i]->getCurrentScore() > chains[best]->getCurrentScore()) best = i;
+    }
+    cout << "Keeping the alignment of chain " << best << endl;
+    return results[best];
+}
+
+void Portfolio::describeParameters(ostream& sout) const {
+    chains[0]->describeParameters(sout);
+    sout << "Chains: " << numChains << endl;
+}
+
+string Portfolio::fileNameSuffix(const Alignment& A) const {
+    return chains[0]->fileNameSuffix(A);
+}
@@ -0,0 +1,31 @@
+#ifndef PORTFOLIO_HPP
+#define PORTFOLIO_HPP
+#include <vector>
+#include "Method.hpp"
+#include "SANA.hpp"
+
+using namespace std;
+
+/* Runs several independent SANA anneals (chains) in parallel threads and keeps the best alignment.
+The chains are copies of the same SANA object with different seeds, so the graphs and the
+similarity matrices are loaded and built once and shared (read-only) by all of them,
+while each chain has its own alignment and incremental scores.
+This replaces launching several SANA processes with different seeds.
+The signals and the control file are handled by the calling thread, and each request (snapshot or stop)
+is passed on to every chain. */
+class Portfolio: public Method {
+public:
+    //takes ownership of 'sana', which should already have its temperature schedule set
+    Portfolio(const Graph* G1, const Graph* G2, SANA* sana, uint numChains);
+    ~Portfolio();
+
+    Alignment run();
+    void describeParameters(ostream& stream) const;
+    string fileNameSuffix(const Alignment& A) const;
+
+private:
+    uint numChains;
+    vector<SANA*> chains; //chains[0] is the SANA object received in the constructor
+};
+
+#endif /* PORTFOLIO_HPP */
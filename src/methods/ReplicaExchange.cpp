@@ -0,0 +1,126 @@
+#include <iostream>
+#include <iomanip>
+#include <stdexcept>
+#include <cmath>
+#include <thread>
+#include "ReplicaExchange.hpp"
+#include "../utils/Timer.hpp"
+#include "../utils/randomSeed.hpp"
+
+using namespace std;
+
+ReplicaExchange::ReplicaExchange(const Graph* G1, const Graph* G2, SANA* sana, uint numReplicas):
+        Method(G1, G2, sana->getName()+"_replicas"),
+        numReplicas(numReplicas), replicas(1, sana),
+        exchangeAttempts(0), exchangesAccepted(0) {
+    if (numReplicas < 2) throw runtime_error("replica exchange needs at least 2 replicas");
+    initTemperatureLadder(sana->getTInitial(), sana->getTFinal());
+    gen.seed(getRandomSeed(), numReplicas); //streams 0 to numReplicas-1 are used by the replicas
+}
+
+ReplicaExchange::~ReplicaExchange() {
+    for (SANA* replica : replicas) delete replica;
+}
+
+void ReplicaExchange::initTemperatureLadder(double TInitial, double TFinal) {
+    if (TInitial <= 0 or TFinal <= 0 or TFinal > TInitial)
+        throw runtime_error("replica exchange needs 0 < TFinal <= TInitial");
+    temps = vector<double> (numReplicas);
+    for (uint i = 0; i < numReplicas; i++)
+        temps[i] = TInitial * pow(TFinal/TInitial, i/(double) (numReplicas-1));
+}
+
+Alignment ReplicaExchange::run() {
+    //measured before cloning so that the replicas don't have to measure it again
+    long long int maxIters = replicas[0]->getMaxIterations();
+
+    //copies of replicas[0] only share read-only data with it (graphs, measures)
+    for (uint i = 1; i < numReplicas; i++) {
+        replicas.push_back(new SANA(*replicas[0]));
+        replicas[i]->setRandomStream(i);
+    }
+    rungToReplica = vector<uint> (numReplicas);
+    for (uint i = 0; i < numReplicas; i++) {
+        rungToReplica[i] = i;
+        replicas[i]->initFixedTempChain(temps[i]);
+    }
+    bestScore = -1;
+    updateBest();
+
+    cout << "Running " << numReplicas << " replicas with temperatures ";
+    for (double t : temps) cout << t << " ";
+    cout << endl;
+
+    Timer T;
+    T.start();
+    long long int numRounds = (maxIters + ITERATIONS_PER_ROUND - 1) / ITERATIONS_PER_ROUND;
+    for (long long int round = 0; round < numRounds; round++) {
+        long long int roundIters = min(ITERATIONS_PER_ROUND, maxIters - round*ITERATIONS_PER_ROUND);
+        vector<thread> threads;
+        for (uint i = 0; i < numReplicas; i++) {
+            threads.push_back(thread([this, i, roundIters]() {
+                setRandomThreadIndex(i+1);
+                replicas[i]->runFixedTempIterations(roundIters);
+            }));
+        }
+        for (thread& t : threads) t.join();
+
+        updateBest();
+        attemptExchanges(round%2 == 0);
+
+        if ((round+1)%ROUNDS_PER_PROGRESS_REPORT == 0 or round == numRounds-1) {
+            cout << "round " << round+1 << "/" << numRounds << " (" << T.elapsedString() << "):"
+                 << " best " << bestScore << " scores by rung: ";
+            for (uint i = 0; i < numReplicas; i++)
+                cout << replicas[rungToReplica[i]]->getCurrentScore() << " ";
+            cout << "exchange rate: " << exchangesAccepted/(double) exchangeAttempts << endl;
+        }
+    }
+    cout << "Performed " << maxIters << " iterations in each of " << numReplicas << " replicas" << endl;
+    for (SANA* replica : replicas) replica->addLoopProfileToProfiler();
+
+    //with -add-hill-climbing, the best alignment is improved with the coldest replica
+    SANA* coldest = replicas[rungToReplica[numReplicas-1]];
+    return coldest->hillClimbFrom(Alignment(bestA));
+}
+
+uint ReplicaExchange::attemptExchanges(bool evenRungs) {
+    uint accepted = 0;
+    for (uint i = (evenRungs ? 0 : 1); i+1 < numReplicas; i += 2) {
+        SANA* hot = replicas[rungToReplica[i]];
+        SANA* cold = replicas[rungToReplica[i+1]];
+        //SANA maximizes the score, so the stationary distribution at temperature T is
+        //proportional to exp(score/T). This is the ratio of the probabilities after/before the exchange
+        double exponent = (hot->getCurrentScore() - cold->getCurrentScore()) * (1/temps[i+1] - 1/temps[i]);
+        exchangeAttempts++;
+        if (exponent >= 0 or gen.real01() < exp(exponent)) {
+            swap(rungToReplica[i], rungToReplica[i+1]);
+            replicas[rungToReplica[i]]->setTemperature(temps[i]);
+            replicas[rungToReplica[i+1]]->setTemperature(temps[i+1]);
+            accepted++;
+        }
+    }
+    exchangesAccepted += accepted;
+    return accepted;
+}
+
+void ReplicaExchange::updateBest() {
+    for (SANA* replica : replicas) {
+        if (replica->getCurrentScore() > bestScore) {
+            bestScore = replica->getCurrentScore();
+            bestA = replica->getCurrentAlignment();
+        }
+    }
+}
+
+void ReplicaExchange::describeParameters(ostream& sout) const {
+    replicas[0]->describeParameters(sout);
+    sout << "Replicas: " << numReplicas << endl;
+    sout << "Temperature ladder:";
+    for (double t : temps) sout << " " << t;
+    sout << endl;
+}
+
+string ReplicaExchange::fileNameSuffix(const Alignment& A) const {
+    return replicas[0]->fileNameSuffix(A);
+}
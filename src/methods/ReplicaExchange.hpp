@@ -0,0 +1,54 @@
+#ifndef REPLICAEXCHANGE_HPP
+#define REPLICAEXCHANGE_HPP
+#include <vector>
+#include "Method.hpp"
+#include "SANA.hpp"
+
+using namespace std;
+
+/* Parallel tempering (replica exchange) on top of SANA.
+Each replica is a copy of the same SANA object (so it uses the same graphs, measures
+and incremental score evaluation) that iterates at a fixed temperature in its own thread.
+The temperatures form a geometric ladder between SANA's initial and final temperatures.
+The replicas run in rounds of a fixed number of iterations. Between rounds, neighbouring
+replicas exchange their temperatures according to the Metropolis criterion,
+so good alignments found at high temperatures can travel down to the cold end of the ladder.
+Each replica runs the number of iterations that a single SANA run would have done. */
+class ReplicaExchange: public Method {
+public:
+    //takes ownership of 'sana', which should already have its temperature schedule set
+    ReplicaExchange(const Graph* G1, const Graph* G2, SANA* sana, uint numReplicas);
+    ~ReplicaExchange();
+
+    Alignment run();
+    void describeParameters(ostream& stream) const;
+    string fileNameSuffix(const Alignment& A) const;
+
+private:
+    uint numReplicas;
+    vector<SANA*> replicas; //replicas[0] is the SANA object received in the constructor
+
+    //temps[i] is the temperature of the i-th rung of the ladder, from hottest to coldest
+    vector<double> temps;
+    void initTemperatureLadder(double TInitial, double TFinal);
+
+    //rungToReplica[i] is the index of the replica currently at the i-th rung
+    vector<uint> rungToReplica;
+    const long long int ITERATIONS_PER_ROUND = 1000000;
+    const uint ROUNDS_PER_PROGRESS_REPORT = 10;
+
+    //attempts to exchange the temperatures of the replicas at rungs (i, i+1)
+    //for every even i if 'evenRungs' is true, and for every odd i otherwise.
+    //alternating between the two avoids two attempts involving the same replica in the same round
+    //returns the number of accepted exchanges
+    uint attemptExchanges(bool evenRungs);
+    long long int exchangeAttempts, exchangesAccepted;
+
+    double bestScore;
+    vector<uint> bestA;
+    void updateBest();
+
+    Xoshiro256 gen;
+};
+
+#endif /* REPLICAEXCHANGE_HPP */
@@ -37,13 +37,35 @@
 #include "../measures/EdgeExposure.hpp"
 #include "../measures/MultiS3.hpp"
 #include "../utils/utils.hpp"
+#include "../utils/allocationCounter.hpp"
+#include "../utils/BinaryBuffer.hpp"
+#include "../utils/FileIO.hpp"
+#include "../utils/BackgroundWriter.hpp"
 #include "../Report.hpp"
+#include "../schedulemethods/ScheduleCache.hpp"
 
 using namespace std;
 
 //static fields
-bool SANA::saveAligAndExitOnInterruption = false;
-bool SANA::saveAligAndContOnInterruption = false;
+atomic<int> SANA::controlRequests(0);
+const long long int SANA::HILL_CLIMBING_IDLE_ITERATIONS = 10000000LL; //arbitrarily chosen, probably too big.
+
+//in the same order as the DeltaFunction enum
+const char* SANA::DELTA_FUNCTION_NAMES[SANA::NUM_DELTA_FUNCTIONS] = {
+    "neighborhoodIncChangeOp (EC, WEC, EWEC, JS)",
+    "squaredAligEdgesIncChangeOp",
+    "exposedEdgesIncChangeOp",
+    "MS3IncChangeOp",
+    "inducedEdgesIncChangeOp",
+    "localScoreSumIncChangeOp",
+    "aligEdgesIncSwapOp",
+    "squaredAligEdgesIncSwapOp",
+    "exposedEdgesIncSwapOp",
+    "MS3IncSwapOp",
+    "WECIncSwapOp",
+    "EWECIncSwapOp",
+    "localScoreSumIncSwapOp"
+};
 uint SANA::INVALID_ACTIVE_COLOR_ID;
 
 SANA::SANA(const Graph* G1, const Graph* G2,
@@ -73,10 +95,10 @@ SANA::SANA(const Graph* G1, const Graph* G2,
     else if (scoreAggrStr == "min")       scoreAggr = ScoreAggregation::min;
     else if (scoreAggrStr == "maxFactor") scoreAggr = ScoreAggregation::maxFactor;
     else throw runtime_error("unknown score aggregation: "+scoreAggrStr);
+    objectiveHash = ScheduleCache::objectiveHash(*MC, scoreAggrStr);
 
     //random number generation
-    gen = mt19937(getRandomSeed());
-    randomReal = uniform_real_distribution<>(0, 1);
+    gen.seed(getRandomSeed());
 
     //temperature schedule
     if (maxIterations > 0 and maxSeconds > 0)
@@ -90,10 +112,7 @@ SANA::SANA(const Graph* G1, const Graph* G2,
 
     //objective function
     ecWeight  = MC->getWeight("ec");
-    edWeight  = MC->getWeight("ed");
-    erWeight  = MC->getWeight("er");
     s3Weight  = MC->getWeight("s3");
-    jsWeight  = MC->getWeight("js");
     icsWeight = MC->getWeight("ics");
     secWeight = MC->getWeight("sec");
     mecWeight = MC->getWeight("mec");
@@ -104,27 +123,15 @@ SANA::SANA(const Graph* G1, const Graph* G2,
     catch(...) { wecWeight = 0; }
     try { ewecWeight = MC->getWeight("ewec"); }
     catch(...) { ewecWeight = 0; }
-    try {
-        needNC = false;
-        ncWeight = MC->getWeight("nc");
-        Measure* nc = MC->getMeasure("nc");
-        trueAWithValidCountAppended = ((NodeCorrectness*) nc)->getMappingforNC();
-        needNC = true;
-    } catch(...) {
-        ncWeight = 0;
-        trueAWithValidCountAppended = {static_cast<uint>(G2->getNumNodes()), 1};
-    }
+    incMeasures.init(G1, G2, MC);
     localWeight = MC->getSumLocalWeight();
 
     //indicate which variables need to be maintained incrementally
     needAligEdges        = icsWeight > 0 or ecWeight > 0 or s3Weight > 0 or wecWeight > 0 or secWeight > 0 or mecWeight > 0;
-    needEd               = edWeight > 0; //edge difference
-    needEr               = erWeight > 0; //edge ratio
     needSquaredAligEdges = sesWeight > 0; //SES
     needExposedEdges     = eeWeight > 0 or MultiS3::denominator_type == MultiS3::ee_global; //EE; if needMS3, might use EE as denom
     needMS3              = ms3Weight > 0;
     needInducedEdges     = s3Weight > 0 or icsWeight > 0;
-    needJs               = jsWeight > 0;
     needWec              = wecWeight > 0;
     needEwec             = ewecWeight>0;
     needSec              = secWeight > 0;
@@ -134,15 +141,71 @@ SANA::SANA(const Graph* G1, const Graph* G2,
     needExposedEdges     = false;
     needMS3              = false;
 #endif
+    bool needEc = needAligEdges or needSec;
+    bool needNeighborhoodHooks = incMeasures.usesNeighborhoodHooks();
+    neighborhoodChangeOp = (needEc or needWec or needNeighborhoodHooks or needEwec) ?
+        selectNeighborhoodChangeOp<>(needEc, needWec, needNeighborhoodHooks, needEwec) : nullptr;
+    incMeasures.setNeighborhoodDriven(needNeighborhoodHooks);
+#if defined(BIT_ADJACENCY) and not defined(MULTI_PAIRWISE)
+    if (needEc and not needWec and not needNeighborhoodHooks and not needEwec and G2->hasAdjBits()) {
+        g2BitRows = &(G2->getAdjBits());
+        neighborhoodChangeOp = &SANA::aligEdgesBitRowsChangeOp;
+        Profiler::setInfo("aligned edges kernel", rowBitDifferenceImplementation());
+    }
+#endif
+    //the local measures with matrices, if any, are aggregated in one of sims, topSims or quantizedSims
+    auto implicitSimMap = MC->getLocalImplicitSimMap();
+    bool needLocalMatrices = needLocal and MC->getNumberOfLocalMeasures() > (int) implicitSimMap.size();
+    bool separateLocalSums = needLocal and MC->getNumberOfLocalMeasures() > 1;
+    if (needLocalMatrices and LocalMeasure::getTopK() > 0) {
+        topSims = &(MC->getAggregatedLocalTopSims());
+        auto topSimMap = MC->getLocalTopSimMap();
+        if (separateLocalSums) {
+            for (const auto& item : topSimMap) {
+                localMeasureNames.push_back(item.first);
+                localTopSims.push_back(item.second.first);
+                localSimWeights.push_back(item.second.second);
+            }
+        }
+    } else if (needLocalMatrices and LocalMeasure::getPrecision() != SimPrecision::FP32) {
+        quantizedSims = &(MC->getAggregatedLocalQuantizedSims());
+        auto quantizedSimMap = MC->getLocalQuantizedSimMap();
+        if (separateLocalSums) {
+            for (const auto& item : quantizedSimMap) {
+                localMeasureNames.push_back(item.first);
+                localQuantizedSims.push_back(item.second.first);
+                localSimWeights.push_back(item.second.second);
+            }
+        }
+    } else if (needLocalMatrices) {
+        //a single measure with weight 1 is read from its own matrix. otherwise the weighted sums are
+        //computed when they are read (see localSimSum), instead of being kept in another n1*n2 matrix
+        if (implicitSimMap.empty() and MC->aggregatedLocalSimsAreView()) sims = &(MC->getAggregatedLocalSims());
+        const auto& simMap = MC->getLocalSimMap();
+        if (separateLocalSums) {
+            for (const auto& item : simMap) {
+                localMeasureNames.push_back(item.first);
+                localSimMatrices.push_back(&item.second.first);
+                localSimWeights.push_back(item.second.second);
+            }
+        }
+    }
+    //after the aggregation, which in top-k mode frees the dense matrix that getSimMatrix would return
     if (needWec) {
         Measure* wec                     = MC->getMeasure("wec");
         LocalMeasure* m                  = ((WeightedEdgeConservation*) wec)->getNodeSimMeasure();
-        vector<vector<float>>* wecSimsP = m->getSimMatrix();
-        wecSims                          = (*wecSimsP);
+        implicitWecSims                  = m->getImplicitSims();
+        quantizedWecSims                 = m->getQuantizedSims();
+        if (not implicitWecSims and not quantizedWecSims) wecSims = m->getSimMatrix();
     }
+    bool denseSims = LocalMeasure::getTopK() == 0 and LocalMeasure::getPrecision() == SimPrecision::FP32;
+    if (needLocal and denseSims and not sims) localSimSum = MC->getLocalSimSum();
     if (needLocal) {
-        sims              = MC->getAggregatedLocalSims();
-        localSimMatrixMap = MC->getLocalSimMap();
+        for (const auto& item : implicitSimMap) {
+            if (separateLocalSums) localMeasureNames.push_back(item.first);
+            localImplicitSims.push_back(item.second.first);
+            implicitSimWeights.push_back(item.second.second);
+        }
         localWeight       = 1; //the values in the sim Matrix 'sims' have already been scaled by the weight
     } else {
         localWeight = 0;
@@ -157,7 +220,11 @@ SANA::SANA(const Graph* G1, const Graph* G2,
     constantTemp          = false;
     enableTrackProgress   = true;
     iterationsPerStep     = 10000000;
+    pBadSampleInterval    = 1;
+    useIpsCache           = true;
     avgEnergyInc          = -0.00001; //to track progress
+    profiling             = Profiler::isEnabled();
+    resetLoopProfile();
 
     // NODE COLOR SYSTEM initialization
     assert(G1->numColors() <= G2->numColors());
@@ -237,6 +304,8 @@ SANA::SANA(const Graph* G1, const Graph* G2,
     //they have the same size for every run, so we can allocate the size here
     assignedNodesG2 = vector<bool> (n2);
     totalInducedWeight = vector<uint> (n2,0);
+    needWhichPeg = needMS3;
+    if (needWhichPeg) whichPeg = vector<uint> (n2, n1);
     actColToUnassignedG2Nodes = vector<vector<uint>> (actColToG1ColId.size());
 }
 
@@ -250,9 +319,11 @@ SANA::~SANA() {}
 void SANA::initDataStructures() {
     iterationsPerformed = 0;
     numPBadsInBuffer = pBadBufferSum = pBadBufferIndex = 0;
+    badMovesSinceLastSample = 0;
+    numPBadsSampled = 0;
     Alignment alig;
     if (startA.size() != 0) alig = startA;
-    else alig = Alignment::randomColorRestrictedAlignment(*G1, *G2);
+    else alig = Alignment::randomColorRestrictedAlignment(*G1, *G2, gen);
 
     //initialize assignedNodesG2 (the size was already set in the constructor)
     for (uint i = 0; i < n2; i++) assignedNodesG2[i] = false;
@@ -269,20 +340,22 @@ void SANA::initDataStructures() {
     }
 
     if (needAligEdges or needSec) aligEdges = alig.numAlignedEdges(*G1, *G2);
-    if (needEd) edSum = EdgeDifference::getEdgeDifferenceSum(G1, G2, alig);
-    if (needEr) erSum = EdgeRatio::getEdgeRatioSum(G1, G2, alig);
     if (needSquaredAligEdges) squaredAligEdges =
             ((SquaredEdgeScore*) MC->getMeasure("ses"))->numSquaredAlignedEdges(alig);
-    if (needExposedEdges) EdgeExposure::numer = 
+    if (needExposedEdges) exposedEdgesNumer = 
         EdgeExposure::numExposedEdges(alig, *G1, *G2);//- EdgeExposure::getMaxEdge();
     if (needMS3) {
-        MultiS3::numer = ((MultiS3*) MC->getMeasure("ms3"))->computeNumer(alig);
-        MultiS3::denom = ((MultiS3*) MC->getMeasure("ms3"))->computeDenom(alig);
-	EL_k = MultiS3::EL_k;
-	ER_k = MultiS3::ER_k;
-	RU_k = MultiS3::RU_k;
-	RA_k = MultiS3::RA_k;
-	RO_k = MultiS3::RO_k;
+        MultiS3* ms3 = (MultiS3*) MC->getMeasure("ms3");
+        MultiS3::RungCounts counts;
+        MS3Numer = ms3->computeNumer(alig);
+        MS3Denom = ms3->computeDenom(alig, counts);
+        MS3NormalizationFactor = ms3->getNormalizationFactor();
+        shadowDegree = ms3->computeShadowDegrees(alig);
+	EL_k = counts.EL_k;
+	ER_k = counts.ER_k;
+	RU_k = counts.RU_k;
+	RA_k = counts.RA_k;
+	RO_k = counts.RO_k;
 	for (uint i = 0; i < n1; i++) {
 	    totalInducedWeight[alig[i]] = 0;
 	    for(uint j=0;j<n1;j++) if(i!=j) {
@@ -297,61 +370,83 @@ void SANA::initDataStructures() {
     if (needInducedEdges) inducedEdges = G2->numEdgesInNodeInducedSubgraph(alig.asVector());
     if (needLocal) {
         localScoreSum = 0;
-        for (uint i = 0; i < n1; i++) localScoreSum += sims[i][alig[i]];
-        localScoreSumMap.clear();
+        for (uint i = 0; i < n1; i++) localScoreSum += aggregatedLocalSim(i, alig[i]);
     }
     if (needWec) {
         Measure* wec    = MC->getMeasure("wec");
         double wecScore = wec->eval(alig);
         wecSum          = wecScore*2*g1Edges;
     }
-    if (needJs) {
-        Measure* js = MC->getMeasure("js");
-        jsSum       = js->eval(alig);
-        alignedByNode = JaccardSimilarityScore::getAlignedByNode(G1, G2, alig);
-    }
     if (needEwec) {
         ewec    = (ExternalWeightedEdgeConservation*)(MC->getMeasure("ewec"));
         ewecSum = ewec->eval(alig);
     }
-    if (needNC) {
-        Measure* nc = MC->getMeasure("nc");
-        ncSum       = (nc->eval(alig))*trueAWithValidCountAppended.back(); 
-    }
+    incMeasures.reset(alig);
     currentScore = eval(alig);
     A = alig.asVector();
+    initHoleIndices();
     timer.start();
 }
 
+void SANA::initHoleIndices() {
+    if (needWhichPeg) {
+        for (uint i = 0; i < n2; i++) whichPeg[i] = n1;
+        for (uint i = 0; i < n1; i++) whichPeg[A[i]] = i;
+    }
+    if (topKMoveProb > 0) {
+        for (const vector<uint>& holes : actColToUnassignedG2Nodes)
+            for (uint i = 0; i < holes.size(); i++) unassignedIndex[holes[i]] = i;
+    }
+}
 
-Alignment SANA::run() {
-    initDataStructures();
-    setInterruptSignal();
 
+Alignment SANA::run() {
+    long long int maxIters, firstIter = 0;
+    //the ips is measured (if needed) before the initial alignment is chosen, so that the
+    //measurement does not affect the run
+    if (resumeFileName == "") {
 #ifndef MULTI_PAIRWISE
-    getIterPerSecond(); // this takes several seconds of CPU time; don't do it during multi-only-iterations.
+        if (not useIterations) getIterPerSecond(); // this takes several seconds of CPU time; don't do it during multi-only-iterations.
 #endif
-    long long int maxIters = useIterations ? maxIterations
-                                           : (long long int) (getIterPerSecond()*maxSeconds);
+        maxIters = getMaxIterations();
+    }
+    initDataStructures();
+    if (not externalRequests) setInterruptSignal();
+    if (resumeFileName != "") firstIter = loadCheckpoint(resumeFileName, maxIters) + 1;
     double leeway = 2;
     double maxSecondsWithLeeway = maxSeconds * leeway;
+    lastCheckpointTime = timer.elapsed();
+    double annealingStartTime = timer.elapsed();
+    resetLoopProfile();
+    Profiler::ScopedPhase annealingPhase("annealing");
 
     long long int iter;
-    for (iter = 0; iter <= maxIters; iter++) {
+    for (iter = firstIter; iter <= maxIters; iter++) {
         Temperature = temperatureFunction(iter, TInitial, TDecay);
         SANAIteration();
-        if (saveAligAndExitOnInterruption) break;
-        if (saveAligAndContOnInterruption) printReportOnInterruption();
         if (iter%iterationsPerStep == 0) {
             trackProgress(iter, maxIters);
+            bool stopRequested = handleControlRequests();
             if (not useIterations and timer.elapsed() > maxSecondsWithLeeway
                 and currentScore-previousScore < 0.005) break;
             previousScore = currentScore;
+            //a stopped run can be resumed from its last iteration
+            if (checkpointFileName != "" and (stopRequested or
+                    timer.elapsed()-lastCheckpointTime >= checkpointIntervalSeconds))
+                saveCheckpoint(iter, maxIters);
+            if (stopRequested) break;
         }
     }
     trackProgress(iter, maxIters);
+    annealingPhase.stop();
+    //the speed of the whole run, including the progress tracking, is the best estimate for
+    //the next time-limited run with the same graphs and objective
+    if (useIpsCache and iter > firstIter)
+        writeCachedIps((iter-firstIter)/(timer.elapsed()-annealingStartTime));
+    BackgroundWriter::waitUntilIdle(); //pending checkpoints and snapshots
     cout<<"Performed "<<iter<<" total iterations\n";
-    if (addHillClimbing) performHillClimbing(10000000LL); //arbitrarily chosen, probably too big.
+    if (addHillClimbing) performHillClimbing(HILL_CLIMBING_IDLE_ITERATIONS);
+    addLoopProfileToProfiler();
 
 #ifdef CORES
     Report::saveCoreScore(*G1, *G2, A, this, coreScoreData, outputFileName);
@@ -362,6 +457,7 @@ Alignment SANA::run() {
 
 
 void SANA::performHillClimbing(long long int idleCountTarget) {
+    Profiler::ScopedPhase phase("hill climbing");
     long long int iter = 0;
     Temperature = 0;
     numPBadsInBuffer = pBadBufferSum = pBadBufferIndex = 0; 
@@ -408,6 +504,17 @@ double SANA::acceptingProbability(double energyInc, double Temperature) {
     return energyInc >= 0 ? 1 : exp(energyInc/Temperature);
 }
 
+bool SANA::acceptMove(double energyInc, double Temperature) {
+    if (energyInc >= 0) return true;
+    double x = energyInc/Temperature;
+    double u = gen.real01();
+    //for x < 0: 1+x+x^2/2+x^3/6 <= exp(x) <= 1/(1-x+x^2/2-x^3/6)
+    double x2 = x*x, x3 = x2*x;
+    if (u < 1 + x + x2/2 + x3/6) return true;
+    if (u * (1 - x + x2/2 - x3/6) >= 1) return false;
+    return u < exp(x);
+}
+
 double SANA::incrementalMeanPBad() {
     return pBadBufferSum/(double) numPBadsInBuffer;
 }
@@ -418,9 +525,48 @@ double SANA::slowMeanPBad() {
     return sum/(double) numPBadsInBuffer;
 }
 
+double SANA::meanOfLastPBads(int count) {
+    count = min(count, numPBadsInBuffer);
+    double sum = 0;
+    //pBadBufferIndex is one past the last pBad added (it wraps around lazily)
+    int index = pBadBufferIndex;
+    for (int i = 0; i < count; i++) {
+        index = (index == 0 ? PBAD_CIRCULAR_BUFFER_SIZE : index) - 1;
+        sum += pBadBuffer[index];
+    }
+    return sum/(double) count;
+}
+
+bool SANA::pBadBlocksAtEquilibrium(const vector<double>& blockMeans) {
+    //least-squares line through the points (i, blockMeans[i])
+    uint n = blockMeans.size();
+    double xMean = (n-1)/2.0;
+    double yMean = vectorMean(blockMeans);
+    double sxx = 0, sxy = 0;
+    for (uint i = 0; i < n; i++) {
+        sxx += (i-xMean)*(i-xMean);
+        sxy += (i-xMean)*(blockMeans[i]-yMean);
+    }
+    double slope = sxy/sxx;
+    double residualSum = 0, deviationSum = 0;
+    for (uint i = 0; i < n; i++) {
+        double residual = blockMeans[i] - (yMean + slope*(i-xMean));
+        residualSum += residual*residual;
+        deviationSum += (blockMeans[i]-yMean)*(blockMeans[i]-yMean);
+    }
+    //no trend: the slope is within about two standard errors of 0 (a t-test at ~95% confidence)
+    double slopeStdError = sqrt(residualSum/(n-2)/sxx);
+    bool noTrend = abs(slope) <= PBAD_EQ_MAX_T_STATISTIC*slopeStdError;
+    //precise: the standard error of the mean of the blocks is small relative to the mean.
+    //at equilibrium the blocks are close to independent samples of the same distribution
+    double meanStdError = sqrt(deviationSum/(n-1)/n);
+    bool precise = meanStdError <= PBAD_EQ_MAX_RELATIVE_ERROR*yMean;
+    return noTrend and precise;
+}
+
 double SANA::eval(const Alignment& Al) const { return MC->eval(Al); }
 
-void sigIntHandler(int s) {
+void interactiveSigIntHandler(int s) {
     string line;
     int c = -1;
     do {
@@ -435,50 +581,206 @@ void sigIntHandler(int s) {
         }
         if      (c == 0) cout<<"Continuing..."<<endl;
         else if (c == 1) exit(0);
-        else if (c == 2) SANA::saveAligAndExitOnInterruption = true;
-        else if (c == 3) SANA::saveAligAndContOnInterruption = true;
+        else if (c == 2) SANA::controlRequests.fetch_or(SANA::STOP_REQUEST);
+        else if (c == 3) SANA::controlRequests.fetch_or(SANA::SNAPSHOT_REQUEST);
     } while (c < 0 || c > 3);    
 }
+
+//only async-signal-safe operations here (atomic<int> is lock-free)
+void batchSignalHandler(int s) {
+    if (s == SIGUSR1) SANA::controlRequests.fetch_or(SANA::SNAPSHOT_REQUEST);
+    else if (s == SIGINT and (SANA::controlRequests.load() & SANA::STOP_REQUEST)) _exit(1); //second Control+C
+    else SANA::controlRequests.fetch_or(SANA::STOP_REQUEST);
+}
+
 void SANA::setInterruptSignal() {
-    saveAligAndExitOnInterruption = false;
+    controlRequests = 0;
     struct sigaction sigInt;
-    sigInt.sa_handler = sigIntHandler;
+    sigInt.sa_handler = isatty(STDIN_FILENO) ? interactiveSigIntHandler : batchSignalHandler;
     sigemptyset(&sigInt.sa_mask);
     sigInt.sa_flags = 0;
     sigaction(SIGINT, &sigInt, NULL);
+
+    struct sigaction sigUsr;
+    sigUsr.sa_handler = batchSignalHandler;
+    sigemptyset(&sigUsr.sa_mask);
+    sigUsr.sa_flags = SA_RESTART;
+    sigaction(SIGUSR1, &sigUsr, NULL);
+    sigaction(SIGUSR2, &sigUsr, NULL);
+}
+
+int SANA::pollControlRequests() {
+    if (controlFileName != "" and FileIO::fileExists(controlFileName)) {
+        vector<string> words = FileIO::fileToWords(controlFileName);
+        FileIO::deleteFile(controlFileName);
+        string command = words.empty() ? "" : words[0];
+        if (command == "snapshot") controlRequests.fetch_or(SNAPSHOT_REQUEST);
+        else if (command == "stop") controlRequests.fetch_or(STOP_REQUEST);
+        else cerr << "unknown command in " << controlFileName << ": '" << command << "'" << endl;
+    }
+    return controlRequests.fetch_and(~SNAPSHOT_REQUEST); //the stop request is kept, for a second Control+C
 }
-void SANA::printReportOnInterruption() {
-    saveAligAndContOnInterruption = false; //reset value
+
+void SANA::setExternalControl() { externalRequests = make_shared<atomic<int>>(0); }
+
+void SANA::addControlRequests(int requests) { externalRequests->fetch_or(requests); }
+
+bool SANA::handleControlRequests() {
+    int requests = externalRequests ? externalRequests->fetch_and(~SNAPSHOT_REQUEST) : pollControlRequests();
+    if (requests & SNAPSHOT_REQUEST) saveSnapshot();
+    if (requests & STOP_REQUEST) {
+        cout << progressLabel << "Stop requested. Ending the run" << endl;
+        return true;
+    }
+    return false;
+}
+
+void SANA::saveSnapshot() {
     string timestamp = string(currentDateTime()); //necessary to make it not const
     std::replace(timestamp.begin(), timestamp.end(), ' ', '_');
-    string outFile = outputFileName+"_"+timestamp;
-    string localFile = localScoresFileName+"_"+timestamp;
-    Report::saveReport(*G1, *G2, A, *MC, this, outFile, true);
-    Report::saveLocalMeasures(*G1, *G2, A, *MC, this, localFile);
+    string outFile = outputFileName+"_"+timestamp+snapshotSuffix;
+    string localFile = localScoresFileName+"_"+timestamp+snapshotSuffix;
+    Alignment snapshot(A); //the anneal continues while the copy is saved
 #ifdef CORES
     Report::saveCoreScore(*G1, *G2, A, this, coreScoreData, outputFileName);
 #endif
-    cout << "Alignment saved. SANA will now continue." << endl;
+    //the measures only read the alignment, so they can be evaluated while the main loop runs
+    BackgroundWriter::addTask([this, snapshot, outFile, localFile]() {
+        Report::saveReport(*G1, *G2, snapshot, *MC, this, outFile, true);
+        Report::saveLocalMeasures(*G1, *G2, snapshot, *MC, this, localFile);
+        cout << progressLabel << "Snapshot saved as " << outFile << endl;
+    });
+    cout << progressLabel << "Saving a snapshot of the current alignment in the background" << endl;
+}
+
+void SANA::setControlFile(const string& fileName) { controlFileName = fileName; }
+
+void SANA::resetLoopProfile() {
+    deltaTicks.assign(NUM_DELTA_FUNCTIONS + 2*IncrementalMeasures::SIZE, 0);
+    deltaSamples.assign(NUM_DELTA_FUNCTIONS + 2*IncrementalMeasures::SIZE, 0);
+    sampledChanges = acceptedSampledChanges = sampledSwaps = acceptedSampledSwaps = 0;
+}
+
+void SANA::addLoopProfileToProfiler() {
+    if (not profiling) return;
+    for (uint i = 0; i < NUM_DELTA_FUNCTIONS; i++)
+        Profiler::addSampledFunction(DELTA_FUNCTION_NAMES[i], deltaTicks[i], deltaSamples[i]);
+    for (uint i = 0; i < IncrementalMeasures::SIZE; i++) {
+        string name = IncrementalMeasures::name(i);
+        uint change = NUM_DELTA_FUNCTIONS + i, swap = NUM_DELTA_FUNCTIONS + IncrementalMeasures::SIZE + i;
+        Profiler::addSampledFunction(name+" proposeChange", deltaTicks[change], deltaSamples[change]);
+        Profiler::addSampledFunction(name+" proposeSwap", deltaTicks[swap], deltaSamples[swap]);
+    }
+    Profiler::addCounter("sampled changes", sampledChanges);
+    Profiler::addCounter("accepted sampled changes", acceptedSampledChanges);
+    Profiler::addCounter("sampled swaps", sampledSwaps);
+    Profiler::addCounter("accepted sampled swaps", acceptedSampledSwaps);
+    //ratios from the totals, which include the other chains if there are several
+    double changes = Profiler::getCounter("sampled changes"), swaps = Profiler::getCounter("sampled swaps");
+    double accepted = Profiler::getCounter("accepted sampled changes")+Profiler::getCounter("accepted sampled swaps");
+    Profiler::setCounter("change fraction", changes/(changes+swaps));
+    Profiler::setCounter("accept ratio", accepted/(changes+swaps));
 }
 
 void SANA::SANAIteration() {
     ++iterationsPerformed;
-    uint actColId = randActiveColorIdWeightedByNumNbrs();
-    double p = randomReal(gen);
-    if (p < actColToChangeProb[actColId]) {
-        performChange(actColId);
+    profileThisIteration = profiling and (iterationsPerformed & (PROFILE_SAMPLE_INTERVAL-1)) == 0;
+    Move move = drawMove(gen);
+    if (move.isChange) performChange(move);
+    else performSwap(move);
+}
+
+//the entry (i, j) of each kind of similarity matrix
+static inline float simAt(const Matrix<float>& sim, uint i, uint j) { return sim[i][j]; }
+static inline float simAt(const TopKSimMatrix& sim, uint i, uint j) { return sim.get(i, j); }
+static inline float simAt(const QuantizedMatrix& sim, uint i, uint j) { return sim.get(i, j); }
+static inline float simAt(const ImplicitSims& sim, uint i, uint j) { return sim.get(i, j); }
+static inline float simAt(const LocalSimSum& sim, uint i, uint j) { return sim.get(i, j); }
+
+double SANA::aggregatedLocalSim(uint peg, uint hole) const {
+    if (not localSimSum.empty()) return localSimSum.get(peg, hole);
+    double res = 0;
+    if (topSims) res = topSims->get(peg, hole);
+    else if (quantizedSims) res = quantizedSims->get(peg, hole);
+    else if (sims) res = (*sims)[peg][hole];
+    for (uint k = 0; k < localImplicitSims.size(); k++)
+        res += implicitSimWeights[k] * localImplicitSims[k]->get(peg, hole);
+    return res;
+}
+
+double SANA::localMeasureScoreSum(uint k) const {
+    uint numWithMatrices = localMeasureNames.size() - localImplicitSims.size();
+    double sum = 0;
+    if (k >= numWithMatrices) {
+        const ImplicitSims& sim = *localImplicitSims[k - numWithMatrices];
+        for (uint i = 0; i < n1; i++) sum += sim.get(i, A[i]);
+        return implicitSimWeights[k - numWithMatrices] * sum;
+    }
+    for (uint i = 0; i < n1; i++) {
+        if (not localTopSims.empty()) sum += localTopSims[k]->get(i, A[i]);
+        else if (not localQuantizedSims.empty()) sum += localQuantizedSims[k]->get(i, A[i]);
+        else sum += (*localSimMatrices[k])[i][A[i]];
+    }
+    return localSimWeights[k] * sum;
+}
+
+double SANA::aggregatedLocalScoreSumIncChangeOp(uint peg, uint oldHole, uint newHole) {
+    if (not localSimSum.empty()) return localScoreSumIncChangeOp(localSimSum, peg, oldHole, newHole);
+    double res = 0;
+    if (topSims) res = localScoreSumIncChangeOp(*topSims, peg, oldHole, newHole);
+    else if (quantizedSims) res = localScoreSumIncChangeOp(*quantizedSims, peg, oldHole, newHole);
+    else if (sims) res = localScoreSumIncChangeOp(*sims, peg, oldHole, newHole);
+    for (uint k = 0; k < localImplicitSims.size(); k++)
+        res += implicitSimWeights[k] * localScoreSumIncChangeOp(*localImplicitSims[k], peg, oldHole, newHole);
+    return res;
+}
+
+double SANA::aggregatedLocalScoreSumIncSwapOp(uint peg1, uint peg2, uint hole1, uint hole2) {
+    if (not localSimSum.empty()) return localScoreSumIncSwapOp(localSimSum, peg1, peg2, hole1, hole2);
+    double res = 0;
+    if (topSims) res = localScoreSumIncSwapOp(*topSims, peg1, peg2, hole1, hole2);
+    else if (quantizedSims) res = localScoreSumIncSwapOp(*quantizedSims, peg1, peg2, hole1, hole2);
+    else if (sims) res = localScoreSumIncSwapOp(*sims, peg1, peg2, hole1, hole2);
+    for (uint k = 0; k < localImplicitSims.size(); k++)
+        res += implicitSimWeights[k] * localScoreSumIncSwapOp(*localImplicitSims[k], peg1, peg2, hole1, hole2);
+    return res;
+}
+
+SANA::Move SANA::drawMove(Xoshiro256& rng) const {
+    Move move;
+    move.actColId = randActiveColorIdWeightedByNumNbrs(rng);
+    move.isChange = rng.real01() < actColToChangeProb[move.actColId];
+    move.peg1 = randomG1NodeWithActiveColor(move.actColId, rng);
+    if (topKMoveProb > 0 and rng.real01() < topKMoveProb and drawTopKMove(move, rng)) return move;
+    if (move.isChange) {
+        uint numUnassigWithCol = actColToUnassignedG2Nodes[move.actColId].size();
+        assert(numUnassigWithCol > 0);
+        move.unassignedVecIndex = rng.boundedInt(numUnassigWithCol);
     } else {
-        performSwap(actColId);
+        for (uint i = 0; i < 100; i++) { //each attempt has >=50% chance of success
+            move.peg2 = randomG1NodeWithActiveColor(move.actColId, rng);
+            if (move.peg1 != move.peg2) break;
+        }
     }
+    return move;
+}
+
+bool SANA::drawTopKMove(Move& move, Xoshiro256& rng) const {
+    uint hole = topSims->rowCols(move.peg1)[rng.boundedInt(topSims->rowLength())];
+    if (hole == A[move.peg1] or g2NodeToActColId[hole] != move.actColId) return false;
+    move.isChange = whichPeg[hole] == n1;
+    if (move.isChange) move.unassignedVecIndex = unassignedIndex[hole];
+    else move.peg2 = whichPeg[hole];
+    return true;
 }
 
 uint SANA::numActiveColors() const {
     return actColToChangeProb.size();
 }
 
-uint SANA::randActiveColorIdWeightedByNumNbrs() {
+uint SANA::randActiveColorIdWeightedByNumNbrs(Xoshiro256& rng) const {
     if (numActiveColors() == 1) return 0; //optimized special case: monochromatic graphs
-    double p = randomReal(gen);
+    double p = rng.real01();
     if (numActiveColors() == 2) //optimized special case: bichromatic graphs
         return (p < actColToAccumProbCutpoint[0] ? 0 : 1);
 
@@ -488,20 +790,17 @@ uint SANA::randActiveColorIdWeightedByNumNbrs() {
     return iter - actColToAccumProbCutpoint.begin();
 }
 
-uint SANA::randomG1NodeWithActiveColor(uint actColId) const {
+uint SANA::randomG1NodeWithActiveColor(uint actColId, Xoshiro256& rng) const {
     uint g1ColId = actColToG1ColId[actColId];
-    uint randIndex = randInt(0, G1->nodeGroupsByColor[g1ColId].size()-1);
+    uint randIndex = rng.boundedInt(G1->nodeGroupsByColor[g1ColId].size());
     return G1->nodeGroupsByColor[g1ColId][randIndex];
 } 
 
-void SANA::performChange(uint actColId) {
-    uint peg = randomG1NodeWithActiveColor(actColId);
+void SANA::performChange(const Move& move) {
+    uint actColId = move.actColId, peg = move.peg1, unassignedVecIndex = move.unassignedVecIndex;
     uint oldHole = A[peg];
-    uint numUnassigWithCol = actColToUnassignedG2Nodes[actColId].size();
-    uint unassignedVecIndex = randInt(0, numUnassigWithCol-1);
     uint newHole = actColToUnassignedG2Nodes[actColId][unassignedVecIndex];
 
-    assert(numUnassigWithCol > 0);
     assert(oldHole != newHole);
     // assert(G1->getColorName(G1->getNodeColor(peg)) == G2->getColorName(G2->getNodeColor(oldHole)));
     // assert(G2->getNodeColor(newHole) == G2->getNodeColor(oldHole));
@@ -510,92 +809,87 @@ void SANA::performChange(uint actColId) {
    unsigned saveOldHoleDeg = 0, saveNewHoleDeg = 0, oldMs3Denom = 0, oldMs3Numer =0;
 
     if (needMS3) {
-        saveOldHoleDeg = MultiS3::shadowDegree[oldHole];
-        saveNewHoleDeg = MultiS3::shadowDegree[newHole];
-        oldMs3Denom = MultiS3::denom;
-        oldMs3Numer = MultiS3::numer;
-    }
-    int newAligEdges           = (needAligEdges or needSec) ? aligEdges + aligEdgesIncChangeOp(peg, oldHole, newHole) : -1;
-    double newEdSum            = needEd ? edSum + edgeDifferenceIncChangeOp(peg, oldHole, newHole) : -1;
-    double newErSum            = needEr ? erSum + edgeRatioIncChangeOp(peg, oldHole, newHole) : -1;
-    double newSquaredAligEdges = needSquaredAligEdges ? squaredAligEdges + squaredAligEdgesIncChangeOp(peg, oldHole, newHole) : -1;
-    double newExposedEdgesNumer= needExposedEdges ? EdgeExposure::numer + exposedEdgesIncChangeOp(peg, oldHole, newHole) : -1;
-    double newMS3Numer         = needMS3 ? MultiS3::numer + MS3IncChangeOp(peg, oldHole, newHole) : -1;
-    int newInducedEdges        = needInducedEdges ? inducedEdges + inducedEdgesIncChangeOp(peg, oldHole, newHole) : -1;
-    double newLocalScoreSum    = needLocal ? localScoreSum + localScoreSumIncChangeOp(sims, peg, oldHole, newHole) : -1;
-    double newWecSum           = needWec ? wecSum + WECIncChangeOp(peg, oldHole, newHole) : -1;
-    double newJsSum            = needJs ? jsSum + JSIncChangeOp(peg, oldHole, newHole) : -1;
-    double newEwecSum          = needEwec ? ewecSum + EWECIncChangeOp(peg, oldHole, newHole) : -1;
-    double newNcSum            = needNC ? ncSum + ncIncChangeOp(peg, oldHole, newHole) : -1;
-
-    map<string, double> newLocalScoreSumMap;
-    if (needLocal) {
-        newLocalScoreSumMap = map<string, double>(localScoreSumMap);
-        for (auto &item : newLocalScoreSumMap)
-            item.second += localScoreSumIncChangeOp(localSimMatrixMap[item.first], peg, oldHole, newHole);
-    }
+        saveOldHoleDeg = shadowDegree[oldHole];
+        saveNewHoleDeg = shadowDegree[newHole];
+        oldMs3Denom = MS3Denom;
+        oldMs3Numer = MS3Numer;
+    }
+    NeighborhoodDeltas deltas = {0, 0, 0};
+    if (neighborhoodChangeOp != nullptr)
+        deltas = profiled(NEIGHBORHOOD_CHANGE, [&]() { return (this->*neighborhoodChangeOp)(peg, oldHole, newHole); });
+    int newAligEdges           = (needAligEdges or needSec) ? aligEdges + deltas.aligEdges : -1;
+    double newSquaredAligEdges = needSquaredAligEdges ? squaredAligEdges + profiled(SQUARED_ALIG_EDGES_CHANGE, [&]() { return squaredAligEdgesIncChangeOp(peg, oldHole, newHole); }) : -1;
+    double newExposedEdgesNumer= needExposedEdges ? exposedEdgesNumer + profiled(EXPOSED_EDGES_CHANGE, [&]() { return exposedEdgesIncChangeOp(peg, oldHole, newHole); }) : -1;
+    double newMS3Numer         = needMS3 ? MS3Numer + profiled(MS3_CHANGE, [&]() { return MS3IncChangeOp(peg, oldHole, newHole); }) : -1;
+    int newInducedEdges        = needInducedEdges ? inducedEdges + profiled(INDUCED_EDGES_CHANGE, [&]() { return inducedEdgesIncChangeOp(peg, oldHole, newHole); }) : -1;
+    double newLocalScoreSum    = needLocal ? localScoreSum + profiled(LOCAL_SCORE_SUM_CHANGE, [&]() { return aggregatedLocalScoreSumIncChangeOp(peg, oldHole, newHole); }) : -1;
+    double newWecSum           = needWec ? wecSum + deltas.wec : -1;
+    double newEwecSum          = needEwec ? ewecSum + deltas.ewec : -1;
+    incMeasures.proposeChange(A, peg, oldHole, newHole,
+            profileThisIteration ? &deltaTicks[NUM_DELTA_FUNCTIONS] : nullptr,
+            profileThisIteration ? &deltaSamples[NUM_DELTA_FUNCTIONS] : nullptr);
 
     double newCurrentScore = 0;
-    double pBad = scoreComparison(newAligEdges, newInducedEdges,
-            newLocalScoreSum, newWecSum, newJsSum, newNcSum, newCurrentScore, newEwecSum,
-            newSquaredAligEdges, newExposedEdgesNumer, newMS3Numer, newEdSum, newErSum);
-    bool makeChange;
-    //if(newCurrentScore == currentScore) makeChange = false; else // if it ain't broke, don't fix it
-    makeChange = randomReal(gen) < pBad;
+    bool makeChange = scoreComparison(newAligEdges, newInducedEdges,
+            newLocalScoreSum, newWecSum, newCurrentScore, newEwecSum,
+            newSquaredAligEdges, newExposedEdgesNumer, newMS3Numer);
 
 #ifdef CORES
     // Statistics on the emerging core alignment.
     // only update pBad if is nonzero; reuse previous nonzero pBad if the current one is zero.
     uint betterHole = wasBadMove ? oldHole : newHole;
 
+    double pBad = acceptingProbability(energyInc, Temperature);
     double meanPBad = incrementalMeanPBad(); // maybe we should use the *actual* pBad of *this* move?
     if (meanPBad <= 0 || myNan(meanPBad)) meanPBad = LOW_PBAD_LIMIT_FOR_CORES;
 
     coreScoreData.incChangeOp(peg, betterHole, pBad, meanPBad);
 #endif
 
+    if (profileThisIteration) {
+        sampledChanges++;
+        if (makeChange) acceptedSampledChanges++;
+    }
+
     if (makeChange) {
         A[peg] = newHole;
         actColToUnassignedG2Nodes[actColId][unassignedVecIndex] = oldHole;
         assignedNodesG2[oldHole] = false;
         assignedNodesG2[newHole] = true;
         aligEdges                     = newAligEdges;
-        edSum                         = newEdSum;
-        erSum                         = newErSum;
         inducedEdges                  = newInducedEdges;
         localScoreSum                 = newLocalScoreSum;
         wecSum                        = newWecSum;
         ewecSum                       = newEwecSum;
-        ncSum                         = newNcSum;
-        if (needLocal) localScoreSumMap = newLocalScoreSumMap;
+        incMeasures.commit();
         currentScore                  = newCurrentScore;
-        EdgeExposure::numer           = newExposedEdgesNumer;
+        exposedEdgesNumer           = newExposedEdgesNumer;
         squaredAligEdges              = newSquaredAligEdges;
-        MultiS3::numer                = newMS3Numer;
-    }
-    else if (needMS3) {
-        MultiS3::shadowDegree[oldHole] = saveOldHoleDeg;
-        MultiS3::shadowDegree[newHole] = saveNewHoleDeg;
-        MultiS3::denom = oldMs3Denom;
-        MultiS3::numer = oldMs3Numer;
+        MS3Numer                = newMS3Numer;
+        if (needWhichPeg) {
+            whichPeg[oldHole] = n1;
+            whichPeg[newHole] = peg;
+        }
+        if (topKMoveProb > 0) unassignedIndex[oldHole] = unassignedVecIndex;
+    } else {
+        incMeasures.rollback();
+        if (needMS3) {
+            shadowDegree[oldHole] = saveOldHoleDeg;
+            shadowDegree[newHole] = saveNewHoleDeg;
+            MS3Denom = oldMs3Denom;
+            MS3Numer = oldMs3Numer;
+        }
     }
 #if 0
     uint correct = ((MultiS3*)MC->getMeasure("ms3"))->computeNumer(A);
-    if(MultiS3::numer==correct)cerr<<'N';else{cerr<<"\nnumer "<<MultiS3::numer<<" off "<<(int)(MultiS3::numer-correct);MultiS3::numer=correct;}
+    if(MS3Numer==correct)cerr<<'N';else{cerr<<"\nnumer "<<MS3Numer<<" off "<<(int)(MS3Numer-correct);MS3Numer=correct;}
     correct = ((MultiS3*)MC->getMeasure("ms3"))->computeDenom(A);
-    if(MultiS3::denom==correct)cerr<<'D';else{cerr<<"\ndenom "<<MultiS3::denom<<" off "<<(int)(MultiS3::denom-correct);MultiS3::denom=correct;}
+    if(MS3Denom==correct)cerr<<'D';else{cerr<<"\ndenom "<<MS3Denom<<" off "<<(int)(MS3Denom-correct);MS3Denom=correct;}
 #endif
 }
 
-void SANA::performSwap(uint actColId) {
-    uint peg1 = randomG1NodeWithActiveColor(actColId);
-    
-    uint peg2;
-    for (uint i = 0; i < 100; i++) { //each attempt has >=50% chance of success
-        peg2 = randomG1NodeWithActiveColor(actColId);
-        if (peg1 != peg2) break;
-    }
-
+void SANA::performSwap(const Move& move) {
+    uint peg1 = move.peg1, peg2 = move.peg2;
     uint hole1 = A[peg1], hole2 = A[peg2];
     
     assert(peg1 != peg2);
@@ -608,41 +902,31 @@ void SANA::performSwap(uint actColId) {
     unsigned oldHole1Deg = 0, oldHole2Deg = 0, oldMs3Denom = 0;
 
     if (needMS3) {
-        oldHole1Deg = MultiS3::shadowDegree[hole1];
-        oldHole2Deg = MultiS3::shadowDegree[hole2];
-        oldMs3Denom = MultiS3::denom;
-    }
-
-    int newAligEdges           = (needAligEdges or needSec) ? aligEdges + aligEdgesIncSwapOp(peg1, peg2, hole1, hole2) : -1;
-    double newSquaredAligEdges = needSquaredAligEdges ? squaredAligEdges + squaredAligEdgesIncSwapOp(peg1, peg2, hole1, hole2) : -1;
-    double newExposedEdgesNumer= needExposedEdges ? EdgeExposure::numer + exposedEdgesIncSwapOp(peg1, peg2, hole1, hole2) : -1;
-    double newMS3Numer         = needMS3 ? MultiS3::numer + MS3IncSwapOp(peg1, peg2, hole1, hole2) : -1;
-    double newWecSum           = needWec ? wecSum + WECIncSwapOp(peg1, peg2, hole1, hole2) : -1;
-    double newJsSum            = needJs ? jsSum + JSIncSwapOp(peg1, peg2, hole1, hole2) : -1;
-    double newEwecSum          = needEwec ? ewecSum + EWECIncSwapOp(peg1, peg2, hole1, hole2) : -1;
-    double newNcSum            = needNC ? ncSum + ncIncSwapOp(peg1, peg2, hole1, hole2) : -1;
-    double newLocalScoreSum    = needLocal ? localScoreSum + localScoreSumIncSwapOp(sims, peg1, peg2, hole1, hole2) : -1;
-    double newEdSum            = needEd ? edSum + edgeDifferenceIncSwapOp(peg1, peg2, hole1, hole2) : -1;
-    double newErSum            = needEr ? erSum + edgeRatioIncSwapOp(peg1, peg2, hole1, hole2) : -1;
-
-    map<string, double> newLocalScoreSumMap;
-    if (needLocal) {
-        newLocalScoreSumMap = map<string, double>(localScoreSumMap);
-        for (auto &item : newLocalScoreSumMap)
-            item.second += localScoreSumIncSwapOp(localSimMatrixMap[item.first], peg1, peg2, hole1, hole2);
-    }
+        oldHole1Deg = shadowDegree[hole1];
+        oldHole2Deg = shadowDegree[hole2];
+        oldMs3Denom = MS3Denom;
+    }
+
+    int newAligEdges           = (needAligEdges or needSec) ? aligEdges + profiled(ALIG_EDGES_SWAP, [&]() { return aligEdgesIncSwapOp(peg1, peg2, hole1, hole2); }) : -1;
+    double newSquaredAligEdges = needSquaredAligEdges ? squaredAligEdges + profiled(SQUARED_ALIG_EDGES_SWAP, [&]() { return squaredAligEdgesIncSwapOp(peg1, peg2, hole1, hole2); }) : -1;
+    double newExposedEdgesNumer= needExposedEdges ? exposedEdgesNumer + profiled(EXPOSED_EDGES_SWAP, [&]() { return exposedEdgesIncSwapOp(peg1, peg2, hole1, hole2); }) : -1;
+    double newMS3Numer         = needMS3 ? MS3Numer + profiled(MS3_SWAP, [&]() { return MS3IncSwapOp(peg1, peg2, hole1, hole2); }) : -1;
+    double newWecSum           = needWec ? wecSum + profiled(WEC_SWAP, [&]() { return WECIncSwapOp(peg1, peg2, hole1, hole2); }) : -1;
+    double newEwecSum          = needEwec ? ewecSum + profiled(EWEC_SWAP, [&]() { return EWECIncSwapOp(peg1, peg2, hole1, hole2); }) : -1;
+    double newLocalScoreSum    = needLocal ? localScoreSum + profiled(LOCAL_SCORE_SUM_SWAP, [&]() { return aggregatedLocalScoreSumIncSwapOp(peg1, peg2, hole1, hole2); }) : -1;
+    incMeasures.proposeSwap(A, peg1, peg2, hole1, hole2,
+            profileThisIteration ? &deltaTicks[NUM_DELTA_FUNCTIONS + IncrementalMeasures::SIZE] : nullptr,
+            profileThisIteration ? &deltaSamples[NUM_DELTA_FUNCTIONS + IncrementalMeasures::SIZE] : nullptr);
 
     double newCurrentScore = 0;
-    double pBad = scoreComparison(newAligEdges, inducedEdges, newLocalScoreSum,
-                newWecSum, newJsSum, newNcSum, newCurrentScore, newEwecSum, newSquaredAligEdges,
-                newExposedEdgesNumer, newMS3Numer, newEdSum, newErSum);
-    bool makeChange;
-    //if(newCurrentScore == currentScore) makeChange = false; else // if it ain't broke, don't fix it
-    makeChange = randomReal(gen) < pBad;
+    bool makeChange = scoreComparison(newAligEdges, inducedEdges, newLocalScoreSum,
+                newWecSum, newCurrentScore, newEwecSum, newSquaredAligEdges,
+                newExposedEdgesNumer, newMS3Numer);
 
 #ifdef CORES
         // Statistics on the emerging core alignment.
         // only update pBad if it's nonzero; reuse previous nonzero pBad if the current one is zero.
+        double pBad = acceptingProbability(energyInc, Temperature);
         double meanPBad = incrementalMeanPBad(); // maybe we should use the *actual* pBad of *this* move?
         if (meanPBad <= 0 || myNan(meanPBad)) meanPBad = LOW_PBAD_LIMIT_FOR_CORES;
 
@@ -652,56 +936,62 @@ void SANA::performSwap(uint actColId) {
         coreScoreData.incSwapOp(peg1, peg2, betterDest1, betterDest2, pBad, meanPBad);
 #endif
 
+    if (profileThisIteration) {
+        sampledSwaps++;
+        if (makeChange) acceptedSampledSwaps++;
+    }
+
     if (makeChange) {
         A[peg1]          = hole2;
         A[peg2]          = hole1;
         aligEdges           = newAligEdges;
-        edSum               = newEdSum;
-        erSum               = newErSum;
         localScoreSum       = newLocalScoreSum;
         wecSum              = newWecSum;
         ewecSum             = newEwecSum;
-        ncSum               = newNcSum;
+        incMeasures.commit();
         currentScore        = newCurrentScore;
         squaredAligEdges    = newSquaredAligEdges;
-        EdgeExposure::numer = newExposedEdgesNumer;
-        MultiS3::numer      = newMS3Numer;
-        if (needLocal) localScoreSumMap = newLocalScoreSumMap;
-    } else if (needMS3) {
-        MultiS3::shadowDegree[hole1] = oldHole1Deg;
-        MultiS3::shadowDegree[hole2] = oldHole2Deg;
-        MultiS3::denom = oldMs3Denom;
+        exposedEdgesNumer = newExposedEdgesNumer;
+        MS3Numer      = newMS3Numer;
+        if (needWhichPeg) {
+            whichPeg[hole1] = peg2;
+            whichPeg[hole2] = peg1;
+        }
+    } else {
+        incMeasures.rollback();
+        if (needMS3) {
+            shadowDegree[hole1] = oldHole1Deg;
+            shadowDegree[hole2] = oldHole2Deg;
+            MS3Denom = oldMs3Denom;
+        }
     }
 }
 
-// returns pBad
-double SANA::scoreComparison(double newAligEdges, double newInducedEdges,
-        double newLocalScoreSum, double newWecSum, double newJsSum, double newNcSum, double& newCurrentScore,
-        double newEwecSum, double newSquaredAligEdges, double newExposedEdgesNumer, double newMS3Numer,
-        double newEdgeDifferenceSum, double newEdgeRatioSum) {
+// returns whether the move is accepted
+bool SANA::scoreComparison(double newAligEdges, double newInducedEdges,
+        double newLocalScoreSum, double newWecSum, double& newCurrentScore,
+        double newEwecSum, double newSquaredAligEdges, double newExposedEdgesNumer, double newMS3Numer) {
     wasBadMove = false;
-    double pBad = 0;
 
     switch (scoreAggr) {
     case ScoreAggregation::sum:
     {
         newCurrentScore += ecWeight * (newAligEdges / g1Edges);
-        newCurrentScore += edWeight * EdgeDifference::adjustSumToTargetScore(newEdgeDifferenceSum, pairsCount);
-        newCurrentScore += erWeight * EdgeRatio::adjustSumToTargetScore(newEdgeRatioSum, pairsCount);
         newCurrentScore += s3Weight * (newAligEdges / (g1Edges + newInducedEdges - newAligEdges));
         newCurrentScore += icsWeight * (newAligEdges / newInducedEdges);
         newCurrentScore += secWeight * (newAligEdges / g1Edges + newAligEdges / g2Edges)*0.5;
         newCurrentScore += localWeight * (newLocalScoreSum / n1);
         newCurrentScore += wecWeight * (newWecSum / (2 * g1Edges));
-        newCurrentScore += jsWeight * (newJsSum);
         newCurrentScore += ewecWeight * (newEwecSum);
-        newCurrentScore += ncWeight * (newNcSum / trueAWithValidCountAppended.back());
+        incMeasures.forEachUsed([&](NonSumAggregation, double weight, double, double newScore) {
+            newCurrentScore += weight * newScore;
+        });
 #ifdef MULTI_PAIRWISE
         newCurrentScore += mecWeight * (newAligEdges / (g1TotalWeight + g2TotalWeight));
         newCurrentScore += sesWeight * newSquaredAligEdges / (double)SquaredEdgeScore::getDenom();
         newCurrentScore += eeWeight * (1 - (newExposedEdgesNumer / (double)EdgeExposure::denom));
-         if (MultiS3::denominator_type==MultiS3::ee_global) MultiS3::denom = newExposedEdgesNumer;
-        newCurrentScore += ms3Weight * (double)newMS3Numer / (double)MultiS3::denom / (double)MultiS3::Normalization_factor;//(double)NUM_GRAPHS;
+         if (MultiS3::denominator_type==MultiS3::ee_global) MS3Denom = newExposedEdgesNumer;
+        newCurrentScore += ms3Weight * (double)newMS3Numer / (double)MS3Denom / (double)MS3NormalizationFactor;//(double)NUM_GRAPHS;
 #endif
         energyInc = newCurrentScore - currentScore;
         wasBadMove = energyInc < 0;
@@ -716,8 +1006,10 @@ double SANA::scoreComparison(double newAligEdges, double newInducedEdges,
         newCurrentScore *= localWeight * (newLocalScoreSum / n1);
         newCurrentScore *= secWeight * (newAligEdges / g1Edges + newAligEdges / g2Edges)*0.5;
         newCurrentScore *= wecWeight * (newWecSum / (2 * g1Edges));
-        newCurrentScore += jsWeight * (newJsSum);
-        newCurrentScore *= ncWeight * (newNcSum / trueAWithValidCountAppended.back());
+        incMeasures.forEachUsed([&](NonSumAggregation aggregation, double weight, double, double newScore) {
+            if (aggregation == NonSumAggregation::FACTOR) newCurrentScore *= weight * newScore;
+            else if (aggregation == NonSumAggregation::ADDITIVE) newCurrentScore += weight * newScore;
+        });
         energyInc = newCurrentScore - currentScore;
         wasBadMove = energyInc < 0;
         break;
@@ -727,11 +1019,15 @@ double SANA::scoreComparison(double newAligEdges, double newInducedEdges,
         // this is a terrible way to compute the max; we should loop through all of them and figure out which is the biggest
         // and in fact we haven't yet integrated icsWeight here yet, so assert so
         assert(icsWeight == 0.0);
-        double energyInc = max(ncWeight* (newNcSum / trueAWithValidCountAppended.back() - ncSum / trueAWithValidCountAppended.back()), max(max(ecWeight*(newAligEdges / g1Edges - aligEdges / g1Edges), max(
+        double energyInc = max(max(ecWeight*(newAligEdges / g1Edges - aligEdges / g1Edges), max(
             s3Weight*((newAligEdges / (g1Edges + newInducedEdges - newAligEdges) - (aligEdges / (g1Edges + inducedEdges - aligEdges)))),
             secWeight*0.5*(newAligEdges / g1Edges - aligEdges / g1Edges + newAligEdges / g2Edges - aligEdges / g2Edges))),
             max(localWeight*((newLocalScoreSum / n1) - (localScoreSum)),
-            max(wecWeight*(newWecSum / (2 * g1Edges) - wecSum / (2 * g1Edges)), jsWeight*(newJsSum - jsSum)))));
+            wecWeight*(newWecSum / (2 * g1Edges) - wecSum / (2 * g1Edges))));
+        incMeasures.forEachUsed([&](NonSumAggregation aggregation, double weight, double score, double newScore) {
+            if (aggregation == NonSumAggregation::SUM_ONLY) return;
+            energyInc = max(energyInc, weight * (newScore - score));
+        });
 
         newCurrentScore += ecWeight * (newAligEdges / g1Edges);
         newCurrentScore += secWeight * (newAligEdges / g1Edges + newAligEdges / g2Edges)*0.5;
@@ -739,8 +1035,9 @@ double SANA::scoreComparison(double newAligEdges, double newInducedEdges,
         newCurrentScore += icsWeight * (newAligEdges / newInducedEdges);
         newCurrentScore += localWeight * (newLocalScoreSum / n1);
         newCurrentScore += wecWeight * (newWecSum / (2 * g1Edges));
-        newCurrentScore += jsWeight * (newJsSum);
-        newCurrentScore += ncWeight * (newNcSum / trueAWithValidCountAppended.back());
+        incMeasures.forEachUsed([&](NonSumAggregation aggregation, double weight, double, double newScore) {
+            if (aggregation != NonSumAggregation::SUM_ONLY) newCurrentScore += weight * newScore;
+        });
 
         energyInc = newCurrentScore - currentScore;
         wasBadMove = energyInc < 0;
@@ -750,11 +1047,15 @@ double SANA::scoreComparison(double newAligEdges, double newInducedEdges,
     {
         // see comment above in max
         assert(icsWeight == 0.0);
-        double energyInc = min(ncWeight* (newNcSum / trueAWithValidCountAppended.back() - ncSum / trueAWithValidCountAppended.back()), min(min(ecWeight*(newAligEdges / g1Edges - aligEdges / g1Edges), min(
+        double energyInc = min(min(ecWeight*(newAligEdges / g1Edges - aligEdges / g1Edges), min(
             s3Weight*((newAligEdges / (g1Edges + newInducedEdges - newAligEdges) - (aligEdges / (g1Edges + inducedEdges - aligEdges)))),
             secWeight*0.5*(newAligEdges / g1Edges - aligEdges / g1Edges + newAligEdges / g2Edges - aligEdges / g2Edges))),
             min(localWeight*((newLocalScoreSum / n1) - (localScoreSum)),
-            min(wecWeight*(newWecSum / (2 * g1Edges) - wecSum / (2 * g1Edges)), jsWeight*(newJsSum - jsSum)))));
+            wecWeight*(newWecSum / (2 * g1Edges) - wecSum / (2 * g1Edges))));
+        incMeasures.forEachUsed([&](NonSumAggregation aggregation, double weight, double score, double newScore) {
+            if (aggregation == NonSumAggregation::SUM_ONLY) return;
+            energyInc = min(energyInc, weight * (newScore - score));
+        });
 
         newCurrentScore += ecWeight * (newAligEdges / g1Edges);
         newCurrentScore += s3Weight * (newAligEdges / (g1Edges + newInducedEdges - newAligEdges));
@@ -762,8 +1063,9 @@ double SANA::scoreComparison(double newAligEdges, double newInducedEdges,
         newCurrentScore += secWeight * (newAligEdges / g1Edges + newAligEdges / g2Edges)*0.5;
         newCurrentScore += localWeight * (newLocalScoreSum / n1);
         newCurrentScore += wecWeight * (newWecSum / (2 * g1Edges));
-        newCurrentScore += jsWeight * (newJsSum);
-        newCurrentScore += ncWeight * (newNcSum / trueAWithValidCountAppended.back());
+        incMeasures.forEachUsed([&](NonSumAggregation aggregation, double weight, double, double newScore) {
+            if (aggregation != NonSumAggregation::SUM_ONLY) newCurrentScore += weight * newScore;
+        });
 
         energyInc = newCurrentScore - currentScore; //is this even used?
         wasBadMove = energyInc < 0;
@@ -777,8 +1079,10 @@ double SANA::scoreComparison(double newAligEdges, double newInducedEdges,
         newCurrentScore += icsWeight / (newAligEdges / newInducedEdges);
         newCurrentScore += localWeight / (newLocalScoreSum / n1);
         newCurrentScore += wecWeight / (newWecSum / (2 * g1Edges));
-        newCurrentScore += jsWeight * (newJsSum);
-        newCurrentScore += ncWeight / (newNcSum / trueAWithValidCountAppended.back());
+        incMeasures.forEachUsed([&](NonSumAggregation aggregation, double weight, double, double newScore) {
+            if (aggregation == NonSumAggregation::FACTOR) newCurrentScore += weight / newScore;
+            else if (aggregation == NonSumAggregation::ADDITIVE) newCurrentScore += weight * newScore;
+        });
 
         energyInc = newCurrentScore - currentScore;
         wasBadMove = energyInc < 0;
@@ -787,17 +1091,22 @@ double SANA::scoreComparison(double newAligEdges, double newInducedEdges,
     case ScoreAggregation::maxFactor:
     {
         assert(icsWeight == 0.0);
-        double maxScore = max(ncWeight*(newNcSum / trueAWithValidCountAppended.back() - ncSum / trueAWithValidCountAppended.back()), max(max(ecWeight*(newAligEdges / g1Edges - aligEdges / g1Edges), max(
+        double maxScore = max(max(ecWeight*(newAligEdges / g1Edges - aligEdges / g1Edges), max(
             s3Weight*((newAligEdges / (g1Edges + newInducedEdges - newAligEdges) - (aligEdges / (g1Edges + inducedEdges - aligEdges)))),
             secWeight*0.5*(newAligEdges / g1Edges - aligEdges / g1Edges + newAligEdges / g2Edges - aligEdges / g2Edges))),
             max(localWeight*((newLocalScoreSum / n1) - (localScoreSum)),
-            max(wecWeight*(newWecSum / (2 * g1Edges) - wecSum / (2 * g1Edges)), jsWeight*(newJsSum - jsSum)))));
+            wecWeight*(newWecSum / (2 * g1Edges) - wecSum / (2 * g1Edges))));
 
-        double minScore = min(ncWeight*(newNcSum / trueAWithValidCountAppended.back() - ncSum / trueAWithValidCountAppended.back()), min(min(ecWeight*(newAligEdges / g1Edges - aligEdges / g1Edges), min(
+        double minScore = min(min(ecWeight*(newAligEdges / g1Edges - aligEdges / g1Edges), min(
             s3Weight*((newAligEdges / (g1Edges + newInducedEdges - newAligEdges) - (aligEdges / (g1Edges + inducedEdges - aligEdges)))),
             secWeight*0.5*(newAligEdges / g1Edges - aligEdges / g1Edges + newAligEdges / g2Edges - aligEdges / g2Edges))),
             min(localWeight*((newLocalScoreSum / n1) - (localScoreSum)),
-            min(wecWeight*(newWecSum / (2 * g1Edges) - wecSum / (2 * g1Edges)), jsWeight*(newJsSum - jsSum)))));
+            wecWeight*(newWecSum / (2 * g1Edges) - wecSum / (2 * g1Edges))));
+        incMeasures.forEachUsed([&](NonSumAggregation aggregation, double weight, double score, double newScore) {
+            if (aggregation == NonSumAggregation::SUM_ONLY) return;
+            maxScore = max(maxScore, weight * (newScore - score));
+            minScore = min(minScore, weight * (newScore - score));
+        });
 
         newCurrentScore += ecWeight * (newAligEdges / g1Edges);
         newCurrentScore += secWeight * (newAligEdges / g1Edges + newAligEdges / g2Edges)*0.5;
@@ -805,24 +1114,28 @@ double SANA::scoreComparison(double newAligEdges, double newInducedEdges,
         newCurrentScore += icsWeight * (newAligEdges / newInducedEdges);
         newCurrentScore += localWeight * (newLocalScoreSum / n1);
         newCurrentScore += wecWeight * (newWecSum / (2 * g1Edges));
-        newCurrentScore += jsWeight * (newJsSum);
-        newCurrentScore += ncWeight * (newNcSum / trueAWithValidCountAppended.back());
+        incMeasures.forEachUsed([&](NonSumAggregation aggregation, double weight, double, double newScore) {
+            if (aggregation != NonSumAggregation::SUM_ONLY) newCurrentScore += weight * newScore;
+        });
 
         energyInc = newCurrentScore - currentScore;
         wasBadMove = maxScore < -1 * minScore;
         break;
     }
     }
-    //using max and min here because with extremely low temps I was seeing invalid probabilities
-    //note: I did not make this change for the other types of ScoreAggregation::  -Nil
-    //note2: I moved it down here to apply to all ScoreAggregation methods - WH
-    if (energyInc >= 0) pBad = 1.0;
-    else pBad = max(0.0, min(1.0, exp(energyInc / Temperature)));
-
     //if (wasBadMove && (iterationsPerformed % 512 == 0 || (iterationsPerformed % 32 == 0))) 
     //the above will never be true in the case of iterationsPerformed never being changed so that it doesn't greatly
     // slow down the program if for some reason iterationsPerformed doesn't need to be changed.
-    if (wasBadMove) { // I think Dillon was wrong above, just do it always - WH
+    // I think Dillon was wrong above, just do it always - WH
+    //the acceptance test does not need pBad, so it is only computed for the moves sampled into the buffer
+    if (wasBadMove and ++badMovesSinceLastSample >= pBadSampleInterval) {
+        badMovesSinceLastSample = 0;
+        //using max and min here because with extremely low temps I was seeing invalid probabilities
+        //note: I did not make this change for the other types of ScoreAggregation::  -Nil
+        //note2: I moved it down here to apply to all ScoreAggregation methods - WH
+        double pBad;
+        if (energyInc >= 0) pBad = 1.0;
+        else pBad = max(0.0, min(1.0, exp(energyInc / Temperature)));
         if (numPBadsInBuffer == PBAD_CIRCULAR_BUFFER_SIZE) {
             pBadBufferIndex = (pBadBufferIndex == PBAD_CIRCULAR_BUFFER_SIZE ? 0 : pBadBufferIndex);
             pBadBufferSum -= pBadBuffer[pBadBufferIndex];
@@ -833,30 +1146,98 @@ double SANA::scoreComparison(double newAligEdges, double newInducedEdges,
         }
         pBadBufferSum += pBad;
         pBadBufferIndex++;
+        numPBadsSampled++;
     }
-    return pBad;
+    return acceptMove(energyInc, Temperature);
 }
 
-int SANA::aligEdgesIncChangeOp(uint peg, uint oldHole, uint newHole) {
-    int res = 0;
-    if (G1->hasSelfLoop(peg)) {
-        if (G2->hasSelfLoop(oldHole)) res-=G2->getEdgeWeight(oldHole, oldHole);
-        if (G2->hasSelfLoop(newHole)) res+=G2->getEdgeWeight(newHole, newHole);
-    }
+template<bool EC, bool WEC, bool HOOKS, bool EWEC>
+SANA::NeighborhoodDeltas SANA::neighborhoodIncChangeOp(uint peg, uint oldHole, uint newHole) {
+    int aligEdgesInc = 0;
+    double wecInc = 0, ewecOldSum = 0, ewecNewSum = 0;
+    if (HOOKS) incMeasures.beginNeighborhoodChange(peg);
     for (uint nbr : G1->adjLists[peg]) {
-        if (nbr != peg) {
-            res -= G2->getEdgeWeight(oldHole, A[nbr]);
-            res += G2->getEdgeWeight(newHole, A[nbr]);
+        uint nbrHole = A[nbr];
+        EDGE_T oldWeight = G2->getEdgeWeight(oldHole, nbrHole);
+        EDGE_T newWeight = G2->getEdgeWeight(newHole, nbrHole);
+        if (EC and nbr != peg) { //self-loops are handled below
+            aligEdgesInc -= oldWeight;
+            aligEdgesInc += newWeight;
         }
+        if (WEC) {
+            if (oldWeight) {
+                wecInc -= wecSim(peg, oldHole);
+                wecInc -= wecSim(nbr, nbrHole);
+            }
+            if (newWeight) {
+                wecInc += wecSim(peg, newHole);
+                wecInc += wecSim(nbr, nbrHole);
+            }
+        }
+        if (EWEC) {
+            if (oldWeight) ewecOldSum += ewec->getScore(ewec->getColIndex(oldHole, nbrHole), ewec->getRowIndex(peg, nbr));
+            if (newWeight) ewecNewSum += ewec->getScore(ewec->getColIndex(newHole, nbrHole), ewec->getRowIndex(peg, nbr));
+        }
+        if (HOOKS) incMeasures.neighborChange(peg, nbr, oldWeight, newWeight);
+    }
+    if (HOOKS) incMeasures.endNeighborhoodChange(peg, oldHole, newHole);
+
+    NeighborhoodDeltas deltas = {0, 0, 0};
+    if (EC) {
+        if (G1->hasSelfLoop(peg)) {
+            if (G2->hasSelfLoop(oldHole)) aligEdgesInc -= G2->getEdgeWeight(oldHole, oldHole);
+            if (G2->hasSelfLoop(newHole)) aligEdgesInc += G2->getEdgeWeight(newHole, newHole);
+        }
+        deltas.aligEdges = aligEdgesInc;
     }
+    if (WEC) deltas.wec = wecInc;
+    if (EWEC) deltas.ewec = ewecNewSum/(2*g1Edges) - ewecOldSum/(2*g1Edges);
+    return deltas;
+}
+
+template<bool... Enabled, typename... Bools>
+SANA::NeighborhoodChangeOp SANA::selectNeighborhoodChangeOp(bool enabled, Bools... rest) {
+    if (enabled) return selectNeighborhoodChangeOp<Enabled..., true>(rest...);
+    return selectNeighborhoodChangeOp<Enabled..., false>(rest...);
+}
+
+template<bool... Enabled>
+SANA::NeighborhoodChangeOp SANA::selectNeighborhoodChangeOp() {
+    return &SANA::neighborhoodIncChangeOp<Enabled...>;
+}
+
+int SANA::aligEdgesBitRowsDifference(uint peg, uint oldHole, uint newHole) {
+    const vector<uint>& nbrs = G1->adjLists[peg];
+    int res = rowBitDifference(g2BitRows->row(oldHole), g2BitRows->row(newHole), nbrs.data(), nbrs.size(), A.data());
+    //the self-loop of the peg, if any, is in its adjacency list but is not one of the edges counted here
+    if (G1->hasSelfLoop(peg)) res -= (int) g2BitRows->get(newHole, A[peg]) - (int) g2BitRows->get(oldHole, A[peg]);
     return res;
 }
 
+SANA::NeighborhoodDeltas SANA::aligEdgesBitRowsChangeOp(uint peg, uint oldHole, uint newHole) {
+    int aligEdgesInc = aligEdgesBitRowsDifference(peg, oldHole, newHole);
+    if (G1->hasSelfLoop(peg)) {
+        if (G2->hasSelfLoop(oldHole)) aligEdgesInc--;
+        if (G2->hasSelfLoop(newHole)) aligEdgesInc++;
+    }
+    NeighborhoodDeltas deltas = {aligEdgesInc, 0, 0};
+    return deltas;
+}
+
 int SANA::aligEdgesIncSwapOp(uint peg1, uint peg2, uint hole1, uint hole2) {
 #ifdef FLOAT_WEIGHTS
     return 0; //not applicable
 #else
     int res = 0;
+    if (g2BitRows) {
+        //g2BitRows is only set for unweighted graphs, where each edge weighs 1
+        if (G1->hasSelfLoop(peg1)) res += (int) G2->hasSelfLoop(hole2) - (int) G2->hasSelfLoop(hole1);
+        if (G1->hasSelfLoop(peg2)) res += (int) G2->hasSelfLoop(hole1) - (int) G2->hasSelfLoop(hole2);
+        res += aligEdgesBitRowsDifference(peg1, hole1, hole2);
+        res += aligEdgesBitRowsDifference(peg2, hole2, hole1);
+        if (G1->hasEdge(peg1, peg2) and G2->hasEdge(hole1, hole2)) res += 2;
+        return res;
+    }
     if (G1->hasSelfLoop(peg1)) {
         if (G2->hasSelfLoop(hole1)) res-=G2->getEdgeWeight(hole1, hole1);
         if (G2->hasSelfLoop(hole2)) res+=G2->getEdgeWeight(hole2, hole2);
@@ -891,141 +1272,6 @@ int SANA::aligEdgesIncSwapOp(uint peg1, uint peg2, uint hole1, uint hole2) {
 #endif // FLOAT_WEIGHTS
 }
 
-static double getRatio(double w1, double w2) {
-    double r;
-    if (w1==0 && w2==0) r=1;
-    else if (abs(w1)<abs(w2)) r=w1/w2;
-    else r=w2/w1;
-    // At this point, r can be in [-1,1], but we want it [0,1], so add 1 and divide by 2
-    r = (r+1)/2;
-    assert(r>=0 && r<=1);
-    return r;
-}
-
-/* We swap the mapping of two nodes peg1 and peg2
- * We can first handle peg1, then do the same with peg2
- * Subtract old edge difference with edge (peg1, hole1)
- * Add new edge difference with edge (peg1, hole2) */
-double SANA::edgeDifferenceIncSwapOp(uint peg1, uint peg2, uint hole1, uint hole2) {
-    if (peg1 == peg2) return 0;
-    // Handle peg1
-    double edgeDifferenceIncDiff = 0;
-    double c = 0;
-    for (uint node2 : G1->adjLists[peg1]) {
-        double y = -abs(G1->getEdgeWeight(peg1, node2) - G2->getEdgeWeight(hole1, A[node2])) - c;
-        double t = edgeDifferenceIncDiff + y;
-        c = (t - edgeDifferenceIncDiff) - y;
-        edgeDifferenceIncDiff = t;
-
-        // Determine the new target hole for node2
-        uint node2Hole = 0;
-        if (node2 == peg1) node2Hole = hole2;
-        else if (node2 == peg2) node2Hole = hole1;
-        else node2Hole = A[node2];
-
-        y = +abs(G1->getEdgeWeight(peg1, node2) - G2->getEdgeWeight(hole2, node2Hole)) - c;
-        t = edgeDifferenceIncDiff + y;
-        c = (t - edgeDifferenceIncDiff) - y;
-        edgeDifferenceIncDiff = t;
-    }
-    // Handle peg2
-    for (uint node2 : G1->adjLists[peg2]) {
-        if (node2 == peg1) continue;
-        double y = -abs(G1->getEdgeWeight(peg2, node2) - G2->getEdgeWeight(hole2, A[node2])) - c;
-        double t = edgeDifferenceIncDiff + y;
-        c = (t - edgeDifferenceIncDiff) - y;
-        edgeDifferenceIncDiff = t;
-
-        uint node2Hole = (node2 == peg2 ? hole1 : A[node2]);
-        y = +abs(G1->getEdgeWeight(peg2, node2) - G2->getEdgeWeight(hole1, node2Hole)) - c;
-        t = edgeDifferenceIncDiff + y;
-        c = (t - edgeDifferenceIncDiff) - y;
-        edgeDifferenceIncDiff = t;
-    }
-    return edgeDifferenceIncDiff;
-}
-
-double SANA::edgeRatioIncSwapOp(uint peg1, uint peg2, uint hole1, uint hole2) {
-    if (peg1 == peg2) return 0;
-    double edgeRatioIncDiff = 0;
-    double c = 0;
-    // Subtract peg1-hole1, add peg1-hole2
-    for (uint node2 : G1->adjLists[peg1]) {
-        double r = getRatio(G1->getEdgeWeight(peg1, node2), G2->getEdgeWeight(hole1, A[node2]));
-        double y = -r - c;
-        double t = edgeRatioIncDiff + y;
-        c = (t - edgeRatioIncDiff) - y;
-        edgeRatioIncDiff = t;
-
-        uint node2Hole = 0;
-        if (node2 == peg1) node2Hole = hole2;
-        else if (node2 == peg2) node2Hole = hole1;
-        else node2Hole = A[node2];
-
-        r = getRatio(G1->getEdgeWeight(peg1, node2), G2->getEdgeWeight(hole2, node2Hole));
-        y = r - c;
-        t = edgeRatioIncDiff + y;
-        c = (t - edgeRatioIncDiff) - y;
-        edgeRatioIncDiff = t;
-    }
-   // Subtract peg2-hole2, add peg2-hole1
-   for (uint node2 : G1->adjLists[peg2]) {
-        if (node2 == peg1) continue;
-        double r = getRatio(G1->getEdgeWeight(peg2, node2), G2->getEdgeWeight(hole2, A[node2]));
-        double y = -r - c;
-        double t = edgeRatioIncDiff + y;
-        c = (t - edgeRatioIncDiff) - y;
-        edgeRatioIncDiff = t;
-
-        uint node2Hole = (node2 == peg2 ? hole1 : A[node2]);
-        r = getRatio(G1->getEdgeWeight(peg2, node2), G2->getEdgeWeight(hole1, node2Hole));
-        y = r - c;
-        t = edgeRatioIncDiff + y;
-        c = (t - edgeRatioIncDiff) - y;
-        edgeRatioIncDiff = t;
-    }
-    return edgeRatioIncDiff;
-}
-
-
-double SANA::edgeDifferenceIncChangeOp(uint peg, uint oldHole, uint newHole) {
-    double edgeDifferenceIncDiff = 0;
-    double c = 0;
-    for (uint node2 : G1->adjLists[peg]) {
-        double y = -abs(G1->getEdgeWeight(peg, node2) - G2->getEdgeWeight(oldHole, A[node2])) - c;
-        double t = edgeDifferenceIncDiff + y;
-        c = (t - edgeDifferenceIncDiff) - y;
-        edgeDifferenceIncDiff = t;
-
-        uint node2Hole = node2 == peg ? newHole : A[node2];
-        y = +abs(G1->getEdgeWeight(peg, node2) - G2->getEdgeWeight(newHole, node2Hole)) - c;
-        t = edgeDifferenceIncDiff + y;
-        c = (t - edgeDifferenceIncDiff) - y;
-        edgeDifferenceIncDiff = t;
-    }
-    return edgeDifferenceIncDiff;
-}
-
-double SANA::edgeRatioIncChangeOp(uint peg, uint oldHole, uint newHole) {
-    double edgeRatioIncDiff = 0;
-    double c = 0;
-    for (uint node2 : G1->adjLists[peg]) {
-        double r = getRatio(G1->getEdgeWeight(peg, node2), G2->getEdgeWeight(oldHole, A[node2]));
-        double y = -r - c;
-        double t = edgeRatioIncDiff + y;
-        c = (t - edgeRatioIncDiff) - y;
-        edgeRatioIncDiff = t;
-
-        uint node2Hole = node2 == peg ? newHole : A[node2];
-        r = getRatio(G1->getEdgeWeight(peg, node2), G2->getEdgeWeight(newHole, node2Hole));
-        y = r - c;
-        t = edgeRatioIncDiff + y;
-        c = (t - edgeRatioIncDiff) - y;
-        edgeRatioIncDiff = t;
-    }
-    return edgeRatioIncDiff;
-}
-
 // UGLY GORY HACK BELOW!! Sometimes the edgeVal is crazily wrong, like way above 1,000, when it
 // cannot possibly be greater than the number of networks we're aligning when MULTI_PAIRWISE is on.
 // It happens only rarely, so here I ask if the edgeVal is less than 1,000; if it's less than 1,000
@@ -1173,8 +1419,8 @@ int SANA::MS3IncChangeOp(uint peg, uint oldHole, uint newHole) {
             
         default:
         {
-            //unsigned oldoldHoleDeg = MultiS3::shadowDegree[oldHole];
-            //unsigned oldnewHoleDeg = MultiS3::shadowDegree[newHole];
+            //unsigned oldoldHoleDeg = shadowDegree[oldHole];
+            //unsigned oldnewHoleDeg = shadowDegree[newHole];
 
             if (G1->hasSelfLoop(peg)) {
                 if (G2->hasSelfLoop(oldHole)) --res;
@@ -1182,8 +1428,8 @@ int SANA::MS3IncChangeOp(uint peg, uint oldHole, uint newHole) {
             }
             for (uint nbr : G1->adjLists[peg]) {
                 if (nbr != peg) {
-                    --MultiS3::shadowDegree[oldHole];
-                    ++MultiS3::shadowDegree[newHole];
+                    --shadowDegree[oldHole];
+                    ++shadowDegree[newHole];
                     res -= G2->getEdgeWeight(oldHole, A[nbr]);
                     res += G2->getEdgeWeight(newHole, A[nbr]);
                 }
@@ -1193,16 +1439,6 @@ int SANA::MS3IncChangeOp(uint peg, uint oldHole, uint newHole) {
     }
 
     const uint n1 = G1->getNumNodes();
-    const uint n2 = G2->getNumNodes();
-    vector<uint> whichPeg(n2, n1); // value of n1 represents not used
-    for (uint i = 0; i < n1; ++i){
-	// inverse of the alignment--but this is stupidly EXPENSIVE to do for every proposed move!
-	// Instead, we should have an inverse alignment stored simultaneously, and have it updated
-	// either explicitly or automatically using overload of the array operator. There is also
-	// a reverse() member function but that'll be equally expensive. It should be stored and
-	// incrementally updated and checked periodically just like we check incremental scores.
-	whichPeg[A[i]] = i;
-    }
     assert(whichPeg[newHole] == n1); // hole should be empty
 
     switch (MultiS3::denominator_type) {
@@ -1214,7 +1450,7 @@ int SANA::MS3IncChangeOp(uint peg, uint oldHole, uint newHole) {
                 holeNeigh = G2->adjLists[oldHole][i];
                 if (whichPeg[holeNeigh]<n1) {
 		    assert(holeNeigh != newHole); // the new hole should be empty!
-                    MultiS3::denom -= G2->getEdgeWeight(oldHole,holeNeigh);
+                    MS3Denom -= G2->getEdgeWeight(oldHole,holeNeigh);
 		}
             }
 	    numNeigh = G2->adjLists[newHole].size();
@@ -1222,7 +1458,7 @@ int SANA::MS3IncChangeOp(uint peg, uint oldHole, uint newHole) {
 		holeNeigh = G2->adjLists[newHole][i];
 		if (whichPeg[holeNeigh]<n1) {
 		    if(holeNeigh == oldHole) assert(whichPeg[oldHole] == peg);
-		    else MultiS3::denom += G2->getEdgeWeight(newHole,holeNeigh);
+		    else MS3Denom += G2->getEdgeWeight(newHole,holeNeigh);
 		}
 	    }
 	}
@@ -1234,24 +1470,24 @@ int SANA::MS3IncChangeOp(uint peg, uint oldHole, uint newHole) {
             for (uint i =0; i < numNeigh; i++){
                 holeNeigh = G2->adjLists[oldHole][i];
                 if (whichPeg[holeNeigh]<n1){
-                    MultiS3::denom--;
+                    MS3Denom--;
                 }
             }
             numNeigh = G1->adjLists[peg].size();
             for (uint i =0; i < numNeigh; i++){
                 pegNeigh = G1->adjLists[peg][i];
                 if (!G2->getEdgeWeight(A[pegNeigh],oldHole)){
-                    MultiS3::denom--;
+                    MS3Denom--;
                 }
                 if (A[pegNeigh]!=newHole and !G2->getEdgeWeight(A[pegNeigh],newHole)){
-                    MultiS3::denom++;
+                    MS3Denom++;
                 }
             }
             numNeigh = G2->adjLists[newHole].size();
             for (uint i =0; i < numNeigh; i++){
                 holeNeigh = G2->adjLists[newHole][i];
                 if (whichPeg[holeNeigh]<n1 and peg!=whichPeg[holeNeigh] ){
-                    MultiS3::denom++;
+                    MS3Denom++;
                 }
             }
         }
@@ -1260,31 +1496,31 @@ int SANA::MS3IncChangeOp(uint peg, uint oldHole, uint newHole) {
         default:
 	{
 #if 0
-	    if (oldoldHoleDeg > 0 and !MultiS3::shadowDegree[oldHole]) MultiS3::denom -= 1;
-            if (oldnewHoleDeg > 0 and !MultiS3::shadowDegree[newHole]) MultiS3::denom += 1;
+	    if (oldoldHoleDeg > 0 and !shadowDegree[oldHole]) MS3Denom -= 1;
+            if (oldnewHoleDeg > 0 and !shadowDegree[newHole]) MS3Denom += 1;
 #else
             uint numNeigh = G2->adjLists[oldHole].size();
             for (uint i =0; i < numNeigh; i++){
                 holeNeigh = G2->adjLists[oldHole][i];
                 if (whichPeg[holeNeigh]<n1){
-                    MultiS3::denom--;
+                    MS3Denom--;
                 }
             }
             numNeigh = G1->adjLists[peg].size();
             for (uint i =0; i < numNeigh; i++){
                 pegNeigh = G1->adjLists[peg][i];
                 if (!G2->getEdgeWeight(A[pegNeigh],oldHole)){
-                    MultiS3::denom--;
+                    MS3Denom--;
                 }
                 if (A[pegNeigh]!=newHole and !G2->getEdgeWeight(A[pegNeigh],newHole)){
-                    MultiS3::denom++;
+                    MS3Denom++;
                 }
             }
             numNeigh = G2->adjLists[newHole].size();
             for (uint i =0; i < numNeigh; i++){
                 holeNeigh = G2->adjLists[newHole][i];
                 if (whichPeg[holeNeigh]<n1 and peg!=whichPeg[holeNeigh] ){
-                    MultiS3::denom++;
+                    MS3Denom++;
                 }
             }  	    
 #endif
@@ -1457,8 +1693,8 @@ int SANA::MS3IncSwapOp(uint peg1, uint peg2, uint hole1, uint hole2) {
           default:
           {
               int res = 0;
-              //uint oldhole1Deg = MultiS3::shadowDegree[hole1];
-              //uint oldhole2Deg = MultiS3::shadowDegree[hole2];
+              //uint oldhole1Deg = shadowDegree[hole1];
+              //uint oldhole2Deg = shadowDegree[hole2];
               if (G1->hasSelfLoop(peg1)) {
                   if (G2->hasSelfLoop(hole1)) --res;
                   if (G2->hasSelfLoop(hole2)) ++res;
@@ -1469,31 +1705,28 @@ int SANA::MS3IncSwapOp(uint peg1, uint peg2, uint hole1, uint hole2) {
               }
               for (uint nbr : G1->adjLists[peg1]) {
                   if (nbr != peg1) {
-                      --MultiS3::shadowDegree[hole1];
-                      ++MultiS3::shadowDegree[hole2];
+                      --shadowDegree[hole1];
+                      ++shadowDegree[hole2];
                       res -= G2->getEdgeWeight(hole1, A[nbr]);
                       res += G2->getEdgeWeight(hole2, A[nbr]);
                   }
               }
               for (uint nbr : G1->adjLists[peg2]) {
                   if (nbr != peg1) {
-                      --MultiS3::shadowDegree[hole2];
-                      ++MultiS3::shadowDegree[hole1];
+                      --shadowDegree[hole2];
+                      ++shadowDegree[hole1];
                       res -= G2->getEdgeWeight(hole2, A[nbr]);
                       res += G2->getEdgeWeight(hole1, A[nbr]);
                   }
               }
-//              if (oldhole1Deg > 0 && !MultiS3::shadowDegree[hole1]) MultiS3::denom -= 1;
-//              if (oldhole2Deg > 0 && !MultiS3::shadowDegree[hole2]) MultiS3::denom += 1;
+//              if (oldhole1Deg > 0 && !shadowDegree[hole1]) MS3Denom -= 1;
+//              if (oldhole2Deg > 0 && !shadowDegree[hole2]) MS3Denom += 1;
               return res;
 
           }
               break;
       }
     const uint n1 = G1->getNumNodes();
-    const uint n2 = G2->getNumNodes();
-    vector<uint> whichPeg(n2, n1);
-    for (uint i = 0; i < n1; ++i) whichPeg[A[i]] = i; // inverse of the alignment
     switch (MultiS3::denominator_type){
       case MultiS3::rt_k:
         {
@@ -1501,16 +1734,16 @@ int SANA::MS3IncSwapOp(uint peg1, uint peg2, uint hole1, uint hole2) {
               for (uint i=0; i < numNeigh; i++){
                   holeNeigh = G2->adjLists[hole1][i];
                   if (holeNeigh!=hole2 && whichPeg[holeNeigh]<n1){
-                      MultiS3::denom-=G2->getEdgeWeight(hole1,holeNeigh);
-                      MultiS3::denom+=G2->getEdgeWeight(hole2,holeNeigh);
+                      MS3Denom-=G2->getEdgeWeight(hole1,holeNeigh);
+                      MS3Denom+=G2->getEdgeWeight(hole2,holeNeigh);
                   }
               }
               numNeigh = G2->adjLists[hole2].size();
               for (uint i =0; i < numNeigh; i++){
                   holeNeigh = G2->adjLists[hole2][i];
                   if (holeNeigh != hole1 && whichPeg[holeNeigh]<n1){
-                      MultiS3::denom-=G2->getEdgeWeight(hole2,holeNeigh);
-                      MultiS3::denom+=G2->getEdgeWeight(hole1,holeNeigh);
+                      MS3Denom-=G2->getEdgeWeight(hole2,holeNeigh);
+                      MS3Denom+=G2->getEdgeWeight(hole1,holeNeigh);
                    }
               }
           }
@@ -1521,7 +1754,7 @@ int SANA::MS3IncSwapOp(uint peg1, uint peg2, uint hole1, uint hole2) {
               for (uint i =0; i < numNeigh; i++){
                   holeNeigh = G2->adjLists[hole1][i];
                   if (whichPeg[holeNeigh]<n1 and holeNeigh!=hole2 and G2->getEdgeWeight(holeNeigh,hole1)){
-                      MultiS3::denom--;
+                      MS3Denom--;
                   }
               }
               numNeigh = G1->adjLists[peg1].size();
@@ -1529,10 +1762,10 @@ int SANA::MS3IncSwapOp(uint peg1, uint peg2, uint hole1, uint hole2) {
                   pegNeigh = G1->adjLists[peg1][i];
                     if (pegNeigh!=peg2){
                         if (!G2->getEdgeWeight(A[pegNeigh],hole1)){
-                            MultiS3::denom--;
+                            MS3Denom--;
                         }
                         if (!G2->getEdgeWeight(A[pegNeigh],hole2)){
-                            MultiS3::denom++;
+                            MS3Denom++;
                         }
                     }
               }
@@ -1541,14 +1774,14 @@ int SANA::MS3IncSwapOp(uint peg1, uint peg2, uint hole1, uint hole2) {
               for (uint i =0; i < numNeigh; i++){
                   holeNeigh = G2->adjLists[hole2][i];
                   if (holeNeigh!=hole1 and whichPeg[holeNeigh]<n1 and peg1!=whichPeg[holeNeigh] and !G2->getEdgeWeight(holeNeigh,hole2)){
-                      MultiS3::denom++;
+                      MS3Denom++;
                   }
               }
               numNeigh = G2->adjLists[hole2].size();
               for (uint i =0; i < numNeigh; i++){
                   holeNeigh = G2->adjLists[hole2][i];
                   if (holeNeigh!=hole1 and whichPeg[holeNeigh]<n1 and !G2->getEdgeWeight(hole2,holeNeigh)){
-                      MultiS3::denom--;
+                      MS3Denom--;
                   }
               }
               
@@ -1557,10 +1790,10 @@ int SANA::MS3IncSwapOp(uint peg1, uint peg2, uint hole1, uint hole2) {
                   pegNeigh = G1->adjLists[peg2][i];
                   if (pegNeigh!=peg1){
                       if (!G2->getEdgeWeight(A[pegNeigh],hole2)){
-                          MultiS3::denom--;
+                          MS3Denom--;
                       }
                       if (!G2->getEdgeWeight(A[pegNeigh],hole1)){
-                          MultiS3::denom++;
+                          MS3Denom++;
                       }
                   }
               }
@@ -1568,7 +1801,7 @@ int SANA::MS3IncSwapOp(uint peg1, uint peg2, uint hole1, uint hole2) {
               for (uint i =0; i < numNeigh; i++){
                   holeNeigh = G2->adjLists[hole1][i];
                   if ( G2->getEdgeWeight(hole1,holeNeigh)>0 and whichPeg[holeNeigh]<n1 and holeNeigh!=hole2 and peg2!=whichPeg[holeNeigh]){
-                      MultiS3::denom++;
+                      MS3Denom++;
                   }
               }
         }
@@ -1576,14 +1809,14 @@ int SANA::MS3IncSwapOp(uint peg1, uint peg2, uint hole1, uint hole2) {
 	default:
         {
 #if 0
-		if (oldhole1Deg > 0 && !MultiS3::shadowDegree[hole1]) MultiS3::denom -= 1;
-        	if (oldhole2Deg > 0 && !MultiS3::shadowDegree[hole2]) MultiS3::denom += 1;	
+		if (oldhole1Deg > 0 && !shadowDegree[hole1]) MS3Denom -= 1;
+        	if (oldhole2Deg > 0 && !shadowDegree[hole2]) MS3Denom += 1;	
 #else
               uint numNeigh = G2->adjLists[hole1].size();
               for (uint i =0; i < numNeigh; i++){
                   holeNeigh = G2->adjLists[hole1][i];
                   if (whichPeg[holeNeigh]<n1 and holeNeigh!=hole2 and G2->getEdgeWeight(holeNeigh,hole1)){
-                      MultiS3::denom--;
+                      MS3Denom--;
                   }
               }
               numNeigh = G1->adjLists[peg1].size();
@@ -1591,10 +1824,10 @@ int SANA::MS3IncSwapOp(uint peg1, uint peg2, uint hole1, uint hole2) {
                   pegNeigh = G1->adjLists[peg1][i];
                     if (pegNeigh!=peg2){
                         if (!G2->getEdgeWeight(A[pegNeigh],hole1)){
-                            MultiS3::denom--;
+                            MS3Denom--;
                         }
                         if (!G2->getEdgeWeight(A[pegNeigh],hole2)){
-                            MultiS3::denom++;
+                            MS3Denom++;
                         }
                     }
               }
@@ -1603,14 +1836,14 @@ int SANA::MS3IncSwapOp(uint peg1, uint peg2, uint hole1, uint hole2) {
               for (uint i =0; i < numNeigh; i++){
                   holeNeigh = G2->adjLists[hole2][i];
                   if (holeNeigh!=hole1 and whichPeg[holeNeigh]<n1 and peg1!=whichPeg[holeNeigh] and !G2->getEdgeWeight(holeNeigh,hole2)){
-                      MultiS3::denom++;
+                      MS3Denom++;
                   }
               }
               numNeigh = G2->adjLists[hole2].size();
               for (uint i =0; i < numNeigh; i++){
                   holeNeigh = G2->adjLists[hole2][i];
                   if (holeNeigh!=hole1 and whichPeg[holeNeigh]<n1 and !G2->getEdgeWeight(hole2,holeNeigh)){
-                      MultiS3::denom--;
+                      MS3Denom--;
                   }
               }
               
@@ -1619,10 +1852,10 @@ int SANA::MS3IncSwapOp(uint peg1, uint peg2, uint hole1, uint hole2) {
                   pegNeigh = G1->adjLists[peg2][i];
                   if (pegNeigh!=peg1){
                       if (!G2->getEdgeWeight(A[pegNeigh],hole2)){
-                          MultiS3::denom--;
+                          MS3Denom--;
                       }
                       if (!G2->getEdgeWeight(A[pegNeigh],hole1)){
-                          MultiS3::denom++;
+                          MS3Denom++;
                       }
                   }
               }
@@ -1630,7 +1863,7 @@ int SANA::MS3IncSwapOp(uint peg1, uint peg2, uint hole1, uint hole2) {
               for (uint i =0; i < numNeigh; i++){
                   holeNeigh = G2->adjLists[hole1][i];
                   if ( G2->getEdgeWeight(hole1,holeNeigh)>0 and whichPeg[holeNeigh]<n1 and holeNeigh!=hole2 and peg2!=whichPeg[holeNeigh]){
-                      MultiS3::denom++;
+                      MS3Denom++;
                   }
               }
 #endif
@@ -1646,173 +1879,45 @@ int SANA::inducedEdgesIncChangeOp(uint peg, uint oldHole, uint newHole) {
     return res;
 }
 
-double SANA::localScoreSumIncChangeOp(const vector<vector<float>>& sim, uint peg, uint oldHole, uint newHole) {
-    return sim[peg][newHole] - sim[peg][oldHole];
-}
-
-double SANA::localScoreSumIncSwapOp(const vector<vector<float>>& sim, uint peg1, uint peg2, uint hole1, uint hole2) {
-    return sim[peg1][hole2] - sim[peg1][hole1] + sim[peg2][hole1] - sim[peg2][hole2];
-}
-
-double SANA::JSIncChangeOp(uint peg, uint oldHole, uint newHole) {
-    if (jsWeight == 0) return 0;
-
-    //eval newJsSum
-    //update alignedByNode with peg and peg neighbors using oldHole and newHole
-
-    // eval for peg from scratch
-    uint pegOldAlingedEdges = alignedByNode[peg];
-    uint pegAlignedEdges = 0;
-    vector<uint> pegNeighbors = G1->adjLists[peg];
-    for (uint nbr : pegNeighbors) {
-        uint neighborAlignedTo = A[nbr]; 
-        pegAlignedEdges += G2->getEdgeWeight(newHole, neighborAlignedTo);
-    }
-    alignedByNode[peg] = pegAlignedEdges;
-    //update newJsSum
-    uint pegTotalEdges = pegNeighbors.size();
-    double change = ((pegAlignedEdges - pegOldAlingedEdges)/(double)pegTotalEdges);
-
-    // for each peg neighbor update do iterative changes to the jsAlingedByNode vector
-    // in each update get the G2mapping of neighbor and then check if edge was aligned by oldHole to G2mapping and reduce score if newHole to G2mapping doesnt exist
-    // increase score if oldHole to G2 mapping edge didnt exist but newHole to G2 mapping does
-    //no changes other wise
-    for (uint nbr : pegNeighbors) {
-        uint neighborAlignedTo = A[nbr];
-        uint neighborOldAlignedEdges = alignedByNode[nbr];
-        uint neighborTotalEdges = G1->adjLists[nbr].size();
-        alignedByNode[nbr] -= G2->getEdgeWeight(oldHole, neighborAlignedTo);
-        alignedByNode[nbr] += G2->getEdgeWeight(newHole, neighborAlignedTo);
-        //update newJsSum
-        change += ((alignedByNode[nbr] - neighborOldAlignedEdges)/(double)neighborTotalEdges);
-    }
-    return change;
-}
-
-double SANA::JSIncSwapOp(uint peg1, uint peg2, uint hole1, uint hole2) {
-    if (jsWeight == 0) return 0;
-
-    //eval swap as two pegs and then loop neighbors
-
-    uint peg1OldAlingedEdges = alignedByNode[peg1];
-    uint peg1AlignedEdges = 0;
-    vector<uint> peg1Neighbors = G1->adjLists[peg1];
-    uint peg1TotalEdges = peg1Neighbors.size();
-
-    uint peg2OldAlingedEdges = alignedByNode[peg2];
-    uint peg2AlignedEdges = 0;
-    vector<uint> peg2Neighbors = G1->adjLists[peg2];
-    uint peg2TotalEdges = peg2Neighbors.size();
-
-    // eval for peg1 from sratch
-    for (uint nbr : peg1Neighbors) {
-        uint neighborAlignedTo = A[nbr];
-        // if (G2->getEdgeWeight(hole2, neighborAlignedTo) == true) {
-        //     peg1AlignedEdges += 1;
-        // }
-        peg1AlignedEdges = G2->getEdgeWeight(hole2, neighborAlignedTo);
-    }
-    alignedByNode[peg1] = peg1AlignedEdges;
-
-    double change = ((peg1AlignedEdges - peg1OldAlingedEdges)/(double)peg1TotalEdges);
-
-    //for each peg neighbor update do iterative changes to the jsAlingedByNode vector
-    //in each update get the G2mapping of neighbor and then check if edge was aligned by
-    //oldHole to G2mapping and reduce score if newHole to G2mapping doesnt exist
-    //increase score if oldHole to G2 mapping edge didnt exist but newHole to G2 mapping does
-    //no changes other wise
-    for (uint nbr : peg1Neighbors) {
-        uint neighborAlignedTo = A[nbr];
-        uint neighborOldAlignedEdges = alignedByNode[nbr];
-        uint neighborTotalEdges = G1->adjLists[nbr].size();
-        if (std::find (peg1Neighbors.begin(), peg1Neighbors.end(), nbr) == peg1Neighbors.end()) {
-            alignedByNode[nbr] -= G2->getEdgeWeight(hole1, neighborAlignedTo);
-            alignedByNode[nbr] += G2->getEdgeWeight(hole2, neighborAlignedTo);
-            //update newJsSum
-            change += ((alignedByNode[nbr] - neighborOldAlignedEdges)/(double)neighborTotalEdges);
-        }
-    }
-
-    // eval for peg2 from scratch
-    for (uint nbr : peg2Neighbors) {
-        uint neighborAlignedTo = A[nbr];
-        peg2AlignedEdges += G2->getEdgeWeight(hole1, neighborAlignedTo);
-    }
-    alignedByNode[peg2] = peg2AlignedEdges;
-    change += ((peg2AlignedEdges - peg2OldAlingedEdges)/(double)peg2TotalEdges);
-
-    // for each peg neighbor update do iterative changes to the jsAlingedByNode vector
-    // in each update get the G2mapping of neighbor and then check if edge was aligned by oldHole to G2mapping and reduce score if newHole to G2mapping doesnt exist
-    // increase score if oldHole to G2 mapping edge didnt exist but newHole to G2 mapping does
-    //no changes other wise
-    for (uint nbr : peg2Neighbors) {
-        uint neighborAlignedTo = A[nbr];
-        uint neighborOldAlignedEdges = alignedByNode[nbr];
-        uint neighborTotalEdges = G1->adjLists[nbr].size();
-        if (std::find (peg1Neighbors.begin(), peg1Neighbors.end(), nbr) == peg1Neighbors.end()) {
-            alignedByNode[nbr] -= G2->getEdgeWeight(hole2, neighborAlignedTo);
-            alignedByNode[nbr] += G2->getEdgeWeight(hole1, neighborAlignedTo);
-            //update newJsSum
-            change += ((alignedByNode[nbr] - neighborOldAlignedEdges)/(double)neighborTotalEdges);
-        }
-    }
-
-    //eval for common neighbors
-    vector<uint> peg1peg2commonneighbors(peg1Neighbors.size() + peg2Neighbors.size());
-    set_intersection(peg1Neighbors.begin(), peg1Neighbors.end(),
-                     peg2Neighbors.begin(), peg2Neighbors.end(),
-                     peg1peg2commonneighbors.begin());
-    return change;
+template <typename SimMatrix>
+double SANA::localScoreSumIncChangeOp(const SimMatrix& sim, uint peg, uint oldHole, uint newHole) {
+    return simAt(sim, peg, newHole) - simAt(sim, peg, oldHole);
 }
 
-double SANA::WECIncChangeOp(uint peg, uint oldHole, uint newHole) {
-    double res = 0;
-    for (uint nbr : G1->adjLists[peg]) {
-        if (G2->getEdgeWeight(oldHole, A[nbr])) {
-            res -= wecSims[peg][oldHole];
-            res -= wecSims[nbr][A[nbr]];
-        }
-        if (G2->getEdgeWeight(newHole, A[nbr])) {
-            res += wecSims[peg][newHole];
-            res += wecSims[nbr][A[nbr]];
-        }
-    }
-    return res;
+template <typename SimMatrix>
+double SANA::localScoreSumIncSwapOp(const SimMatrix& sim, uint peg1, uint peg2, uint hole1, uint hole2) {
+    return simAt(sim, peg1, hole2) - simAt(sim, peg1, hole1) + simAt(sim, peg2, hole1) - simAt(sim, peg2, hole2);
 }
 
 double SANA::WECIncSwapOp(uint peg1, uint peg2, uint hole1, uint hole2) {
     double res = 0;
     for (uint nbr : G1->adjLists[peg1]) {
         if (G2->getEdgeWeight(hole1, A[nbr])) {
-            res -= wecSims[peg1][hole1];
-            res -= wecSims[nbr][A[nbr]];
+            res -= wecSim(peg1, hole1);
+            res -= wecSim(nbr, A[nbr]);
         }
         if (G2->getEdgeWeight(hole2, A[nbr])) {
-            res += wecSims[peg1][hole2];
-            res += wecSims[nbr][A[nbr]];
+            res += wecSim(peg1, hole2);
+            res += wecSim(nbr, A[nbr]);
         }
     }
     for (uint nbr : G1->adjLists[peg2]) {
         if (G2->getEdgeWeight(hole2, A[nbr])) {
-            res -= wecSims[peg2][hole2];
-            res -= wecSims[nbr][A[nbr]];
+            res -= wecSim(peg2, hole2);
+            res -= wecSim(nbr, A[nbr]);
         }
         if (G2->getEdgeWeight(hole1, A[nbr])) {
-            res += wecSims[peg2][hole1];
-            res += wecSims[nbr][A[nbr]];
+            res += wecSim(peg2, hole1);
+            res += wecSim(nbr, A[nbr]);
         }
     }
     if (G1->hasEdge(peg1, peg2) and G2->hasEdge(hole1, hole2)) {
-        res += 2*wecSims[peg1][hole1];
-        res += 2*wecSims[peg2][hole2];
+        res += 2*wecSim(peg1, hole1);
+        res += 2*wecSim(peg2, hole2);
     }
     return res;
 }
 
-double SANA::EWECIncChangeOp(uint peg, uint oldHole, uint newHole) {
-    return EWECSimCombo(peg, newHole) - EWECSimCombo(peg, oldHole);
-}
-
 double SANA::EWECIncSwapOp(uint peg1, uint peg2, uint hole1, uint hole2) {
     double score = EWECSimCombo(peg1, hole2) + EWECSimCombo(peg2, hole1) 
                  - EWECSimCombo(peg1, hole1) - EWECSimCombo(peg2, hole2);
@@ -1835,24 +1940,12 @@ double SANA::EWECSimCombo(uint peg, uint hole) {
     return score/(2*g1Edges);
 }
 
-int SANA::ncIncChangeOp(uint peg, uint oldHole, uint newHole) {
-    int change = 0;
-    if (trueAWithValidCountAppended[peg] == oldHole) change -= 1;
-    if (trueAWithValidCountAppended[peg] == newHole) change += 1;
-    return change;
-}
-
-int SANA::ncIncSwapOp(uint peg1, uint peg2, uint hole1, uint hole2) {
-    int change = 0;
-    if (trueAWithValidCountAppended[peg1] == hole1) change -= 1;
-    if (trueAWithValidCountAppended[peg2] == hole2) change -= 1;
-    if (trueAWithValidCountAppended[peg1] == hole2) change += 1;
-    if (trueAWithValidCountAppended[peg2] == hole1) change += 1;
-    return change;
-}
-
 void SANA::trackProgress(long long int iter, long long int maxIters) {
     if (!enableTrackProgress) return;
+#ifdef COUNT_ALLOCATIONS
+    //allocations made by the iterations since the last call (should be 0)
+    unsigned long long allocations = numAllocations()-allocationsAfterLastProgress;
+#endif
     double fractionTime = maxIters == -1 ? 0 : iter/(double)maxIters;
     double elapsedTime = timer.elapsed();
     uint iterationsElapsed = iterationsPerformed-oldIterationsPerformed;
@@ -1860,9 +1953,18 @@ void SANA::trackProgress(long long int iter, long long int maxIters) {
     double ips = (iterationsElapsed/(elapsedTime-oldTimeElapsed));
     oldTimeElapsed = elapsedTime;
     oldIterationsPerformed = iterationsPerformed;
-    cout<<iter/iterationsPerStep<<" ("<<100*fractionTime<<"%,"<<elapsedTime<<"s): score = "<<currentScore;
-    cout<< " ips = "<<ips<<", P("<<Temperature<<") = "<<acceptingProbability(avgEnergyInc, Temperature);
-    cout<<", pBad = "<<incrementalMeanPBad()<<endl;
+    //the line is written at once so that it is not interleaved with the output of other chains
+    ostringstream line;
+    line<<progressLabel<<iter/iterationsPerStep<<" ("<<100*fractionTime<<"%,"<<elapsedTime<<"s): score = "<<currentScore;
+    line<< " ips = "<<ips<<", P("<<Temperature<<") = "<<acceptingProbability(avgEnergyInc, Temperature);
+    line<<", pBad = "<<incrementalMeanPBad();
+    for (uint k = 0; k < localMeasureNames.size(); k++)
+        line<<", "<<localMeasureNames[k]<<" = "<<localMeasureScoreSum(k)/n1;
+#ifdef COUNT_ALLOCATIONS
+    line<<", allocations = "<<allocations;
+#endif
+    line<<endl;
+    cout<<line.str();
 
     bool checkScores = true;
     if (checkScores) {
@@ -1902,12 +2004,195 @@ void SANA::trackProgress(long long int iter, long long int maxIters) {
             cout<<"; try "<<TDecay<<endl;
         }
     }
+    allocationsAfterLastProgress = numAllocations();
 }
 
 void SANA::setTInitial(double t) { TInitial = t; }
 void SANA::setTFinal(double t) { TFinal = t; }
 void SANA::setTDecayFromTempRange() { TDecay = -log(TFinal/TInitial); }
 void SANA::setDynamicTDecay() { dynamicTDecay = true; }
+void SANA::setPBadSampleInterval(uint k) { pBadSampleInterval = max(1u, k); }
+double SANA::getTInitial() const { return TInitial; }
+double SANA::getTFinal() const { return TInitial * exp(-TDecay); }
+
+long long int SANA::getMaxIterations() {
+    if (useIterations) return maxIterations;
+    return (long long int) (getIterPerSecond()*maxSeconds);
+}
+
+void SANA::setRandomStream(unsigned int stream) { gen.seed(getRandomSeed(), stream); }
+
+void SANA::initFixedTempChain(double temp) {
+    initDataStructures();
+    constantTemp = true;
+    enableTrackProgress = false;
+    Temperature = temp;
+    resetLoopProfile();
+}
+
+void SANA::runFixedTempIterations(long long int numIters) {
+    for (long long int i = 0; i < numIters; i++) SANAIteration();
+}
+
+Alignment SANA::hillClimbFrom(const Alignment& alig) {
+    if (not addHillClimbing) return alig;
+    startA = alig;
+    initDataStructures();
+    performHillClimbing(HILL_CLIMBING_IDLE_ITERATIONS);
+    return A;
+}
+
+void SANA::setTemperature(double temp) { Temperature = temp; }
+double SANA::getCurrentScore() const { return currentScore; }
+vector<uint> SANA::getCurrentAlignment() const { return A; }
+void SANA::setProgressLabel(const string& label) { progressLabel = label; }
+void SANA::setSnapshotSuffix(const string& suffix) { snapshotSuffix = suffix; }
+
+void SANA::setCheckpoints(const string& fileName, double intervalSeconds) {
+    checkpointFileName = fileName;
+    checkpointIntervalSeconds = intervalSeconds;
+}
+
+void SANA::setResumeFile(const string& fileName) {
+#ifdef CORES
+    throw runtime_error("checkpoints do not include the core scores, so runs cannot be resumed with CORES");
+#endif
+    resumeFileName = fileName;
+}
+
+const string CHECKPOINT_MAGIC = "SANA checkpoint v4";
+
+//the order of the fields in loadCheckpoint must be the same
+void SANA::saveCheckpoint(long long int iter, long long int maxIters) {
+    Timer T;
+    T.start();
+    BinaryBuffer buf;
+    buf.writeString(CHECKPOINT_MAGIC);
+    buf.write(n1);
+    buf.write(n2);
+    buf.write(objectiveHash);
+
+    //schedule and progress
+    buf.write(iter);
+    buf.write(maxIters);
+    buf.write(useIterations);
+    buf.write(maxIterations);
+    buf.write(maxSeconds);
+    buf.write(iterPerSecond);
+    buf.write(TInitial);
+    buf.write(TFinal);
+    buf.write(TDecay);
+    buf.write(Temperature);
+    buf.write(timer.elapsed());
+    buf.write(iterationsPerformed);
+    buf.write(oldIterationsPerformed);
+    buf.write(oldTimeElapsed);
+    buf.write(avgEnergyInc);
+    buf.write(previousScore);
+    buf.write(currentScore);
+    for (uint i = 0; i < 4; i++) buf.write(gen.getState()[i]);
+
+    //pBad buffer
+    buf.writeVector(pBadBuffer);
+    buf.write(numPBadsInBuffer);
+    buf.write(pBadBufferIndex);
+    buf.write(pBadBufferSum);
+    buf.write(badMovesSinceLastSample);
+
+    //alignment
+    buf.writeVector(A);
+    buf.writeVector(assignedNodesG2);
+    buf.write<uint64_t>(actColToUnassignedG2Nodes.size());
+    for (const vector<uint>& nodes : actColToUnassignedG2Nodes) buf.writeVector(nodes);
+
+    //incremental evaluation
+    buf.write(aligEdges);
+    buf.write(squaredAligEdges);
+    buf.write(exposedEdgesNumer);
+    buf.write(MS3Numer);
+    buf.write(MS3Denom);
+    buf.write(MS3NormalizationFactor);
+    for (int count : {ER_k, EL_k, RA_k, RU_k, RO_k}) buf.write(count);
+    buf.writeVector(shadowDegree);
+    buf.writeVector(whichPeg);
+    buf.writeVector(totalInducedWeight);
+    buf.write(inducedEdges);
+    buf.write(wecSum);
+    buf.write(ewecSum);
+    buf.write(localScoreSum);
+    incMeasures.save(buf);
+
+    size_t numBytes = buf.getBytes().size();
+    BackgroundWriter::write(checkpointFileName, buf.getBytes());
+    lastCheckpointTime = timer.elapsed();
+    cout << progressLabel << "Checkpoint of iteration " << iter << " (" << numBytes << " bytes) queued for "
+         << checkpointFileName << " in " << T.elapsedString() << endl;
+}
+
+long long int SANA::loadCheckpoint(const string& fileName, long long int& maxIters) {
+    cout << "Resuming from checkpoint " << fileName << endl;
+    BinaryBuffer buf(fileName);
+    if (buf.readString() != CHECKPOINT_MAGIC) throw runtime_error(fileName+" is not a SANA checkpoint");
+    if (buf.read<uint>() != n1 or buf.read<uint>() != n2)
+        throw runtime_error("the checkpoint "+fileName+" was saved with different graphs");
+    if (buf.read<uint64_t>() != objectiveHash)
+        throw runtime_error("the checkpoint "+fileName+" was saved with a different objective function");
+
+    long long int iter = buf.read<long long int>();
+    maxIters = buf.read<long long int>();
+    useIterations = buf.read<bool>();
+    maxIterations = buf.read<long long int>();
+    maxSeconds = buf.read<double>();
+    iterPerSecond = buf.read<double>();
+    initializedIterPerSecond = true;
+    TInitial = buf.read<double>();
+    TFinal = buf.read<double>();
+    TDecay = buf.read<double>();
+    Temperature = buf.read<double>();
+    timer.start(buf.read<double>());
+    iterationsPerformed = buf.read<uint>();
+    oldIterationsPerformed = buf.read<uint>();
+    oldTimeElapsed = buf.read<double>();
+    avgEnergyInc = buf.read<double>();
+    previousScore = buf.read<double>();
+    currentScore = buf.read<double>();
+    uint64_t rngState[4];
+    for (uint i = 0; i < 4; i++) rngState[i] = buf.read<uint64_t>();
+    gen.setState(rngState);
+
+    buf.readVector(pBadBuffer);
+    numPBadsInBuffer = buf.read<int>();
+    pBadBufferIndex = buf.read<int>();
+    pBadBufferSum = buf.read<double>();
+    badMovesSinceLastSample = buf.read<uint>();
+
+    buf.readVector(A);
+    buf.readVector(assignedNodesG2);
+    if (buf.read<uint64_t>() != actColToUnassignedG2Nodes.size())
+        throw runtime_error("the checkpoint "+fileName+" was saved with different node colors");
+    for (vector<uint>& nodes : actColToUnassignedG2Nodes) buf.readVector(nodes);
+
+    aligEdges = buf.read<int>();
+    squaredAligEdges = buf.read<int>();
+    exposedEdgesNumer = buf.read<int>();
+    MS3Numer = buf.read<int>();
+    MS3Denom = buf.read<uint>();
+    MS3NormalizationFactor = buf.read<double>();
+    for (int* count : {&ER_k, &EL_k, &RA_k, &RU_k, &RO_k}) *count = buf.read<int>();
+    buf.readVector(shadowDegree);
+    buf.readVector(whichPeg);
+    buf.readVector(totalInducedWeight);
+    inducedEdges = buf.read<int>();
+    wecSum = buf.read<double>();
+    ewecSum = buf.read<double>();
+    localScoreSum = buf.read<double>();
+    incMeasures.load(buf);
+    if (not buf.atEnd()) throw runtime_error("unexpected data at the end of the checkpoint "+fileName);
+    initHoleIndices();
+
+    cout << "Continuing from iteration " << iter+1 << " of " << maxIters << endl;
+    return iter;
+}
 
 double SANA::getIterPerSecond() {
     if (not initializedIterPerSecond) initIterPerSecond();
@@ -1916,10 +2201,10 @@ double SANA::getIterPerSecond() {
 
 void SANA::initIterPerSecond() {
     initializedIterPerSecond = true;
-    cout << "Determining iteration speed...." << endl;
     double totalIps = 0.0;
     int ipsListSize = 0;
     if (ipsList.size() != 0) {
+        cout << "Determining iteration speed...." << endl;
         for (pair<double,double> ipsPair : ipsList) {
             if (TFinal <= ipsPair.first && ipsPair.first <= TInitial) {
                 totalIps+=ipsPair.second;
@@ -1927,23 +2212,97 @@ void SANA::initIterPerSecond() {
             }
         }
         totalIps = totalIps / (double) ipsListSize;
+    } else if (useIpsCache and readCachedIps(totalIps)) {
+        cout << "Using the iteration speed cached in " << ipsCacheFileName() << endl;
     } else {
+        Profiler::ScopedPhase phase("ips calibration");
+        cout << "Determining iteration speed...." << endl;
         cout << "Since temperature schedule is provided, ips will be "
              << "calculated using constantTempIterations" << endl;
+        //the random generator is restored afterwards, so that a run makes the same random
+        //choices whether its ips comes from the cache or is measured here
+        uint64_t genState[4];
+        copy(gen.getState(), gen.getState()+4, genState);
         long long int iter = 1E6;
         constantTempIterations(iter - 1);
         double res = iter/timer.elapsed();
         totalIps = res;
+        gen.setState(genState);
+        if (useIpsCache) writeCachedIps(totalIps);
     }
     cout << "SANA does " << long(totalIps) << " iterations per second on average" << endl;
     iterPerSecond = totalIps;
+}
 
-    //what is this? can it be removed? -Nil
-    uint integralMin = maxSeconds/60.0;
-    string folder = "cache-pbad/"+MC->toString()+"/progress_"+to_string(integralMin)+"/";
-    string fileName = folder+G1->getName()+"_"+G2->getName()+"_0.csv";
-    ofstream ofs(fileName);
-    ofs<<"time,score,avgEnergyInc,Temperature,realTemp,pBad,lower,higher,timer"<<endl;
+const string SANA::IPS_CACHE_FOLDER = "autogenerated/ips/";
+
+void SANA::setUseIpsCache(bool use) { useIpsCache = use; }
+
+void SANA::setTopKMoveProb(double prob) {
+    if (not topSims) {
+        cerr << "Warning: top-k moves need top-k similarities (-simtopk) and local measures, ignoring them" << endl;
+        return;
+    }
+    topKMoveProb = prob;
+    needWhichPeg = true;
+    whichPeg = vector<uint> (n2, n1);
+    unassignedIndex = vector<uint> (n2);
+}
+
+string SANA::ipsCacheFileName() const {
+    //the build is identified by the commit, the compiler and the flags that change the main loop
+    string build = SANAversion;
+    build += " EDGE_T:"+to_string(sizeof(EDGE_T));
+#ifdef SPARSE
+    build += " SPARSE";
+#endif
+#ifdef CORES
+    build += " CORES";
+#endif
+#ifdef COUNT_ALLOCATIONS
+    build += " COUNT_ALLOCATIONS";
+#endif
+#ifdef __OPTIMIZE__
+    build += " OPTIMIZE";
+#endif
+    if (topSims) build += " topK:"+to_string(LocalMeasure::getTopK());
+    if (LocalMeasure::getPrecision() != SimPrecision::FP32) build += " "+simPrecisionName(LocalMeasure::getPrecision());
+    if (topKMoveProb > 0) build += " topKMoves:"+to_string(topKMoveProb);
+    if (not localImplicitSims.empty() or implicitWecSims) build += " implicitSims";
+#ifndef SPARSE
+    if (not G1->adjMatrix.isDense()) build += " hybridG1";
+    if (not G2->adjMatrix.isDense()) build += " hybridG2";
+#endif
+    uint64_t key = G1->contentHash();
+    key = hashBytes(&key, sizeof(key), G2->contentHash());
+    key = hashString(MC->toString(), key);
+    key = hashString(build, key);
+    key = hashString(cpuModelName(), key);
+    return IPS_CACHE_FOLDER+G1->getName()+"_"+G2->getName()+"_"+hashToHex(key)+".txt";
+}
+
+bool SANA::readCachedIps(double& ips) const {
+    string fileName = ipsCacheFileName();
+    if (not FileIO::fileExists(fileName)) return false;
+    vector<string> words = FileIO::fileToWords(fileName);
+    if (words.empty()) return false;
+    try { ips = stod(words[0]); }
+    catch (...) { return false; }
+    return ips > 0;
+}
+
+void SANA::writeCachedIps(double ips) const {
+    if (not (ips > 0)) return;
+    FileIO::createFolder(IPS_CACHE_FOLDER);
+    //written under a temporary name and renamed, in case another SANA process is reading it
+    string fileName = ipsCacheFileName();
+    string tmpFileName = fileName+".tmp"+to_string(getpid());
+    ofstream ofs(tmpFileName);
+    ofs << ips << endl;
+    ofs << G1->getName() << " " << G2->getName() << " " << MC->toString() << endl;
+    ofs << cpuModelName() << endl;
+    ofs.close();
+    if (not ofs or rename(tmpFileName.c_str(), fileName.c_str()) != 0) remove(tmpFileName.c_str());
 }
 
 void SANA::constantTempIterations(long long int iterTarget) {
@@ -1959,25 +2318,41 @@ void SANA::constantTempIterations(long long int iterTarget) {
 /* when we run sana at a fixed temp, scores generally go up
 (especially if the temp is low) until a point of "thermal equilibrium".
 This function should return the avg pBad at equilibrium.
-we keep track of the score every certain number of iterations
-if the score went down at least half the time,
-this suggests that the upward trend is over and we are at equilirbium
+every pBad is added to the pBad buffer, and every 'blockSize' iterations we take the mean
+of the pBads of the last block. once we have the means of the last 'numBlocks' blocks, the batch-means
+test of pBadBlocksAtEquilibrium decides if we are at equilibrium: their trend must not be
+statistically significant, and their mean must be a precise enough estimate.
 once we know we are at equilibrium, we use the buffer of pbads to get an average pBad
-'logLevel' can be 0 (no output) 1 (logs result in cerr) or 2 (verbose/debug mode)*/
-double SANA::getPBad(double temp, double maxTimeInS, int logLevel) {
+by default, the run starts from a new random alignment. with 'warmStart', it continues from
+the alignment left by the previous call, which is already close to equilibrium if the temperatures are close
+'logLevel' can be 0 (no output) 1 (logs result in cout) or 2 (verbose/debug mode)*/
+double SANA::getPBad(double temp, double maxTimeInS, int logLevel, bool warmStart) {
     //new state for the run at fixed temperature
     constantTemp = true;
     Temperature = temp;
     enableTrackProgress = false;
-
-    //note: this is a circular buffer that maintains scores sampled at intervals
-    vector<double> scoreBuffer;
-    //the larger 'numScores' is, the stronger evidence of reachign equilibrium. keep this value odd
-    const uint numScores = 11;
+    //the result is the mean of the pBad buffer, so every bad move is sampled
+    uint savedPBadSampleInterval = pBadSampleInterval;
+    pBadSampleInterval = 1;
+
+    //means of the pBads of the last 'numBlocks' blocks of 'blockSize' iterations (see pBadBlocksAtEquilibrium)
+    //the blocks are small enough that all the pBads of a block are still in the pBad buffer
+    vector<double> blockMeans;
+    const uint numBlocks = 10;
     uint iter = 0;
-    uint sampleInterval = 10000;
+    uint blockSize = 10000;
     bool reachedEquilibrium = false;
-    initDataStructures(); //this initializes the timer and resets the pBad buffer
+    if (warmStart) {
+        //keep the alignment reached at the previous temperature, which is closer to equilibrium
+        //at this one than a random alignment if the temperatures are close
+        iterationsPerformed = 0;
+        numPBadsInBuffer = pBadBufferSum = pBadBufferIndex = 0;
+        numPBadsSampled = 0;
+        timer.start();
+    } else {
+        initDataStructures(); //this initializes the timer and resets the pBad buffer
+    }
+    long long int numPBadsBeforeBlock = 0;
     bool verbose = (logLevel == 2); //print everything going on, for debugging purposes
     uint verbose_i = 0;
     if (verbose) cerr<<endl<<"****************************************"<<endl
@@ -1985,38 +2360,31 @@ double SANA::getPBad(double temp, double maxTimeInS, int logLevel) {
     while (not reachedEquilibrium) {
         SANAIteration();
         iter++;
-        if (iter%sampleInterval == 0) {
+        if (iter%blockSize == 0) {
             if (verbose) {
                 cerr<<verbose_i<<" score: "<<currentScore<<" (avg pBad: "
                     <<slowMeanPBad()<<")"<<endl;
                 verbose_i++;
             }
-            //circular buffer behavior
-            //(since the buffer is tiny, the cost of shifting everything is negligible)
-            scoreBuffer.push_back(currentScore);            
-            if (scoreBuffer.size() > numScores) scoreBuffer.erase(scoreBuffer.begin());
-            if (scoreBuffer.size() == numScores) {
-                //check if we are at eq:
-                //if the score went down more than up, it suggests we are at eq
-                uint scoreTrend = 0;
-                for (uint i = 0; i < numScores-1; i++) {
-                    if (scoreBuffer[i+1] < scoreBuffer[i]) scoreTrend--;
-                    if (scoreBuffer[i+1] > scoreBuffer[i]) scoreTrend++;
-                }
-                reachedEquilibrium = (scoreTrend <= 0);
-                if (verbose) {
-                    cerr<<"scoreTrend = "<<scoreTrend<<endl;
-                    if (reachedEquilibrium) {
-                        cerr<<endl<<"Reached equilibrium"<<endl<<"scoreBuffer:"<<endl;
-                        for (uint i = 0; i < scoreBuffer.size(); i++) cerr<<scoreBuffer[i]<<" ";
-                        cerr<<endl;
-                    }
+            int numPBadsInBlock = numPBadsSampled - numPBadsBeforeBlock;
+            numPBadsBeforeBlock = numPBadsSampled;
+            if (numPBadsInBlock > 0) {
+                //(since the buffer is tiny, the cost of shifting everything is negligible)
+                blockMeans.push_back(meanOfLastPBads(numPBadsInBlock));
+                if (blockMeans.size() > numBlocks) blockMeans.erase(blockMeans.begin());
+            }
+            if (blockMeans.size() == numBlocks) {
+                reachedEquilibrium = pBadBlocksAtEquilibrium(blockMeans);
+                if (verbose and reachedEquilibrium) {
+                    cerr<<endl<<"Reached equilibrium"<<endl<<"block pBads:"<<endl;
+                    for (uint i = 0; i < blockMeans.size(); i++) cerr<<blockMeans[i]<<" ";
+                    cerr<<endl;
                 }
             }
             if (timer.elapsed() > maxTimeInS) {
                 if (verbose) {
-                    cerr<<"ran out of time. scoreBuffer:"<<endl;
-                    for (uint i = 0; i < scoreBuffer.size(); i++) cerr<<scoreBuffer[i]<<endl;
+                    cerr<<"ran out of time. block pBads:"<<endl;
+                    for (uint i = 0; i < blockMeans.size(); i++) cerr<<blockMeans[i]<<endl;
                     cerr<<endl;
                 }
                 break;
@@ -2024,14 +2392,19 @@ double SANA::getPBad(double temp, double maxTimeInS, int logLevel) {
         }
     }
     double pBadAvgAtEq = slowMeanPBad();
+    pBadSampleInterval = savedPBadSampleInterval;
     double nextIps = (double)iter / (double)timer.elapsed();
     pair<double, double> nextPair (temp, nextIps);
     ipsList.push_back(nextPair);
     if (logLevel >= 1) {
-        cout<<"> getPBad("<<temp<<") = "<<pBadAvgAtEq<<" (score: "<<currentScore<<")";
-        if (reachedEquilibrium) cout<<" (time: "<<timer.elapsed()<<"s)";
-        else cout<<" (didn't detect eq. after "<<maxSeconds<<"s)";
-        cout<<" iterations = "<<iter<<", ips = "<<nextIps<<endl;
+        //the line is written at once so that it is not interleaved with the output of other
+        //copies of this object sampling other temperatures in parallel
+        ostringstream line;
+        line<<"> getPBad("<<temp<<") = "<<pBadAvgAtEq<<" (score: "<<currentScore<<")";
+        if (reachedEquilibrium) line<<" (time: "<<timer.elapsed()<<"s)";
+        else line<<" (didn't detect eq. after "<<maxTimeInS<<"s)";
+        line<<" iterations = "<<iter<<", ips = "<<nextIps<<endl;
+        cout<<line.str();
         if (verbose) cerr<<"final result: "<<pBadAvgAtEq<<endl
                          <<"****************************************"<<endl<<endl;
     }
@@ -4,9 +4,14 @@
 #include <map>
 #include <tuple>
 #include <mutex>
+#include <atomic>
+#include <memory>
 #include <chrono>
 #include <ctime>
 #include <random>
+#include "../utils/Xoshiro256.hpp"
+#include "../utils/Profiler.hpp"
+#include "../utils/BitMatrix.hpp"
 #include <list>
 #include <utility>
 #include <unordered_set>
@@ -16,6 +21,11 @@
 #include "../utils/randomSeed.hpp"
 #include "../measures/ExternalWeightedEdgeConservation.hpp"
 #include "../measures/CoreScore.hpp"
+#include "../measures/IncrementalMeasure.hpp"
+#include "../measures/EdgeDifference.hpp"
+#include "../measures/EdgeRatio.hpp"
+#include "../measures/JaccardSimilarityScore.hpp"
+#include "../measures/NodeCorrectness.hpp"
 
 using namespace std;
 
@@ -41,14 +51,74 @@ public:
     //requires TInitial and TFinal to be already initialized
     void setTDecayFromTempRange();
 
-    double getPBad(double temp, double maxTimeInS = 1.0, int logLevel = 1); //0 for no output, 2 for verbose
+    //the pBad of only one in every 'k' bad moves is computed and added to the pBad buffer (1 means all)
+    //it does not affect which moves are accepted. getPBad always uses 1
+    void setPBadSampleInterval(uint k);
+
+    //returns the mean pBad at temperature 'temp' once the anneal at that temperature reaches equilibrium
+    //(or after 'maxTimeInS'). logLevel: 0 for no output, 2 for verbose
+    //by default it starts from a new random alignment. with 'warmStart', it continues from the alignment
+    //left by the previous call instead, which equilibrates faster when sweeping through close temperatures.
+    //warmStart can only be used after a first call without it
+    double getPBad(double temp, double maxTimeInS = 1.0, int logLevel = 1, bool warmStart = false);
     list<pair<double, double>> ipsList;
 
+    double getTInitial() const;
+    double getTFinal() const; //derived from TInitial and TDecay, so it is valid even if TFinal was never set
+    long long int getMaxIterations(); //not const because it may need to measure the ips first
+
+    //interface for methods that drive one or more SANA chains at a fixed temperature (see ReplicaExchange)
+    //a copy of a SANA object is an independent chain that shares the graphs and measures with the original
+    //gives the chain the random stream 'stream' derived from the global seed (see Xoshiro256)
+    void setRandomStream(unsigned int stream);
+    void initFixedTempChain(double temp); //starts from a fresh alignment and disables progress tracking
+    void runFixedTempIterations(long long int numIters);
+    void setTemperature(double temp);
+    double getCurrentScore() const;
+    vector<uint> getCurrentAlignment() const;
+    void setProgressLabel(const string& label); //prefix for the progress lines (to tell chains apart)
+    void setSnapshotSuffix(const string& suffix); //added to the names of the snapshots (same reason)
+    //adds the profile of the iterations of the chain to the Profiler (with -profile). call it once the chain is done
+    void addLoopProfileToProfiler();
+    //if the object was built with addHillClimbing, runs the final hill climbing of run() starting from
+    //'alig' and returns the result. otherwise it returns 'alig'
+    Alignment hillClimbFrom(const Alignment& alig);
+
+    //periodically saves the state of run() to 'fileName' (at most once every 'intervalSeconds')
+    void setCheckpoints(const string& fileName, double intervalSeconds);
+    //makes run() continue from a checkpoint instead of starting a new run. the run continues exactly
+    //as it would have without stopping. the graphs and the objective function must be the same
+    void setResumeFile(const string& fileName);
+
+    //run() checks every iterationsPerStep iterations if 'fileName' exists. if it does, the first word in it
+    //is executed ("snapshot": save a report of the current alignment, "stop": end the run), and it is deleted
+    void setControlFile(const string& fileName);
+
+    /* For methods that run several anneals at once (e.g., Portfolio). The method installs the signal
+    handlers once with setInterruptSignal, makes each anneal externally controlled, and passes the
+    requests it gets from pollControlRequests to all of them with addControlRequests. An externally
+    controlled run() only reacts to the requests passed on to it, and does not install the handlers
+    or read the control file itself */
+    static void setInterruptSignal();
+    void setExternalControl();
+    int pollControlRequests();
+    void addControlRequests(int requests);
+
+    //if true (default), the iterations per second needed to turn a time limit into a number of
+    //iterations are read from a cache instead of measured, when there is a cached value for the
+    //same graphs, objective, build and CPU. every run() stores the speed it actually had in the cache
+    void setUseIpsCache(bool use);
+
+    //probability of drawing a move among the top-k sims of its peg (see drawTopKMove); only in top-k mode
+    void setTopKMoveProb(double prob);
+
 private:
     Alignment startA;
 
     bool addHillClimbing; //for post-run hill climbing
     void performHillClimbing(long long int idleCountTarget);
+    //iterations without improvement after which the hill climbing of addHillClimbing ends
+    static const long long int HILL_CLIMBING_IDLE_ITERATIONS;
 
     //temperature schedule
     double TInitial, TFinal, TDecay;
@@ -59,6 +129,8 @@ private:
     int numPBadsInBuffer;
     int pBadBufferIndex;
     double pBadBufferSum;
+    uint pBadSampleInterval;
+    uint badMovesSinceLastSample;
 
     //may incorrect probabilities (even negative) if the pbads in the buffer are small enough
     //due to accumulated precision errors of adding and subtracting tiny values from pBadBufferSum
@@ -68,6 +140,15 @@ private:
     //this takes linear time instead of constant, hence the name
     double slowMeanPBad();
 
+    long long int numPBadsSampled; //number of pBads added to the buffer since initDataStructures
+    double meanOfLastPBads(int count); //mean of the 'count' pBads most recently added to the buffer
+
+    //equilibrium test of getPBad. 'blockMeans' are the mean pBads of consecutive blocks of iterations.
+    //true if their trend is not statistically significant and their mean is a precise estimate
+    static bool pBadBlocksAtEquilibrium(const vector<double>& blockMeans);
+    static constexpr double PBAD_EQ_MAX_T_STATISTIC = 2;
+    static constexpr double PBAD_EQ_MAX_RELATIVE_ERROR = 0.05;
+
     //store whether or not most recent move was bad
     bool wasBadMove;
 
@@ -79,8 +160,10 @@ private:
     double g1TotalWeight, g2TotalWeight;
 
     //random number generation
-    mt19937 gen;
-    uniform_real_distribution<> randomReal;
+    //every random choice in the main loop uses 'gen' (and not the global generator in utils)
+    //so that several SANA objects can iterate concurrently in different threads
+    //use gen.boundedInt(n) and gen.real01() rather than the standard distributions, which are slower
+    Xoshiro256 gen;
 
     //execution time is delimited by either maxSeconds or maxIterations
     //exactly one of them can be > 0 
@@ -103,11 +186,21 @@ private:
     double temperatureFunction(long long int iter, double TInitial, double TDecay);
     double acceptingProbability(double energyInc, double Temperature);
 
+    //returns true with probability acceptingProbability(energyInc, Temperature)
+    //in most cases the decision is taken by comparing against polynomial bounds of exp(energyInc/Temperature),
+    //so exp is rarely evaluated
+    bool acceptMove(double energyInc, double Temperature);
+
 
     double iterPerSecond;
     double getIterPerSecond();
     bool initializedIterPerSecond;
     void initIterPerSecond();
+    bool useIpsCache;
+    static const string IPS_CACHE_FOLDER;
+    string ipsCacheFileName() const; //the name contains a hash of everything the speed depends on
+    bool readCachedIps(double& ips) const; //returns false if there is no cached value
+    void writeCachedIps(double ips) const;
     void constantTempIterations(long long int iterTarget);
 
     //initializes the data structures specific to the starting alignment
@@ -119,16 +212,23 @@ private:
     //objective function
     MeasureCombination* MC;
     double eval(const Alignment& A) const;
-    double ecWeight, edWeight, erWeight, s3Weight, icsWeight, wecWeight, jsWeight, secWeight,
-           ncWeight, localWeight, mecWeight, sesWeight, eeWeight, ms3Weight, ewecWeight;
+    double ecWeight, s3Weight, icsWeight, wecWeight, secWeight,
+           localWeight, mecWeight, sesWeight, eeWeight, ms3Weight, ewecWeight;
+
+    //measures evaluated through the IncrementalMeasure interface. to evaluate a new measure
+    //incrementally, implement the interface in the measure and add its type to this list
+    typedef IncrementalMeasureSet<EdgeDifference::Incremental, EdgeRatio::Incremental,
+            JaccardSimilarityScore::Incremental, NodeCorrectness::Incremental> IncrementalMeasures;
+    IncrementalMeasures incMeasures;
 
-    //this should be refactored so that the return parameter is not the 9th one out of 15
+    //this should be refactored so that the return parameter is not the 5th one out of 9
     // changed in June 2020 to return pBad, not the decision itself. -WH
-    double scoreComparison(double newAligEdges, double newInducedEdges,
-        double newLocalScoreSum, double newWecSum, 
-        double newJsSum, double newNcSum, double& newCurrentScore, 
-        double newEwecSum, double newSquaredAligEdges, double newExposedEdgesNumer, 
-        double newMS3Numer, double newEdgeDifferenceSum, double newEdgeRatioSum);
+    // changed back to return the decision, so that pBad is not computed for every move
+    //the proposed scores of the measures in incMeasures are read from incMeasures
+    bool scoreComparison(double newAligEdges, double newInducedEdges,
+        double newLocalScoreSum, double newWecSum, double& newCurrentScore,
+        double newEwecSum, double newSquaredAligEdges, double newExposedEdgesNumer,
+        double newMS3Numer);
 
     enum class ScoreAggregation{sum, product, inverse, max, min, maxFactor};
     ScoreAggregation scoreAggr;
@@ -138,17 +238,8 @@ private:
     //to evaluate EC incrementally
     bool needAligEdges;
     int aligEdges;
-    int aligEdgesIncChangeOp(uint peg, uint oldHole, uint newHole);
     int aligEdgesIncSwapOp(uint peg1, uint peg2, uint hole1, uint hole2);
 
-    // to evaluate ED (edge difference score) incrementally
-    bool needEd, needEr;
-    double edSum, erSum;
-    double edgeDifferenceIncChangeOp(uint peg, uint oldHole, uint newHole);
-    double edgeDifferenceIncSwapOp(uint peg1, uint peg2, uint hole1, uint hole2);
-    double edgeRatioIncChangeOp(uint peg, uint oldHole, uint newHole);
-    double edgeRatioIncSwapOp(uint peg1, uint peg2, uint hole1, uint hole2);
-
     // to evaluate SES incrementally
     bool needSquaredAligEdges;
     int squaredAligEdges;
@@ -157,6 +248,7 @@ private:
 
     // to evaluate EE incrementally
     bool needExposedEdges;
+    int exposedEdgesNumer;
     int exposedEdgesIncChangeOp(uint peg, uint oldHole, uint newHole);
     int exposedEdgesIncSwapOp(uint peg1, uint peg2, uint hole1, uint hole2);
     
@@ -169,6 +261,11 @@ private:
 	RA_k, // |RA_k| where RA_k = rungs under edges, ie rungs under edges in ER_k.
 	RU_k, // |RU_k| where RU_k = rungs under non-edges in G
 	RO_k; // |RO_k| where RO_k = rungs outside, ie rungs with at least one endpoint not under a peg.
+    uint MS3Denom;
+    double MS3NormalizationFactor;
+    vector<uint> shadowDegree; // sum of neighboring edge weights including G1, for each node of G2
+    vector<uint> whichPeg; // inverse of the alignment (n1 for unassigned holes), updated on every accepted move
+    bool needWhichPeg; // MS3 or top-k moves
     int MS3IncChangeOp(uint peg, uint oldHole, uint newHole);
     int MS3IncSwapOp(uint peg1, uint peg2, uint hole1, uint hole2);
 
@@ -183,40 +280,83 @@ private:
                            // make computation go wrong.
     int inducedEdgesIncChangeOp(uint peg, uint oldHole, uint newHole);
 
-    //to evaluate nc incrementally
-    bool needNC;
-    int ncSum;
-    vector<uint> trueAWithValidCountAppended;
-    int ncIncChangeOp(uint peg, uint oldHole, uint newHole);
-    int ncIncSwapOp(uint peg1, uint Peg2, uint node1, uint node2);
-
     //to evaluate wec incrementally
     bool needWec;
     double wecSum;
-    vector<vector<float>> wecSims;
-    double WECIncChangeOp(uint peg, uint oldHole, uint newHole);
+    const Matrix<float>* wecSims = nullptr; //owned by the wec measure
+    const QuantizedMatrix* quantizedWecSims = nullptr; //instead of wecSims, in reduced precision
+    const ImplicitSims* implicitWecSims = nullptr; //instead of wecSims, if the node sims are implicit
+    float wecSim(uint peg, uint hole) const {
+        if (implicitWecSims) return implicitWecSims->get(peg, hole);
+        return quantizedWecSims ? quantizedWecSims->get(peg, hole) : (*wecSims)[peg][hole];
+    }
     double WECIncSwapOp(uint peg1, uint Peg2, uint node1, uint node2);
 
-    //to evaluate js incrementally
-    bool needJs;
-    double jsSum;
-    vector<uint> alignedByNode;
-    double JSIncChangeOp(uint peg, uint oldHole, uint newHole);
-    double JSIncSwapOp(uint peg1, uint Peg2, uint node1, uint node2);
-
     //to evaluate ewec incrementally
     bool needEwec;
     ExternalWeightedEdgeConservation* ewec;
     double ewecSum;
-    double EWECIncChangeOp(uint peg, uint oldHole, uint newHole);
     double EWECIncSwapOp(uint peg1, uint Peg2, uint node1, uint node2);
     double EWECSimCombo(uint peg, uint node);
 
+    //change deltas of EC (the aligned edges), WEC and EWEC. all of them depend on the G2 edges
+    //between the holes and the images of the peg's neighbors, so they are computed together in a
+    //single traversal of the peg's neighborhood that looks up each of those edges once.
+    //with HOOKS, the traversal also drives the change proposals of the measures in incMeasures that
+    //have NEIGHBORHOOD_HOOKS (JS), whose results are read from incMeasures.
+    //there is an instantiation for each combination of these measures; the constructor picks the
+    //one for the measures in use, so the others cost nothing. the results are the same, bit for bit,
+    //as computing each measure in its own traversal
+    struct NeighborhoodDeltas { int aligEdges; double wec, ewec; };
+    template<bool EC, bool WEC, bool HOOKS, bool EWEC>
+    NeighborhoodDeltas neighborhoodIncChangeOp(uint peg, uint oldHole, uint newHole);
+    typedef NeighborhoodDeltas (SANA::*NeighborhoodChangeOp)(uint peg, uint oldHole, uint newHole);
+    NeighborhoodChangeOp neighborhoodChangeOp; //nullptr if none of the 4 is used
+
+    //returns &neighborhoodIncChangeOp<Enabled..., followed by the values of the arguments>
+    template<bool... Enabled, typename... Bools>
+    static NeighborhoodChangeOp selectNeighborhoodChangeOp(bool enabled, Bools... rest);
+    template<bool... Enabled>
+    static NeighborhoodChangeOp selectNeighborhoodChangeOp();
+
+    //G2's bit-packed adjacency matrix (Graph::getAdjBits), whose rows are read by the SIMD kernel
+    //of rowBitDifference to count the aligned edges gained and lost when a peg moves between two holes.
+    //only set for unweighted graphs when EC is the only measure of the neighborhood traversal, without hooks
+    //(otherwise it is null)
+    const BitMatrix* g2BitRows = nullptr;
+    //aligned edges gained minus lost by the edges of 'peg' other than its self-loop
+    //if it moves from oldHole to newHole, using g2BitRows
+    int aligEdgesBitRowsDifference(uint peg, uint oldHole, uint newHole);
+    NeighborhoodDeltas aligEdgesBitRowsChangeOp(uint peg, uint oldHole, uint newHole);
+
     //to evaluate local measures incrementally
     bool needLocal;
     double localScoreSum;
-    map<string, double> localScoreSumMap;
-    vector<vector<float>> sims;
+    //the local measures separately, indexed by local measure id (only if there are 2+ local measures).
+    //they are only used to report each measure's score in the progress lines (see localMeasureScoreSum)
+    vector<string> localMeasureNames;
+    //the matrices of the measures are not scaled by their weights, which are in localSimWeights
+    vector<const Matrix<float>*> localSimMatrices; //views owned by MC
+    vector<double> localSimWeights;
+    const Matrix<float>* sims = nullptr; //owned by MC
+    //in top-k mode (see LocalMeasure::setTopK), these are used instead of sims and localSimMatrices,
+    //which are null and empty
+    const TopKSimMatrix* topSims = nullptr; //owned by MC
+    vector<const TopKSimMatrix*> localTopSims; //owned by the measures
+    //same for reduced precision (see LocalMeasure::setPrecision)
+    const QuantizedMatrix* quantizedSims = nullptr; //owned by MC
+    vector<const QuantizedMatrix*> localQuantizedSims; //owned by the measures
+    //the measures with implicit sims (see LocalMeasure::setImplicit), which are not in any of the above:
+    //in top-k mode or reduced precision, the aggregated sim of a pair is the entry of the aggregated matrix
+    //(if there is one, as there are no matrices if all the local measures are implicit) plus the weighted
+    //implicit sims of the pair; with dense matrices, it is read from localSimSum (see below).
+    //with 2+ local measures, their ids come after those of the measures with matrices
+    vector<const ImplicitSims*> localImplicitSims; //owned by the measures
+    vector<double> implicitSimWeights;
+    //with dense matrices, the aggregated sims are read from this instead of sims, unless sims is the matrix
+    //of a single measure with weight 1. it takes no memory besides the matrices of the measures, and the
+    //sums are rounded like the entries of the aggregated matrix, so SANA finds the same alignments
+    LocalSimSum localSimSum;
 
     //to evaluate core scores    
 #ifdef CORES
@@ -224,32 +364,124 @@ private:
     CoreScoreData coreScoreData;
 #endif
 
-    map<string, vector<vector<float>>> localSimMatrixMap;
-    double localScoreSumIncChangeOp(const vector<vector<float>>& sim, uint peg, uint oldHole, uint newHole);
-    double localScoreSumIncSwapOp(const vector<vector<float>>& sim, uint peg1, uint Peg2, uint node1, uint node2);
+    //SimMatrix is Matrix<float>, TopKSimMatrix, QuantizedMatrix, ImplicitSims or LocalSimSum
+    template <typename SimMatrix>
+    double localScoreSumIncChangeOp(const SimMatrix& sim, uint peg, uint oldHole, uint newHole);
+    template <typename SimMatrix>
+    double localScoreSumIncSwapOp(const SimMatrix& sim, uint peg1, uint Peg2, uint node1, uint node2);
+    //the same, for the aggregated sims, whichever matrix holds them
+    double aggregatedLocalSim(uint peg, uint hole) const;
+    double aggregatedLocalScoreSumIncChangeOp(uint peg, uint oldHole, uint newHole);
+    double aggregatedLocalScoreSumIncSwapOp(uint peg1, uint peg2, uint hole1, uint hole2);
+    //weighted sum of the sims of local measure k over the current alignment, computed from scratch in O(n1)
+    double localMeasureScoreSum(uint k) const;
 
     //other execution options
     bool constantTemp; //tempertare does not decrease as a function of iteration
     bool enableTrackProgress; //shows output periodically
     void trackProgress(long long int iter, long long int maxIter = -1);
+    string progressLabel;
+    string snapshotSuffix;
+    unsigned long long allocationsAfterLastProgress = 0;
     double avgEnergyInc;
 
     double currentScore;
     double previousScore;
     double energyInc;
     void SANAIteration();
-    void performChange(uint activeColorId);
-    void performSwap(uint activeColorId);
+
+    //the random choices that define a move. for a change, peg1 moves to the unassigned G2 node at
+    //actColToUnassignedG2Nodes[actColId][unassignedVecIndex]; for a swap, peg1 and peg2 swap holes
+    struct Move {
+        bool isChange;
+        uint actColId, peg1, peg2, unassignedVecIndex;
+    };
+    //draws a move with 'rng', taking the random numbers in the same order as always,
+    //so the moves for a given seed do not depend on how they are drawn
+    Move drawMove(Xoshiro256& rng) const;
+    /* Top-k moves (only if topKMoveProb > 0): with probability topKMoveProb, once peg1 is drawn, the move
+    is replaced by one that takes peg1 to a random hole among its top-k sims: a change if that hole is
+    unassigned or a swap with its peg otherwise. If the hole is peg1's own hole or has another color,
+    the move is the uniform one. unassignedIndex[hole] is the position of each unassigned hole in
+    actColToUnassignedG2Nodes[its active color], updated on every accepted change */
+    double topKMoveProb = 0;
+    vector<uint> unassignedIndex;
+    bool drawTopKMove(Move& move, Xoshiro256& rng) const;
+    void initHoleIndices(); //whichPeg and unassignedIndex, from A and actColToUnassignedG2Nodes
+    void performChange(const Move& move);
+    void performSwap(const Move& move);
+
+    //profiling (see Profiler), only if it is enabled
+    //one in every PROFILE_SAMPLE_INTERVAL iterations is sampled: each delta function is timed,
+    //and whether the move was a change or a swap, and whether it was accepted, is counted.
+    //the proposals of incMeasures are timed in the entries that follow the DeltaFunction ones
+    static const uint PROFILE_SAMPLE_INTERVAL = 1024; //power of 2
+    bool profiling;
+    bool profileThisIteration = false;
+    enum DeltaFunction {
+        NEIGHBORHOOD_CHANGE,
+        SQUARED_ALIG_EDGES_CHANGE,
+        EXPOSED_EDGES_CHANGE,
+        MS3_CHANGE,
+        INDUCED_EDGES_CHANGE,
+        LOCAL_SCORE_SUM_CHANGE,
+        ALIG_EDGES_SWAP,
+        SQUARED_ALIG_EDGES_SWAP,
+        EXPOSED_EDGES_SWAP,
+        MS3_SWAP,
+        WEC_SWAP,
+        EWEC_SWAP,
+        LOCAL_SCORE_SUM_SWAP,
+        NUM_DELTA_FUNCTIONS
+    };
+    static const char* DELTA_FUNCTION_NAMES[NUM_DELTA_FUNCTIONS];
+    //indexed by DeltaFunction, then the change and the swap proposals of each measure in incMeasures
+    vector<unsigned long long> deltaTicks, deltaSamples;
+    unsigned long long sampledChanges, acceptedSampledChanges, sampledSwaps, acceptedSampledSwaps;
+    void resetLoopProfile();
+
+    //returns f(). if the iteration is sampled, also adds the ticks that f took to the profile of 'id'
+    template<typename F>
+    auto profiled(DeltaFunction id, F f) -> decltype(f()) {
+        if (not profileThisIteration) return f();
+        unsigned long long start = Profiler::ticks();
+        auto res = f();
+        deltaTicks[id] += Profiler::ticks()-start;
+        deltaSamples[id]++;
+        return res;
+    }
 
     Timer timer;
 
-    //Control+C during execution offers options
-    //exit, save alignment and exit, save alignment and continue
-    static void setInterruptSignal(); 
-    void printReportOnInterruption();
-public: //these need to be public to be set from the interruption handler
-    static bool saveAligAndExitOnInterruption;
-    static bool saveAligAndContOnInterruption;
+    //checkpoints
+    string checkpointFileName;
+    double checkpointIntervalSeconds = 0;
+    double lastCheckpointTime = 0;
+    string resumeFileName;
+    //ScheduleCache::objectiveHash of MC and the score aggregation. a checkpoint can only be
+    //resumed with the same one
+    uint64_t objectiveHash;
+    //saves everything needed to continue run() from iteration iter+1. the state is copied into a
+    //buffer in the calling thread and written to disk in the background
+    void saveCheckpoint(long long int iter, long long int maxIters);
+    //restores the state saved by saveCheckpoint, and returns the iteration at which it was saved
+    long long int loadCheckpoint(const string& fileName, long long int& maxIters);
+
+    /* Control of the run without pausing the anneal. Requests come from:
+    - Control+C, which offers options interactively (continue, exit, save alignment and exit,
+      save alignment and continue) if the input is a terminal, and otherwise requests a stop
+    - the signals SIGUSR1 (save a snapshot) and SIGUSR2 (stop), meant for batch jobs
+    - the control file (see setControlFile)
+    The requests are flags in 'controlRequests', which run() checks once every iterationsPerStep iterations
+    (or in 'externalRequests', if the run is externally controlled; see setExternalControl).
+    Stopping ends the run early as if it had finished, so the final alignment is saved as usual */
+    bool handleControlRequests(); //returns true if a stop was requested
+    void saveSnapshot(); //saves a report of the current alignment from a background thread
+    string controlFileName;
+    shared_ptr<atomic<int>> externalRequests; //null unless the run is externally controlled
+public: //these need to be public to be set from the signal handlers
+    enum ControlRequest { SNAPSHOT_REQUEST = 1, STOP_REQUEST = 2 };
+    static atomic<int> controlRequests;
 private:
 
     string outputFileName;
@@ -274,7 +506,7 @@ private:
 
     // The mechanism for choosing a neighbor of an alignment uniformly at random is done in 4 steps:
     // 1. an active color is chosen randomly weighted by their number of neighbors
-    uint randActiveColorIdWeightedByNumNbrs(); //not const because of RNG
+    uint randActiveColorIdWeightedByNumNbrs(Xoshiro256& rng) const;
 
     /* Data structure to implement step 1. index i contains the accumulated probability of choosing
     any of the active colors with active color id <= i. The last value is 1 (by definition).
@@ -288,7 +520,7 @@ private:
 
     //3. the peg node (or pair of Peg nodes, for a swap) are chosen randomly from G1 among the
     //nodes of the chosen color
-    uint randomG1NodeWithActiveColor(uint actColId) const;
+    uint randomG1NodeWithActiveColor(uint actColId, Xoshiro256& rng) const;
     vector<uint> actColToG1ColId; //to implement step 3.
 
     //4. same with target nodes
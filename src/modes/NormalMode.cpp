@@ -4,6 +4,10 @@
 #include <iostream>
 #include "../utils/utils.hpp"
 #include "../utils/FileIO.hpp"
+#include "../utils/Profiler.hpp"
+#include "../utils/AlignedAllocator.hpp"
+#include "../measures/localMeasures/LocalMeasure.hpp"
+#include "../measures/localMeasures/SimMatrixCache.hpp"
 #include "../arguments/measureSelector.hpp"
 #include "../arguments/MethodSelector.hpp"
 #include "../arguments/GraphLoader.hpp"
@@ -15,23 +19,41 @@ void NormalMode::run(ArgumentParser& args) {
     //before loading graphs, check that the user did not forget to provide the execution time/iter
     //this is just to detect this common mistake early
     if (args.strings["-method"] == "sana") MethodSelector::validateTimeOrIterLimit(args);
+    if (args.bools["-profile"]) Profiler::enable();
+    if (args.bools["-hugepages"]) setUseHugePages(true);
+    Graph::setAdjacencyRepresentation(args.strings["-adjacency"]);
+    if (args.bools["-nosimcache"]) SimMatrixCache::setEnabled(false);
+    LocalMeasure::setTopK((uint) args.doubles["-simtopk"]);
+    LocalMeasure::setPrecision(parseSimPrecision(args.strings["-simPrecision"]));
+    if (args.bools["-implicitsims"]) LocalMeasure::setImplicit(true);
 
+    Profiler::ScopedPhase graphPhase("graph loading");
     pair<Graph, Graph> graphs = GraphLoader::initGraphs(args);
     Graph G1 = graphs.first;
     Graph G2 = graphs.second;
+    graphPhase.stop();
 
     MeasureCombination M;
+    Profiler::ScopedPhase measurePhase("measure initialization");
     measureSelector::initMeasures(M, G1, G2, args); 
+    measurePhase.stop();
     Method* method;
+    Profiler::ScopedPhase methodPhase("method initialization");
     method = MethodSelector::initMethod(G1, G2, args, M);
+    methodPhase.stop();
+    Profiler::ScopedPhase runPhase("method run");
     Alignment A = method->runAndPrintTime();
+    runPhase.stop();
     A.printDefinitionErrors(G1,G2);
     assert(A.isCorrectlyDefined(G1, G2) and "Resulting alignment is not correctly defined");
 
     string fileName = args.strings["-o"];
     bool longReport = (args.bools["-multi-iteration-only"] ? false : true);
+    Profiler::ScopedPhase reportPhase("saveReport");
     Report::saveReport(G1, G2, A, M, method, fileName, longReport);
+    reportPhase.stop();
     Report::saveLocalMeasures(G1, G2, A, M, method, args.strings["-localScoresFile"]);
+    if (Profiler::isEnabled()) Report::saveProfile(G1, G2, A, method, fileName);
     delete method;
 }
 
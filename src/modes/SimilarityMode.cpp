@@ -17,7 +17,7 @@ void SimilarityMode::run(ArgumentParser& args) {
         exit(-1);
     }
 
-    vector<vector <float>> sim = M.getAggregatedLocalSims();
+    const Matrix<float>& sim = M.getAggregatedLocalSims();
 
     assert(args.doubleVectors["-simFormat"].size() == 1);
     saveSimilarityMatrix(sim, G1, G2, args.strings["-o"] + ".sim", args.doubleVectors["-simFormat"][0]);
@@ -25,7 +25,7 @@ void SimilarityMode::run(ArgumentParser& args) {
     cout << "Finished. Saved similarity file as " << (args.strings["-o"] + ".sim") << endl;
 }
 
-void SimilarityMode::saveSimilarityMatrix(const vector<vector<float>>& sim, 
+void SimilarityMode::saveSimilarityMatrix(const Matrix<float>& sim, 
         const Graph& G1, const Graph& G2, const string& fileName, int format) {
     ofstream ofs(fileName);
     if (not ofs.is_open()) {
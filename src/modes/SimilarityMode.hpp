@@ -13,7 +13,7 @@ class SimilarityMode : public Mode {
 public:
     void run(ArgumentParser& args);
     string getName();
-    void saveSimilarityMatrix(const vector<vector <float>>& sim, 
+    void saveSimilarityMatrix(const Matrix<float>& sim, 
     	const Graph& G1, const Graph& G2, const string& file, int format);
 };
 
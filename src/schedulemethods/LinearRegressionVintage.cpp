@@ -28,11 +28,13 @@ void LinearRegressionVintage::computeBoth(ScheduleMethod::Resources maxRes) {
     double log_temp = -1;
     map<double, double> pBadMap;
 
+    vector<double> sweepTemps;
     for(T_i = 0; T_i <= log10NumSteps; T_i++){
         log_temp = log10LowTemp + T_i*(log10HighTemp-log10LowTemp)/log10NumSteps;
-        pBadMap[pow(10,log_temp)] = getPBad(pow(10, log_temp));
-        // cout << T_i << " temperature: " << pow(10, log_temp) << " pBad: " << pbadMap[log_temp] << " score: " << eval(*A) << endl;
+        sweepTemps.push_back(pow(10, log_temp));
     }
+    vector<double> sweepPBads = getPBads(sweepTemps);
+    for (uint i = 0; i < sweepTemps.size(); i++) pBadMap[sweepTemps[i]] = sweepPBads[i];
     for (T_i=0; T_i <= log10NumSteps; T_i++){
         log_temp = log10LowTemp + T_i*(log10HighTemp-log10LowTemp)/log10NumSteps;
         if(pBadMap[pow(10,log_temp)] > targetFinalPBad)
@@ -41,16 +43,10 @@ void LinearRegressionVintage::computeBoth(ScheduleMethod::Resources maxRes) {
 
     double binarySearchLeftEnd = log10LowTemp + (T_i-1)*(log10HighTemp-log10LowTemp)/log10NumSteps;
     double binarySearchRightEnd = log_temp;
-    double mid = (binarySearchRightEnd + binarySearchLeftEnd) / 2;
     cout << "Increasing sample density near TFinal. " << " range: (" << pow(10, binarySearchLeftEnd) << ", " << pow(10, binarySearchRightEnd) << ")" << endl;
-    for(int j = 0; j < LinearRegressionVintage::EXTRA_SAMPLES; ++j) {
-        double temperature = pow(10, mid);
-        double probability = getPBad(temperature);
-        pBadMap[temperature] = probability;
-        if(probability > targetFinalPBad) binarySearchRightEnd = mid;
-        else binarySearchLeftEnd = mid;
-        mid = (binarySearchRightEnd + binarySearchLeftEnd) / 2;
-    }
+    auto range = log10TempRangeSearch(binarySearchLeftEnd, binarySearchRightEnd, targetFinalPBad,
+                                      LinearRegressionVintage::EXTRA_SAMPLES, pBadMap);
+    double mid = (range.first + range.second) / 2;
     for (T_i = log10NumSteps; T_i >= 0; T_i--){
         log_temp = log10LowTemp + T_i*(log10HighTemp-log10LowTemp)/log10NumSteps;
         if(pBadMap[pow(10,log_temp)] < targetInitialPBad)
@@ -59,16 +55,10 @@ void LinearRegressionVintage::computeBoth(ScheduleMethod::Resources maxRes) {
 
     binarySearchLeftEnd = log_temp;
     binarySearchRightEnd = log10LowTemp + (T_i+1)*(log10HighTemp-log10LowTemp)/log10NumSteps;
-    mid = (binarySearchRightEnd + binarySearchLeftEnd) / 2;
     cout << "Increasing sample density near TInitial. " << "range: (" << pow(10, binarySearchLeftEnd) << ", " << pow(10, binarySearchRightEnd) << ")" << endl;
-    for(int j = 0; j < LinearRegressionVintage::EXTRA_SAMPLES; ++j){
-        double temperature = pow(10, mid);
-        double probability = getPBad(temperature);
-        pBadMap[temperature] = probability;
-        if(probability < targetInitialPBad) binarySearchLeftEnd = mid;
-        else binarySearchRightEnd = mid;
-        mid = (binarySearchRightEnd + binarySearchLeftEnd) / 2;
-    }
+    range = log10TempRangeSearch(binarySearchLeftEnd, binarySearchRightEnd, targetInitialPBad,
+                                 LinearRegressionVintage::EXTRA_SAMPLES, pBadMap);
+    mid = (range.first + range.second) / 2;
 
     unsigned int minSamples = LinearRegression::MIN_NUM_SAMPLES_REQUIRED;
     // this is true when the upper and lower temperature bounds are equal, causing only one sample to be taken. This is insufficient for Linear Regression.
@@ -80,8 +70,9 @@ void LinearRegressionVintage::computeBoth(ScheduleMethod::Resources maxRes) {
         while (pBadMap.size() < minSamples) {
             temperatureIncrease *= 1.1;
             temperatureDecrease *= .9;
-            pBadMap[temperatureIncrease] = getPBad(temperatureIncrease);
-            pBadMap[temperatureDecrease] = getPBad(temperatureDecrease);
+            vector<double> pBads = getPBads({temperatureIncrease, temperatureDecrease});
+            pBadMap[temperatureIncrease] = pBads[0];
+            pBadMap[temperatureDecrease] = pBads[1];
         }
     }
 
@@ -0,0 +1,104 @@
+#include <iostream>
+#include <fstream>
+#include <iomanip>
+#include <limits>
+#include <cstdio>
+#include <unistd.h>
+
+#include "ScheduleCache.hpp"
+#include "../utils/utils.hpp"
+#include "../utils/FileIO.hpp"
+#include "../measures/WeightedEdgeConservation.hpp"
+#include "../measures/localMeasures/LocalMeasure.hpp"
+
+using namespace std;
+
+const string ScheduleCache::FOLDER = "autogenerated/schedules/";
+const uint ScheduleCache::ALGORITHM_VERSION = 1;
+
+uint64_t ScheduleCache::objectiveHash(const MeasureCombination& MC, const string& scoreAggregation, uint64_t hash) {
+    for (uint i = 0; i < MC.numMeasures(); i++) {
+        Measure* m = MC.getMeasure(i);
+        double weight = MC.getWeight(m->getName());
+        if (weight <= 0) continue;
+        hash = hashString(m->getName(), hash);
+        hash = hashBytes(&weight, sizeof(weight), hash);
+        LocalMeasure* sims = nullptr;
+        if (m->isLocal()) sims = (LocalMeasure*) m;
+        else if (m->getName() == "wec") sims = ((WeightedEdgeConservation*) m)->getNodeSimMeasure();
+        if (sims) {
+            hash = hashString(sims->getName(), hash);
+            uint64_t paramsHash = sims->getParamsHash();
+            hash = hashBytes(&paramsHash, sizeof(paramsHash), hash);
+        }
+    }
+    hash = hashString(scoreAggregation, hash);
+    uint topK = LocalMeasure::getTopK();
+    hash = hashBytes(&topK, sizeof(topK), hash);
+    hash = hashString(simPrecisionName(LocalMeasure::getPrecision()), hash);
+    bool implicit = LocalMeasure::isImplicit();
+    return hashBytes(&implicit, sizeof(implicit), hash);
+}
+
+uint64_t ScheduleCache::curveKey(const Graph& G1, const Graph& G2, const MeasureCombination& MC,
+        const string& scoreAggregation) {
+    uint64_t key = G1.contentHash();
+    key = hashBytes(&key, sizeof(key), G2.contentHash());
+    key = objectiveHash(MC, scoreAggregation, key);
+    return hashBytes(&ALGORITHM_VERSION, sizeof(ALGORITHM_VERSION), key);
+}
+
+string ScheduleCache::fileName(const Graph& G1, const Graph& G2, const MeasureCombination& MC,
+        const string& scoreAggregation, const string& methodName,
+        double targetInitialPBad, double targetFinalPBad) {
+    uint64_t key = curveKey(G1, G2, MC, scoreAggregation);
+    key = hashString(methodName, key);
+    key = hashBytes(&targetInitialPBad, sizeof(targetInitialPBad), key);
+    key = hashBytes(&targetFinalPBad, sizeof(targetFinalPBad), key);
+    return FOLDER+G1.getName()+"_"+G2.getName()+"_"+hashToHex(key)+".txt";
+}
+
+string ScheduleCache::curveFileName(const Graph& G1, const Graph& G2, const MeasureCombination& MC,
+        const string& scoreAggregation, bool warmStart) {
+    uint64_t key = curveKey(G1, G2, MC, scoreAggregation);
+    key = hashBytes(&warmStart, sizeof(warmStart), key);
+    return FOLDER+G1.getName()+"_"+G2.getName()+"_curve_"+hashToHex(key)+".txt";
+}
+
+bool ScheduleCache::load(const string& fileName, Entry& entry) {
+    if (not FileIO::fileExists(fileName)) return false;
+    vector<vector<string>> lines = FileIO::fileToWordsByLines(fileName);
+    try {
+        if (lines.size() < 3 or lines[0].size() != 2 or lines[0][0] != "Version"
+                or stoul(lines[0][1]) != ALGORITHM_VERSION
+                or lines[1].size() != 2 or lines[1][0] != "TInitial"
+                or lines[2].size() != 2 or lines[2][0] != "TFinal")
+            return false;
+        entry.TInitial = stod(lines[1][1]);
+        entry.TFinal = stod(lines[2][1]);
+        //the rest of the lines are the pBad samples, one "temp pBad" per line
+        entry.tempToPBad.clear();
+        for (uint i = 3; i < lines.size(); i++) {
+            if (lines[i].size() != 2) return false;
+            entry.tempToPBad.insert({stod(lines[i][0]), stod(lines[i][1])});
+        }
+    } catch (...) {
+        return false;
+    }
+    return entry.TInitial > 0 and entry.TFinal > 0;
+}
+
+void ScheduleCache::save(const string& fileName, const Entry& entry) {
+    FileIO::createFolder(FOLDER);
+    //written under a temporary name and renamed, in case another SANA process is reading it
+    string tmpFileName = fileName+".tmp"+to_string(getpid());
+    ofstream ofs(tmpFileName);
+    ofs << setprecision(numeric_limits<double>::max_digits10);
+    ofs << "Version " << ALGORITHM_VERSION << endl;
+    ofs << "TInitial " << entry.TInitial << endl;
+    ofs << "TFinal " << entry.TFinal << endl;
+    for (const auto& tempPBad : entry.tempToPBad)
+        ofs << tempPBad.first << " " << tempPBad.second << endl;
+    ofs.close();
+    if (not ofs or rename(tmpFileName.c_str(), fileName.c_str()) != 0) remove(tmpFileName.c_str());
+}
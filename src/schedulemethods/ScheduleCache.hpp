@@ -0,0 +1,59 @@
+#ifndef SCHEDULECACHE_HPP
+#define SCHEDULECACHE_HPP
+
+#include <string>
+#include <map>
+#include "../Graph.hpp"
+#include "../measures/MeasureCombination.hpp"
+
+using namespace std;
+
+/* Persistent cache of the temperature schedules found by the schedule methods.
+Runs of the same pair of networks with the same objective function (typically with
+different seeds) can reuse the schedule instead of sampling pBads again.
+There is one text file per key in autogenerated/schedules/. The key is a hash of the contents of
+both graphs, the objective function, the schedule method and its target pBads, and the version of
+the pBad sampling (ALGORITHM_VERSION), which is also written in the file.
+The objective function includes everything that changes the pBads: the measures and their weights
+(in full precision), the score aggregation (-combinedScoreAs), the parameters of the sims of each
+local measure and of the node sims of wec (LocalMeasure::getParamsHash), and how the sims are kept
+(-simtopk, -simPrecision and -implicitsims).
+Each file also has the pBad samples (tempToPBad) taken to find the schedule. They are also saved in a
+second file whose key leaves out the schedule method and its target pBads (see curveFileName), so a run
+that only changes those can warm-start its temperature search from the samples of the previous one */
+class ScheduleCache {
+public:
+    struct Entry {
+        double TInitial, TFinal;
+        multimap<double, double> tempToPBad; //the pBad samples taken to find the temperatures
+    };
+
+    static string fileName(const Graph& G1, const Graph& G2, const MeasureCombination& MC,
+                           const string& scoreAggregation, const string& methodName,
+                           double targetInitialPBad, double targetFinalPBad);
+    //the file of the last entry computed for the same graphs, objective function and way of sampling the
+    //pBads ('warmStart' is -warmstartpbad), with any schedule method and target pBads
+    static string curveFileName(const Graph& G1, const Graph& G2, const MeasureCombination& MC,
+                                const string& scoreAggregation, bool warmStart);
+
+    //returns false if the file does not exist or is not a valid entry
+    static bool load(const string& fileName, Entry& entry);
+    static void save(const string& fileName, const Entry& entry);
+
+    //hash of the objective function, as described above. checkpoints also use it, to refuse
+    //resuming a run with a different objective function
+    static uint64_t objectiveHash(const MeasureCombination& MC, const string& scoreAggregation,
+                                  uint64_t hash = 14695981039346656037ULL);
+
+private:
+    //hash of both graphs, the objective function and ALGORITHM_VERSION
+    static uint64_t curveKey(const Graph& G1, const Graph& G2, const MeasureCombination& MC,
+                             const string& scoreAggregation);
+
+    static const string FOLDER;
+    //identifies how the pBads are sampled (SANA::getPBad and its equilibrium test). it should be
+    //increased whenever that changes, so that the schedules found the old way are not reused
+    static const uint ALGORITHM_VERSION;
+};
+
+#endif
@@ -1,5 +1,8 @@
 #include <iostream>
 #include <assert.h> 
+#include <thread>
+#include <atomic>
+#include <algorithm>
 
 #include "ScheduleMethod.hpp"
 #include "../utils/Timer.hpp"
@@ -10,6 +13,9 @@ using namespace std;
 //initialization of static members
 multimap<double, double> ScheduleMethod::allTempToPBad = multimap<double, double> (); 
 SANA* ScheduleMethod::sana = nullptr;
+uint ScheduleMethod::numThreads = 1;
+bool ScheduleMethod::warmStart = false;
+vector<SANA*> ScheduleMethod::workers;
 double ScheduleMethod::DEFAULT_TARGET_INITIAL_PBAD_DIGITS_FROM_1 = 2; // represents 0.99
 double ScheduleMethod::DEFAULT_TARGET_FINAL_PBAD_DIGITS_FROM_0 = 10; // represents 1e-10
 double ScheduleMethod::DEFAULT_TARGET_INITIAL_PBAD = (1-pow(10,-DEFAULT_TARGET_INITIAL_PBAD_DIGITS_FROM_1));
@@ -75,18 +81,101 @@ double ScheduleMethod::computeTempForPBad(double targetPBad, ScheduleMethod::Res
     throw runtime_error("functionality not implemented for this method");
 }
 
-double ScheduleMethod::sGetPBad(double temp, double sampleTime) {
-    double res = sana->getPBad(temp, sampleTime);
+double ScheduleMethod::sGetPBad(double temp, double sampleTime, bool warmStart) {
+    double res = sana->getPBad(temp, sampleTime, 1, warmStart);
     allTempToPBad.insert({temp, res});
     return res;
 }
 
-double ScheduleMethod::getPBad(double temp) {
-    double res = sGetPBad(temp, sampleTime);
+double ScheduleMethod::getPBad(double temp, bool warmStart) {
+    double res = sGetPBad(temp, sampleTime, warmStart);
     tempToPBad.insert({temp, res});
     return res;
 }
 
+void ScheduleMethod::setSana(SANA *const sana) {
+    deleteWorkers(); //they are copies of the previous sana
+    ScheduleMethod::sana = sana;
+}
+
+void ScheduleMethod::setNumThreads(uint n) { numThreads = max(1u, n); }
+
+void ScheduleMethod::setWarmStart(bool warmStart) { ScheduleMethod::warmStart = warmStart; }
+bool ScheduleMethod::getWarmStart() { return warmStart; }
+
+void ScheduleMethod::deleteWorkers() {
+    for (SANA* worker : workers) delete worker;
+    workers.clear();
+}
+
+vector<double> ScheduleMethod::getPBads(const vector<double>& temps) {
+    vector<double> res(temps.size());
+    //with warmStart, the temperatures are sampled from hottest to coldest. the first sample of each
+    //thread starts from a random alignment (which is at equilibrium at an infinite temperature),
+    //and the next ones continue from the alignment reached at the previous temperature.
+    //otherwise, every sample starts from a random alignment
+    vector<uint> order(temps.size());
+    for (uint i = 0; i < order.size(); i++) order[i] = i;
+    if (warmStart) sort(order.begin(), order.end(), [&temps](uint i, uint j) { return temps[i] > temps[j]; });
+    uint numWorkers = min(numThreads, (uint) temps.size());
+    if (numWorkers <= 1) {
+        for (uint k = 0; k < order.size(); k++) res[order[k]] = getPBad(temps[order[k]], warmStart and k > 0);
+        return res;
+    }
+    //a copy of sana is an independent SANA state that shares the graphs and measures with it
+    while (workers.size() < numWorkers) {
+        workers.push_back(new SANA(*sana));
+        workers.back()->setRandomStream(WORKER_RANDOM_STREAM_OFFSET + workers.size());
+    }
+    //the temperatures are handed out one at a time, since some take longer than others.
+    //the ips measured by the workers are not added to sana->ipsList: they are slower
+    //than a single thread, so they would underestimate the iterations of time-limited runs
+    atomic<uint> nextTemp(0);
+    vector<thread> threads;
+    for (uint w = 0; w < numWorkers; w++) {
+        threads.push_back(thread([this, &temps, &order, &res, &nextTemp, w]() {
+            setRandomThreadIndex(w+1);
+            bool continueSweep = false;
+            for (uint k = nextTemp++; k < order.size(); k = nextTemp++) {
+                res[order[k]] = workers[w]->getPBad(temps[order[k]], sampleTime, 1, continueSweep);
+                continueSweep = warmStart;
+            }
+        }));
+    }
+    for (thread& t : threads) t.join();
+    for (uint i = 0; i < temps.size(); i++) {
+        tempToPBad.insert({temps[i], res[i]});
+        allTempToPBad.insert({temps[i], res[i]});
+    }
+    return res;
+}
+
+pair<double, double> ScheduleMethod::log10TempRangeSearch(double log10LowTemp, double log10HighTemp,
+        double targetPBad, int numHalvings, map<double, double>& samples) {
+    //with k temperatures per step, each step divides the range into k+1 parts, so a step
+    //is worth log2(k+1) halvings. with k = 1, this is a binary search
+    uint k = numThreads;
+    double stepsNeeded = numHalvings / log2(k+1.0);
+    int numSteps = (int) ceil(stepsNeeded - 1e-9);
+    for (int step = 0; step < numSteps; step++) {
+        vector<double> temps(k);
+        for (uint i = 0; i < k; i++)
+            temps[i] = pow(10, log10LowTemp + (i+1)*(log10HighTemp-log10LowTemp)/(k+1));
+        vector<double> pBads = getPBads(temps);
+        //the new range ends at the first sampled temperature with pBad above the target
+        uint firstAbove = k;
+        for (uint i = 0; i < k; i++) {
+            samples[temps[i]] = pBads[i];
+            if (firstAbove == k and pBads[i] > targetPBad) firstAbove = i;
+        }
+        double newLow = (firstAbove == 0) ? log10LowTemp : log10(temps[firstAbove-1]);
+        double newHigh = (firstAbove == k) ? log10HighTemp : log10(temps[firstAbove]);
+        log10LowTemp = newLow;
+        log10HighTemp = newHigh;
+    }
+    return {log10LowTemp, log10HighTemp};
+}
+
 double ScheduleMethod::targetRangeMin(double targetPBad, double errorTol) {
     int digits;
     if(targetPBad < 0.5) // assume it's tFinal;
@@ -159,9 +248,12 @@ double ScheduleMethod::doublingMethod(double targetPBad, bool nextAbove, double
     if (startTemp == 0) startTemp = 1;
 
     //turn 'startTemp' into the closest power of 'base' below 'startTemp'
+    double closestTemp = startTemp;
     double startTempLog = log(startTemp)/log(base); //log_b a = log a / log b
     startTempLog = floor(startTempLog);
     startTemp = pow(base, startTempLog);
+    //startPBad is the pBad of closestTemp, so it is only reused if the power is the same temperature
+    if (startTemp != closestTemp) initStartPBad = false;
 
     double temp = startTemp;
     double priorTemp = temp;
@@ -172,19 +264,30 @@ double ScheduleMethod::doublingMethod(double targetPBad, bool nextAbove, double
     }
     else pBad = getPBad(temp);
 
+    //with several threads, the next numThreads temperatures in the search direction are
+    //sampled at once, and the samples beyond the one where the search stops are just extra data
+    vector<double> temps(numThreads);
     if (pBad < targetPBad) {
         while (pBad < targetPBad) {
-            priorTemp = temp;
-            temp *= base;
-            pBad = getPBad(temp);
+            for (uint i = 0; i < numThreads; i++) temps[i] = (i == 0 ? temp : temps[i-1]) * base;
+            vector<double> pBads = getPBads(temps);
+            for (uint i = 0; i < numThreads and pBad < targetPBad; i++) {
+                priorTemp = temp;
+                temp = temps[i];
+                pBad = pBads[i];
+            }
         }
         if (nextAbove) return temp;
         return priorTemp;      
     } else {
         while (pBad > targetPBad) {
-            priorTemp = temp;
-            temp /= base;
-            pBad = getPBad(temp);
+            for (uint i = 0; i < numThreads; i++) temps[i] = (i == 0 ? temp : temps[i-1]) / base;
+            vector<double> pBads = getPBads(temps);
+            for (uint i = 0; i < numThreads and pBad > targetPBad; i++) {
+                priorTemp = temp;
+                temp = temps[i];
+                pBad = pBads[i];
+            }
         }
         if (nextAbove) return priorTemp;
         return temp;
@@ -393,12 +496,12 @@ void ScheduleMethod::populatePBadCurve() {
     double highTemp = doublingMethod(HIGH_PBAD_LIMIT, false);
     double lowTemp = doublingMethod(LOW_PBAD_LIMIT, true);
     double numSteps = pow(10, abs(log10(lowTemp)) + abs(log10(highTemp)));
+    vector<double> temps;
     for (int T_i = 0; T_i <= log10(numSteps); T_i++) {
         double logTemp = log10(lowTemp) + T_i*(log10(highTemp)-log10(lowTemp))/log10(numSteps);
-        double temp = pow(10, logTemp);
-
-        getPBad(temp);
+        temps.push_back(pow(10, logTemp));
     }
+    getPBads(temps);
 }
 
 void ScheduleMethod::printScheduleStatistics() {
@@ -29,7 +29,18 @@ public:
 
     //single, static SANA for all schedule methods
     //call setSana before initializing any schedule method
-    static void setSana(SANA *const sana) { ScheduleMethod::sana = sana; }
+    static void setSana(SANA *const sana);
+
+    //number of temperatures that can be sampled at the same time. each thread samples
+    //with its own copy of sana (a worker). defaults to 1 (no workers, sana is used directly)
+    static void setNumThreads(uint n);
+    static void deleteWorkers(); //frees the copies of sana once the schedule is computed
+
+    //if true (-warmstartpbad), the temperatures of getPBads are sampled as a sweep from hottest to coldest,
+    //each continuing from the alignment reached at the previous one instead of a new random alignment.
+    //it gets closer to equilibrium at low temperatures, but it changes the schedule. defaults to false
+    static void setWarmStart(bool warmStart);
+    static bool getWarmStart();
 
     ScheduleMethod();
     virtual ~ScheduleMethod() =default;
@@ -59,6 +70,12 @@ public:
     void printScheduleStatistics();
     static void printTargetRange(double targetPBad, double errorTol);
     Resources totalResources(); //resources used between computeTInitial & computeTFinal
+    const multimap<double, double>& getTempToPBad() const { return tempToPBad; }
+    //adds pBad samples taken before (e.g., cached by a previous run), so that the searches for the
+    //temperatures start from them (see doublingMethod) and the regressions include them
+    void addPBadSamples(const multimap<double, double>& samples) { tempToPBad.insert(samples.begin(), samples.end()); }
+    double getTargetInitialPBad() const { return targetInitialPBad; }
+    double getTargetFinalPBad() const { return targetFinalPBad; }
 
     //use these to interface with the error tolerance rather than using errorTol directly:
     static double targetRangeMin(double targetPBad, double errorTol);
@@ -98,13 +115,24 @@ protected:
     //auxiliary functions used by several schedule methods:
 
     //wrapper around sana->getPBad that saves the result in tempToPBad
-    double getPBad(double temp);
+    double getPBad(double temp, bool warmStart = false);
+    //same for several temperatures, which are sampled in parallel if numThreads > 1
+    //with setWarmStart, they are treated as a sweep: each thread continues from the alignment of its
+    //previous temperature (see SANA::getPBad). the results are in the same order as 'temps'
+    vector<double> getPBads(const vector<double>& temps);
 
     double sampleTime; //time getPBad is allowed to run
     multimap<double, double> tempToPBad; //every call to getPBad adds an entry to this map
 
     double doublingMethod(double targetPBad, bool nextAbove, double base = 10);
 
+    //narrows the range of log10(temp) (log10LowTemp, log10HighTemp), where the pBad is assumed to go
+    //from below to above 'targetPBad', as much as 'numHalvings' steps of binary search would.
+    //each step samples numThreads evenly spaced temperatures at once, so fewer steps are needed
+    //the samples are also added to 'samples'. returns the final range
+    pair<double, double> log10TempRangeSearch(double log10LowTemp, double log10HighTemp, double targetPBad,
+                                              int numHalvings, map<double, double>& samples);
+
     // Binary search based on pbads
     double pBadBinarySearch(double targetPBad, Resources maxRes);
 
@@ -130,7 +158,14 @@ private:
 
     //union of the tempToPBad maps of all the methods
     static multimap<double, double> allTempToPBad; 
-    static double sGetPBad(double temp, double sampleTime);
+    static double sGetPBad(double temp, double sampleTime, bool warmStart = false);
+
+    static uint numThreads;
+    static bool warmStart;
+    static vector<SANA*> workers; //copies of sana, created when needed by getPBads
+    //the workers use random streams from this one on, so that they do not repeat
+    //the random choices of sana or of the chains of a Portfolio (see SANA::setRandomStream)
+    static const uint WORKER_RANDOM_STREAM_OFFSET = 1000;
 
 };
 
@@ -0,0 +1,29 @@
+#include "AlignedAllocator.hpp"
+#include <cstdlib>
+#include <new>
+#include <atomic>
+#include <sys/mman.h>
+
+using namespace std;
+
+static atomic<bool> hugePages(false);
+
+void setUseHugePages(bool use) { hugePages = use; }
+bool useHugePages() { return hugePages; }
+
+void* alignedAllocate(size_t bytes) {
+    size_t alignment = CACHE_LINE_SIZE;
+    bool huge = hugePages and bytes >= HUGE_PAGE_SIZE;
+    if (huge) {
+        alignment = HUGE_PAGE_SIZE;
+        bytes = (bytes + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE;
+    }
+    void* ptr = nullptr;
+    if (posix_memalign(&ptr, alignment, bytes == 0 ? alignment : bytes) != 0) throw bad_alloc();
+#ifdef MADV_HUGEPAGE
+    if (huge) madvise(ptr, bytes, MADV_HUGEPAGE);
+#endif
+    return ptr;
+}
+
+void alignedFree(void* ptr) { free(ptr); }
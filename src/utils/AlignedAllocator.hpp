@@ -0,0 +1,39 @@
+#ifndef ALIGNEDALLOCATOR_HPP
+#define ALIGNEDALLOCATOR_HPP
+#include <cstddef>
+using namespace std;
+
+const size_t CACHE_LINE_SIZE = 64;
+const size_t HUGE_PAGE_SIZE = 2*1024*1024;
+
+/* Memory for the large arrays that are read at random positions in SANA's main loop
+(similarity matrices, adjacency matrices). Blocks are aligned to 64 bytes (a cache line).
+If huge pages are enabled (-hugepages), blocks of at least HUGE_PAGE_SIZE are aligned to it
+and the kernel is asked to back them with transparent huge pages, which reduces the TLB misses
+of random lookups in matrices of hundreds of MB. It is only a hint: it has no effect if
+the system does not support them */
+void* alignedAllocate(size_t bytes);
+void alignedFree(void* ptr);
+
+//only affects the blocks allocated afterwards
+void setUseHugePages(bool use);
+bool useHugePages();
+
+//allocator for standard containers, e.g., vector<float, AlignedAllocator<float>>
+template<typename T>
+struct AlignedAllocator {
+    typedef T value_type;
+
+    AlignedAllocator() {}
+    template<typename U> AlignedAllocator(const AlignedAllocator<U>&) {}
+
+    T* allocate(size_t n) { return (T*) alignedAllocate(n*sizeof(T)); }
+    void deallocate(T* ptr, size_t) { alignedFree(ptr); }
+};
+
+template<typename T, typename U>
+bool operator==(const AlignedAllocator<T>&, const AlignedAllocator<U>&) { return true; }
+template<typename T, typename U>
+bool operator!=(const AlignedAllocator<T>&, const AlignedAllocator<U>&) { return false; }
+
+#endif /* ALIGNEDALLOCATOR_HPP */
@@ -0,0 +1,106 @@
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <cstdio>
+#include "BackgroundWriter.hpp"
+
+namespace {
+//the writer thread is detached and never finishes, so the state it uses is allocated once and
+//never destroyed (destroying the condition variable while the thread waits on it would block at exit)
+struct PendingTask {
+    string fileName; //empty for the tasks added with addTask
+    shared_ptr<vector<char>> data; //what write() writes to fileName
+    function<void()> task;
+};
+
+struct WriterState {
+    mutex queueMutex;
+    condition_variable queueChanged;
+    deque<PendingTask> pendingTasks;
+    bool writing = false;
+    bool writerStarted = false;
+};
+
+WriterState& writerState() {
+    static WriterState* state = new WriterState();
+    return *state;
+}
+
+void writeFile(const string& fileName, const vector<char>& data) {
+    string tmpFileName = fileName+".tmp";
+    {
+        ofstream ofs(tmpFileName, ios::binary | ios::trunc);
+        ofs.write(data.data(), data.size());
+        if (not ofs) {
+            cerr << "error: could not write " << tmpFileName << endl;
+            return;
+        }
+    }
+    if (rename(tmpFileName.c_str(), fileName.c_str()) != 0)
+        cerr << "error: could not rename " << tmpFileName << " to " << fileName << endl;
+}
+
+void writerLoop();
+
+void enqueue(PendingTask pending) {
+    WriterState& st = writerState();
+    lock_guard<mutex> lock(st.queueMutex);
+    if (not st.writerStarted) {
+        //detached: a pending write is lost if the program exits, but complete files stay intact
+        thread(writerLoop).detach();
+        st.writerStarted = true;
+    }
+    //if there is an older version of the same file still waiting, it is replaced
+    if (not pending.fileName.empty()) {
+        for (auto& older : st.pendingTasks) {
+            if (older.fileName == pending.fileName) {
+                older.data->swap(*pending.data);
+                return;
+            }
+        }
+    }
+    st.pendingTasks.push_back(move(pending));
+    st.queueChanged.notify_all();
+}
+
+void writerLoop() {
+    WriterState& st = writerState();
+    unique_lock<mutex> lock(st.queueMutex);
+    while (true) {
+        st.queueChanged.wait(lock, [&st]() { return not st.pendingTasks.empty(); });
+        function<void()> task = move(st.pendingTasks.front().task);
+        st.pendingTasks.pop_front();
+        st.writing = true;
+        lock.unlock();
+        try {
+            task();
+        } catch (const exception& e) {
+            cerr << "error in background write: " << e.what() << endl;
+        }
+        lock.lock();
+        st.writing = false;
+        st.queueChanged.notify_all();
+    }
+}
+}
+
+void BackgroundWriter::write(const string& fileName, vector<char>& data) {
+    //shared_ptr because function<void()> requires a copyable callable
+    shared_ptr<vector<char>> dataPtr = make_shared<vector<char>>();
+    dataPtr->swap(data);
+    enqueue({fileName, dataPtr, [fileName, dataPtr]() { writeFile(fileName, *dataPtr); }});
+}
+
+void BackgroundWriter::addTask(function<void()> task) {
+    enqueue({"", nullptr, move(task)});
+}
+
+void BackgroundWriter::waitUntilIdle() {
+    WriterState& st = writerState();
+    unique_lock<mutex> lock(st.queueMutex);
+    st.queueChanged.wait(lock, [&st]() { return st.pendingTasks.empty() and not st.writing; });
+}
@@ -0,0 +1,26 @@
+#ifndef BACKGROUNDWRITER_HPP
+#define BACKGROUNDWRITER_HPP
+#include <vector>
+#include <string>
+#include <functional>
+using namespace std;
+
+/* Writes files from a background thread, so that the caller (e.g., SANA's main loop)
+does not wait for the disk. The queued writes are done one at a time, in order */
+class BackgroundWriter {
+public:
+    //queues 'data' to be written to 'fileName'. takes the contents of 'data' without copying them
+    //the file is first written under a temporary name and then renamed,
+    //so it is never left half-written (e.g., if the process is killed).
+    //if an older write of the same file is still queued, its data is replaced instead
+    static void write(const string& fileName, vector<char>& data);
+
+    //queues a function that writes one or more files. it must only use data that the caller
+    //does not modify afterwards (e.g., captured copies)
+    static void addTask(function<void()> task);
+
+    //blocks until all the queued writes have been done
+    static void waitUntilIdle();
+};
+
+#endif /* BACKGROUNDWRITER_HPP */
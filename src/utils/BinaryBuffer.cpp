@@ -0,0 +1,56 @@
+#include <fstream>
+#include "BinaryBuffer.hpp"
+#include "FileIO.hpp"
+
+BinaryBuffer::BinaryBuffer(): readPos(0) {}
+
+BinaryBuffer::BinaryBuffer(const string& fileName): readPos(0) {
+    FileIO::checkFileExists(fileName);
+    ifstream ifs(fileName, ios::binary);
+    bytes.assign(istreambuf_iterator<char>(ifs), istreambuf_iterator<char>());
+}
+
+void BinaryBuffer::writeVector(const vector<bool>& v) {
+    write<uint64_t>(v.size());
+    for (bool b : v) bytes.push_back(b ? 1 : 0);
+}
+
+void BinaryBuffer::writeString(const string& s) {
+    write<uint64_t>(s.size());
+    writeBytes(s.data(), s.size());
+}
+
+void BinaryBuffer::readVector(vector<bool>& v) {
+    uint64_t size = read<uint64_t>();
+    checkAvailable(size);
+    v.resize(size);
+    for (uint64_t i = 0; i < size; i++) v[i] = bytes[readPos++] != 0;
+}
+
+string BinaryBuffer::readString() {
+    uint64_t size = read<uint64_t>();
+    checkAvailable(size);
+    string s(bytes.data() + readPos, size);
+    readPos += size;
+    return s;
+}
+
+bool BinaryBuffer::atEnd() const { return readPos == bytes.size(); }
+
+vector<char>& BinaryBuffer::getBytes() { return bytes; }
+
+void BinaryBuffer::writeBytes(const void* src, size_t n) {
+    size_t pos = bytes.size();
+    bytes.resize(pos + n);
+    if (n > 0) memcpy(bytes.data() + pos, src, n);
+}
+
+void BinaryBuffer::readBytes(void* dest, size_t n) {
+    checkAvailable(n);
+    if (n > 0) memcpy(dest, bytes.data() + readPos, n);
+    readPos += n;
+}
+
+void BinaryBuffer::checkAvailable(uint64_t n) const {
+    if (n > bytes.size() - readPos) throw runtime_error("unexpected end of binary data");
+}
@@ -0,0 +1,69 @@
+#ifndef BINARYBUFFER_HPP
+#define BINARYBUFFER_HPP
+#include <vector>
+#include <string>
+#include <cstring>
+#include <stdexcept>
+#include <type_traits>
+using namespace std;
+
+/* A byte buffer to write and read plain data in binary form, e.g., to save the state of a
+SANA run in a checkpoint file. Values are read back in the same order they were written.
+Reading past the end of the buffer throws a runtime_error.
+The format is the in-memory representation of the values, so it is not portable between
+architectures */
+class BinaryBuffer {
+public:
+    BinaryBuffer();
+    BinaryBuffer(const string& fileName); //reads the whole file
+
+    template<typename T> void write(const T& value);
+    template<typename T> void writeVector(const vector<T>& v);
+    void writeVector(const vector<bool>& v);
+    void writeString(const string& s);
+
+    template<typename T> T read();
+    template<typename T> void readVector(vector<T>& v);
+    void readVector(vector<bool>& v);
+    string readString();
+    bool atEnd() const;
+
+    vector<char>& getBytes();
+
+private:
+    vector<char> bytes;
+    size_t readPos;
+    void writeBytes(const void* src, size_t n);
+    void readBytes(void* dest, size_t n);
+    void checkAvailable(uint64_t n) const; //throws if there are less than n bytes left to read
+};
+
+template<typename T>
+void BinaryBuffer::write(const T& value) {
+    static_assert(is_trivially_copyable<T>::value, "only plain data can be written");
+    writeBytes(&value, sizeof(T));
+}
+
+template<typename T>
+void BinaryBuffer::writeVector(const vector<T>& v) {
+    static_assert(is_trivially_copyable<T>::value, "only plain data can be written");
+    write<uint64_t>(v.size());
+    writeBytes(v.data(), v.size()*sizeof(T));
+}
+
+template<typename T>
+T BinaryBuffer::read() {
+    T value;
+    readBytes(&value, sizeof(T));
+    return value;
+}
+
+template<typename T>
+void BinaryBuffer::readVector(vector<T>& v) {
+    uint64_t size = read<uint64_t>();
+    checkAvailable(size*sizeof(T));
+    v.resize(size);
+    readBytes(v.data(), v.size()*sizeof(T));
+}
+
+#endif /* BINARYBUFFER_HPP */
@@ -0,0 +1,133 @@
+#include "BitMatrix.hpp"
+#include <iostream>
+#include <cstdlib>
+#if defined(__x86_64__) and (defined(__GNUC__) or defined(__clang__))
+#include <immintrin.h>
+#define BITMATRIX_X86_KERNELS
+#endif
+
+using namespace std;
+
+const uint32_t WORDS_PER_BLOCK = 16; //64 bytes
+
+BitMatrix::BitMatrix(): rows(0), cols(0), stride(0) {}
+
+BitMatrix::BitMatrix(uint32_t numRows, uint32_t numCols): rows(numRows), cols(numCols) {
+    size_t wordsPerRow = (numCols + 31) / 32;
+    stride = (wordsPerRow + WORDS_PER_BLOCK - 1) / WORDS_PER_BLOCK * WORDS_PER_BLOCK;
+    words = vector<uint32_t, AlignedAllocator<uint32_t>> ((size_t) numRows * stride, 0);
+}
+
+void BitMatrix::set(uint32_t row, uint32_t col, bool value) {
+    uint32_t& word = words[(size_t) row*stride + (col >> 5)];
+    if (value) word |= 1u << (col & 31);
+    else word &= ~(1u << (col & 31));
+}
+
+static int rowBitDifferenceScalar(const uint32_t* oldRow, const uint32_t* newRow,
+        const uint32_t* ids, uint32_t count, const uint32_t* cols) {
+    int res = 0;
+    for (uint32_t i = 0; i < count; i++) {
+        uint32_t col = cols[ids[i]];
+        res += (newRow[col >> 5] >> (col & 31)) & 1;
+        res -= (oldRow[col >> 5] >> (col & 31)) & 1;
+    }
+    return res;
+}
+
+#ifdef BITMATRIX_X86_KERNELS
+__attribute__((target("avx2")))
+static inline int horizontalSumAVX2(__m256i v) {
+    __m128i sum = _mm_add_epi32(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1));
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, 0x4E));
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, 0xB1));
+    return _mm_cvtsi128_si32(sum);
+}
+
+__attribute__((target("avx2")))
+static int rowBitDifferenceAVX2(const uint32_t* oldRow, const uint32_t* newRow,
+        const uint32_t* ids, uint32_t count, const uint32_t* cols) {
+    const __m256i low5Bits = _mm256_set1_epi32(31), one = _mm256_set1_epi32(1);
+    __m256i acc = _mm256_setzero_si256();
+    uint32_t i = 0;
+    for (; i+8 <= count; i += 8) {
+        __m256i id = _mm256_loadu_si256((const __m256i*) (ids+i));
+        __m256i col = _mm256_i32gather_epi32((const int*) cols, id, 4);
+        __m256i word = _mm256_srli_epi32(col, 5);
+        __m256i shift = _mm256_and_si256(col, low5Bits);
+        __m256i newBits = _mm256_i32gather_epi32((const int*) newRow, word, 4);
+        __m256i oldBits = _mm256_i32gather_epi32((const int*) oldRow, word, 4);
+        newBits = _mm256_and_si256(_mm256_srlv_epi32(newBits, shift), one);
+        oldBits = _mm256_and_si256(_mm256_srlv_epi32(oldBits, shift), one);
+        acc = _mm256_add_epi32(acc, _mm256_sub_epi32(newBits, oldBits));
+    }
+    return horizontalSumAVX2(acc) + rowBitDifferenceScalar(oldRow, newRow, ids+i, count-i, cols);
+}
+
+//the AVX-512 intrinsics without a mask leave the unused lanes undefined, which makes gcc
+//warn about uninitialized values, so the masked versions are used with every lane enabled
+
+__attribute__((target("avx512f")))
+static int rowBitDifferenceAVX512(const uint32_t* oldRow, const uint32_t* newRow,
+        const uint32_t* ids, uint32_t count, const uint32_t* cols) {
+    const __mmask16 all = 0xFFFF;
+    const __m512i zero = _mm512_setzero_si512();
+    const __m512i low5Bits = _mm512_set1_epi32(31), one = _mm512_set1_epi32(1);
+    __m512i acc = zero;
+    uint32_t i = 0;
+    for (; i+16 <= count; i += 16) {
+        __m512i id = _mm512_loadu_si512((const void*) (ids+i));
+        __m512i col = _mm512_mask_i32gather_epi32(zero, all, id, (const void*) cols, 4);
+        __m512i word = _mm512_maskz_srli_epi32(all, col, 5);
+        __m512i shift = _mm512_and_si512(col, low5Bits);
+        __m512i newBits = _mm512_mask_i32gather_epi32(zero, all, word, (const void*) newRow, 4);
+        __m512i oldBits = _mm512_mask_i32gather_epi32(zero, all, word, (const void*) oldRow, 4);
+        newBits = _mm512_and_si512(_mm512_maskz_srlv_epi32(all, newBits, shift), one);
+        oldBits = _mm512_and_si512(_mm512_maskz_srlv_epi32(all, oldBits, shift), one);
+        acc = _mm512_add_epi32(acc, _mm512_sub_epi32(newBits, oldBits));
+    }
+    __m256i halves = _mm256_add_epi32(_mm512_maskz_extracti64x4_epi64(0xF, acc, 0),
+                                    _mm512_maskz_extracti64x4_epi64(0xF, acc, 1));
+    //the remaining ids (up to 15) go through the AVX2 version
+    return horizontalSumAVX2(halves) + rowBitDifferenceAVX2(oldRow, newRow, ids+i, count-i, cols);
+}
+#endif
+
+typedef int (*RowBitDifferenceFunction)(const uint32_t*, const uint32_t*, const uint32_t*, uint32_t, const uint32_t*);
+
+//the environment variable ROW_BIT_DIFFERENCE ("avx512", "avx2" or "scalar") forces an implementation,
+//so that they can be tested against each other. otherwise the fastest one supported by the CPU is used
+static RowBitDifferenceFunction selectRowBitDifference(string& name) {
+    char *forced = getenv((char*)"ROW_BIT_DIFFERENCE");
+    if (forced and string(forced) == "scalar") {
+        name = "scalar";
+        return rowBitDifferenceScalar;
+    }
+#ifdef BITMATRIX_X86_KERNELS
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f") and (not forced or string(forced) == "avx512")) {
+        name = "avx512";
+        return rowBitDifferenceAVX512;
+    }
+    if (__builtin_cpu_supports("avx2") and (not forced or string(forced) == "avx2")) {
+        name = "avx2";
+        return rowBitDifferenceAVX2;
+    }
+#endif
+    if (forced) {
+        cerr << "ROW_BIT_DIFFERENCE=" << forced << " is not an implementation supported by this CPU" << endl;
+        exit(1);
+    }
+    name = "scalar";
+    return rowBitDifferenceScalar;
+}
+
+static string rowBitDifferenceName;
+static const RowBitDifferenceFunction rowBitDifferenceImpl = selectRowBitDifference(rowBitDifferenceName);
+
+int rowBitDifference(const uint32_t* oldRow, const uint32_t* newRow,
+        const uint32_t* ids, uint32_t count, const uint32_t* cols) {
+    return rowBitDifferenceImpl(oldRow, newRow, ids, count, cols);
+}
+
+string rowBitDifferenceImplementation() { return rowBitDifferenceName; }
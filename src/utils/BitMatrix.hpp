@@ -0,0 +1,46 @@
+#ifndef BITMATRIX_HPP
+#define BITMATRIX_HPP
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include <string>
+#include "AlignedAllocator.hpp"
+using namespace std;
+
+/* Matrix of bits stored in a single array, one row after another.
+Each row takes a whole number of 64-byte blocks and the array is 64-byte aligned,
+so rows start at cache line boundaries, and the words of a row can be read directly (see row()) by kernels
+such as rowBitDifference. Bits are stored in 32-bit words so that AVX2/AVX-512 can gather them */
+class BitMatrix {
+public:
+    BitMatrix();
+    BitMatrix(uint32_t numRows, uint32_t numCols);
+
+    bool get(uint32_t row, uint32_t col) const {
+        return (words[(size_t) row*stride + (col >> 5)] >> (col & 31)) & 1;
+    }
+    void set(uint32_t row, uint32_t col, bool value);
+    const uint32_t* row(uint32_t r) const { return &words[(size_t) r*stride]; }
+
+    uint32_t numRows() const { return rows; }
+    uint32_t numCols() const { return cols; }
+
+private:
+    uint32_t rows, cols;
+    size_t stride; //words per row
+    vector<uint32_t, AlignedAllocator<uint32_t>> words;
+};
+
+/* Returns the number of i < count such that newRow has bit cols[ids[i]] set,
+minus the number of them such that oldRow has it set.
+SANA uses it to count the aligned edges gained and lost when a peg moves from one hole to another:
+the rows are those of the holes in G2's adjacency matrix, ids are the neighbors of the peg
+and cols is the alignment. On CPUs with AVX2 or AVX-512, it processes 8 or 16 ids at a time
+with gather instructions (the implementation is chosen at startup, see ROW_BIT_DIFFERENCE in BitMatrix.cpp) */
+int rowBitDifference(const uint32_t* oldRow, const uint32_t* newRow,
+        const uint32_t* ids, uint32_t count, const uint32_t* cols);
+
+//name of the implementation of rowBitDifference in use ("avx512", "avx2" or "scalar")
+string rowBitDifferenceImplementation();
+
+#endif /* BITMATRIX_HPP */
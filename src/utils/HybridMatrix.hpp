@@ -0,0 +1,127 @@
+#ifndef HYBRIDMATRIX_HPP_
+#define HYBRIDMATRIX_HPP_
+
+#include <vector>
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include "Matrix.hpp"
+
+using namespace std;
+
+/* Matrix with few non-zero entries per row except in some rows, such as the adjacency matrix
+of a large network with a few hubs. Rows with at least hubLength entries ("hub rows") are
+stored densely in a Matrix<T> (bit-packed if T is bool), with one row per hub row.
+The other rows are sorted arrays of the columns of their non-zero entries, with their values
+in a parallel array (except for bool, where they are all true), all rows one after another in a
+single array (compressed sparse rows). The location of each row is in a 16-byte RowInfo, so get()
+reads a RowInfo and then the hub row or a binary search of less than hubLength columns.
+If hubLength is 0, every row is a hub row and the matrix is an ordinary dense Matrix<T>
+(see isDense), whose get() costs one load and a well-predicted branch.
+It cannot be modified after it is built */
+template <typename T>
+class HybridMatrix {
+public:
+    HybridMatrix(): rows(0), allDense(true) {}
+
+    /* rowCols[i] are the columns of the non-zero entries of row i, in any order, and rowValues[i]
+    their values, which cannot be T(0). If rowValues is empty, every entry in rowCols has value T(1).
+    Throws runtime_error if a column appears twice in the same row */
+    HybridMatrix(uint numCols, const vector<vector<uint>>& rowCols,
+                 const vector<vector<T>>& rowValues, uint hubLength);
+
+    T get(uint row, uint col) const {
+        if (allDense) return dense.get(row, col);
+        const RowInfo& info = rowInfo[row];
+        if (info.hubRow != NOT_HUB) return dense.get(info.hubRow, col);
+        if (info.length == 0) return T(0);
+        //binary search without unpredictable branches: the rows are short, so the cost is in
+        //the mispredictions rather than in the number of steps
+        const uint* base = cols.data() + info.start;
+        uint n = info.length;
+        while (n > 1) {
+            uint half = n/2;
+            base = base[half] <= col ? base+half : base;
+            n -= half;
+        }
+        if (*base != col) return T(0);
+        return STORE_VALUES ? values[base - cols.data()] : T(1);
+    }
+
+    uint size() const { return rows; } //number of rows
+    bool isDense() const { return allDense; }
+    uint numHubRows() const { return dense.numRows(); }
+    //if isDense(), the whole matrix; otherwise, the hub rows
+    const Matrix<T>& getDenseRows() const { return dense; }
+
+private:
+    static const uint NOT_HUB = (uint) -1;
+    static const bool STORE_VALUES = not is_same<T, bool>::value;
+
+    struct RowInfo {
+        size_t start; //if it is not a hub row, it is in cols[start..start+length)
+        uint length;
+        uint hubRow; //index in dense, or NOT_HUB
+    };
+
+    uint rows;
+    bool allDense;
+    Matrix<T> dense;
+    vector<RowInfo> rowInfo;
+    vector<uint> cols;
+    vector<T> values;
+};
+
+template <typename T>
+HybridMatrix<T>::HybridMatrix(uint numCols, const vector<vector<uint>>& rowCols,
+        const vector<vector<T>>& rowValues, uint hubLength):
+            rows(rowCols.size()), allDense(hubLength == 0) {
+    bool uniformValues = rowValues.empty();
+    auto valueOf = [&](uint row, uint i) { return uniformValues ? T(1) : rowValues[row][i]; };
+    auto repeated = [](uint row, uint col) {
+        return runtime_error("repeated entry ("+to_string(row)+", "+to_string(col)+") in matrix");
+    };
+
+    uint numHubs = 0;
+    if (not allDense) {
+        rowInfo = vector<RowInfo> (rows);
+        size_t numSparseEntries = 0;
+        for (uint i = 0; i < rows; i++) {
+            RowInfo& info = rowInfo[i];
+            info.start = numSparseEntries;
+            info.length = 0;
+            info.hubRow = NOT_HUB;
+            if (rowCols[i].size() >= hubLength) info.hubRow = numHubs++;
+            else info.length = rowCols[i].size();
+            numSparseEntries += info.length;
+        }
+        cols = vector<uint> (numSparseEntries);
+        if (STORE_VALUES) values = vector<T> (numSparseEntries);
+    }
+    dense = Matrix<T>(allDense ? rows : numHubs, numCols);
+
+    vector<uint> order;
+    for (uint i = 0; i < rows; i++) {
+        if (allDense or rowInfo[i].hubRow != NOT_HUB) {
+            uint denseRow = allDense ? i : rowInfo[i].hubRow;
+            for (uint j = 0; j < rowCols[i].size(); j++) {
+                uint col = rowCols[i][j];
+                if (dense.get(denseRow, col) != 0) throw repeated(i, col);
+                dense[denseRow][col] = valueOf(i, j);
+            }
+        } else {
+            order.resize(rowCols[i].size());
+            for (uint j = 0; j < order.size(); j++) order[j] = j;
+            sort(order.begin(), order.end(), [&](uint a, uint b) { return rowCols[i][a] < rowCols[i][b]; });
+            size_t pos = rowInfo[i].start;
+            for (uint j = 0; j < order.size(); j++, pos++) {
+                cols[pos] = rowCols[i][order[j]];
+                if (STORE_VALUES) values[pos] = valueOf(i, order[j]);
+                if (j > 0 and cols[pos] == cols[pos-1]) throw repeated(i, cols[pos]);
+            }
+        }
+    }
+}
+
+#endif /* HYBRIDMATRIX_HPP_ */
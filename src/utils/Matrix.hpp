@@ -2,88 +2,208 @@
 #define MATRIX_HPP_
 
 #include "utils.hpp"
-#include "SparseMatrix.hpp"
+#include "AlignedAllocator.hpp"
+#include "BitMatrix.hpp"
 #include <vector>
+#include <memory>
 
 using namespace std;
 
-#ifdef SPARSE
-    #define INNER_CONTAINER unordered_map<uint, T>
-    #define MATRIX_DATA_STRUCTURE SparseMatrix<T>
-#else
-    #define INNER_CONTAINER vector<T>
-    #define MATRIX_DATA_STRUCTURE vector<vector<T>>
-#endif
-
+/* Dense matrix stored in a single array, row after row, instead of a vector of vectors:
+there is no separate heap block and no pointer to follow per row, so an access like m[i][j]
+is a multiplication and a single load. Each row is padded to a whole number of 64-byte blocks
+and the array is 64-byte aligned (see AlignedAllocator), so every row starts at a cache line.
+m[i] is a view of row i with the usual operator[], size(), begin() and end().
+The elements can also be in memory that the matrix does not own, such as a memory-mapped file
+(see the constructor with a keeper). Copies of a matrix always own their elements, but share()
+returns a view: another matrix with the same elements, which are freed with the last of them.
+Matrix<bool> is bit-packed (see the specialization below) */
 template <typename T>
 class Matrix {
 public:
+    template <typename Elem>
+    class RowView {
+    public:
+        RowView(Elem* first, uint numCols): first(first), numCols(numCols) {}
+        Elem& operator [] (uint col) const { return first[col]; }
+        uint size() const { return numCols; }
+        Elem* begin() const { return first; }
+        Elem* end() const { return first + numCols; }
+        Elem* data() const { return first; }
+    private:
+        Elem* first;
+        uint numCols;
+    };
+
     Matrix();
-    Matrix(const Matrix & matrix);
-    Matrix(uint numberOfNodes);
-    Matrix(uint row, uint col);
+    Matrix(uint numberOfNodes); //square
+    Matrix(uint numRows, uint numCols, T value = T());
+    /* matrix whose elements are in memory owned by keeper, which is kept alive as long as the
+    matrix (the memory is released when the last copy of keeper is destroyed). They are laid out
+    as in any other matrix with the same number of columns (see strideFor) */
+    Matrix(uint numRows, uint numCols, T* elements, shared_ptr<void> keeper);
+
+    Matrix(const Matrix& other);
+    Matrix(Matrix&& other);
+    Matrix& operator = (const Matrix& other);
+    Matrix& operator = (Matrix&& other);
 
-    Matrix & operator = (const Matrix & matrix);
-    INNER_CONTAINER & operator [] (uint node1);
+    //a matrix with the same elements (not a copy). If this matrix owns its elements, they are
+    //moved to a shared keeper, so that they are kept alive by both matrices
+    Matrix share();
+
+    RowView<T> operator [] (uint row) { return RowView<T>(elements + (size_t) row * stride, cols); }
+    RowView<const T> operator [] (uint row) const { return RowView<const T>(elements + (size_t) row * stride, cols); }
+
+    const T get(uint row, uint col) const { return elements[(size_t) row * stride + col]; }
+    uint size() const; //number of rows
+    bool empty() const { return rows == 0; }
+    uint numRows() const { return rows; }
+    uint numCols() const { return cols; }
+    //distance in elements between the first elements of consecutive rows
+    size_t rowStride() const { return stride; }
+    static size_t strideFor(uint numCols);
+    //all the elements, row after row, including the padding at the end of each row
+    const T* rawData() const { return elements; }
+    //whether the elements are in memory owned by a keeper rather than by the matrix
+    bool isExternal() const { return keeper != nullptr; }
 
-    const T get(uint node1, uint node2) const;
-    uint size() const;
 private:
-   MATRIX_DATA_STRUCTURE data;
+    uint rows, cols;
+    size_t stride;
+    vector<T, AlignedAllocator<T>> data; //empty if the elements are external
+    shared_ptr<void> keeper; //owner of the external elements, if any
+    T* elements; //first element, in data or in external memory
 };
 
 template <typename T>
-inline INNER_CONTAINER & Matrix<T>::operator [] (uint node1) {
-    return data[node1];
-}
+Matrix<T>::Matrix(): rows(0), cols(0), stride(0), elements(nullptr) {}
 
 template <typename T>
-Matrix<T>::Matrix(uint row, uint col) {
-#ifdef SPARSE
-    data = MATRIX_DATA_STRUCTURE(row);
-#else
-    data = MATRIX_DATA_STRUCTURE(row,
-           vector<T>(col, T()));
-#endif
-}
+Matrix<T>::Matrix(uint numberOfNodes): Matrix(numberOfNodes, numberOfNodes) {}
 
 template <typename T>
-inline const T Matrix<T>::get(uint node1, uint node2) const {
-#ifdef SPARSE
-    return data.get(node1, node2);
-#else
-    return data[node1][node2];
-#endif
-}
+Matrix<T>::Matrix(uint numRows, uint numCols, T value):
+        rows(numRows), cols(numCols), stride(strideFor(numCols)),
+        data((size_t) numRows * stride, value), elements(data.data()) {}
+
+template <typename T>
+Matrix<T>::Matrix(uint numRows, uint numCols, T* elements, shared_ptr<void> keeper):
+        rows(numRows), cols(numCols), stride(strideFor(numCols)), keeper(keeper), elements(elements) {}
 
 template <typename T>
-Matrix<T>::Matrix() {
+Matrix<T> Matrix<T>::share() {
+    if (not keeper) {
+        //moving the vector keeps its buffer, so elements is still valid
+        auto owner = make_shared<vector<T, AlignedAllocator<T>>>(move(data));
+        data = vector<T, AlignedAllocator<T>>();
+        keeper = owner;
+    }
+    return Matrix(rows, cols, elements, keeper);
 }
 
 template <typename T>
-Matrix<T>::Matrix(const Matrix & matrix) {
-    data = matrix.data;
+Matrix<T>::Matrix(const Matrix& other):
+        rows(other.rows), cols(other.cols), stride(other.stride),
+        data(other.elements, other.elements + (size_t) other.rows * other.stride), elements(data.data()) {}
+
+template <typename T>
+Matrix<T>::Matrix(Matrix&& other):
+        rows(other.rows), cols(other.cols), stride(other.stride),
+        data(move(other.data)), keeper(move(other.keeper)) {
+    elements = keeper ? other.elements : data.data();
+    other.rows = other.cols = other.stride = 0;
+    other.elements = nullptr;
 }
 
 template <typename T>
-Matrix<T>::Matrix(uint numberOfNodes) {
-#ifdef SPARSE
-    data = MATRIX_DATA_STRUCTURE(numberOfNodes);
-#else
-    data = MATRIX_DATA_STRUCTURE(numberOfNodes,
-           vector<T>(numberOfNodes, T()));
-#endif
+Matrix<T>& Matrix<T>::operator = (const Matrix& other) {
+    if (this == &other) return *this;
+    rows = other.rows;
+    cols = other.cols;
+    stride = other.stride;
+    data.assign(other.elements, other.elements + (size_t) other.rows * other.stride);
+    keeper = nullptr;
+    elements = data.data();
+    return *this;
 }
 
 template <typename T>
-Matrix<T> & Matrix<T>::operator = (const Matrix & matrix) {
-    data = matrix.data;
+Matrix<T>& Matrix<T>::operator = (Matrix&& other) {
+    if (this == &other) return *this;
+    rows = other.rows;
+    cols = other.cols;
+    stride = other.stride;
+    data = move(other.data);
+    keeper = move(other.keeper);
+    elements = keeper ? other.elements : data.data();
+    other.rows = other.cols = other.stride = 0;
+    other.elements = nullptr;
     return *this;
 }
 
+template <typename T>
+size_t Matrix<T>::strideFor(uint numCols) {
+    if (CACHE_LINE_SIZE % sizeof(T) != 0) return numCols;
+    size_t perLine = CACHE_LINE_SIZE / sizeof(T);
+    return (numCols + perLine - 1) / perLine * perLine;
+}
+
 template <typename T>
 uint Matrix<T>::size() const {
-    return data.size();
+    return rows;
 }
 
+/* Bit-packed Matrix<bool>, like the vector<bool> rows it replaces, but in a single BitMatrix.
+m[i][j] returns a proxy that converts to bool and can be assigned, as vector<bool>'s does */
+template <>
+class Matrix<bool> {
+public:
+    class Reference {
+    public:
+        Reference(BitMatrix& bits, uint row, uint col): bits(bits), row(row), col(col) {}
+        operator bool() const { return bits.get(row, col); }
+        Reference& operator = (bool value) { bits.set(row, col, value); return *this; }
+        Reference& operator = (const Reference& other) { return *this = (bool) other; }
+    private:
+        BitMatrix& bits;
+        uint row, col;
+    };
+    class RowView {
+    public:
+        RowView(BitMatrix& bits, uint row): bits(bits), row(row) {}
+        Reference operator [] (uint col) const { return Reference(bits, row, col); }
+        uint size() const { return bits.numCols(); }
+    private:
+        BitMatrix& bits;
+        uint row;
+    };
+    class ConstRowView {
+    public:
+        ConstRowView(const BitMatrix& bits, uint row): bits(bits), row(row) {}
+        bool operator [] (uint col) const { return bits.get(row, col); }
+        uint size() const { return bits.numCols(); }
+    private:
+        const BitMatrix& bits;
+        uint row;
+    };
+
+    Matrix() {}
+    Matrix(uint numberOfNodes): bits(numberOfNodes, numberOfNodes) {}
+    Matrix(uint numRows, uint numCols): bits(numRows, numCols) {}
+
+    RowView operator [] (uint row) { return RowView(bits, row); }
+    ConstRowView operator [] (uint row) const { return ConstRowView(bits, row); }
+
+    bool get(uint row, uint col) const { return bits.get(row, col); }
+    uint size() const { return bits.numRows(); }
+    bool empty() const { return bits.numRows() == 0; }
+    uint numRows() const { return bits.numRows(); }
+    uint numCols() const { return bits.numCols(); }
+    const BitMatrix& getBits() const { return bits; }
+
+private:
+    BitMatrix bits;
+};
+
 #endif /* MATRIX_HPP_ */
@@ -0,0 +1,149 @@
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <atomic>
+#include "Profiler.hpp"
+
+namespace {
+atomic<bool> enabled(false);
+mutex profileMutex;
+
+struct Phase { string name; double seconds; uint calls; };
+struct SampledFunction { string name; unsigned long long ticks, numSamples; };
+//vectors instead of maps to report the entries in the order they first appear
+vector<Phase> phases;
+vector<SampledFunction> sampledFunctions;
+vector<pair<string, double>> counters;
+vector<pair<string, string>> infos;
+
+string jsonString(const string& s) {
+    string res = "\"";
+    for (char c : s) {
+        if (c == '"' or c == '\\') res += '\\';
+        res += c;
+    }
+    return res+"\"";
+}
+}
+
+void Profiler::enable() { enabled = true; }
+bool Profiler::isEnabled() { return enabled; }
+
+void Profiler::addPhase(const string& name, double seconds) {
+    if (not enabled) return;
+    lock_guard<mutex> lock(profileMutex);
+    for (Phase& phase : phases) {
+        if (phase.name == name) {
+            phase.seconds += seconds;
+            phase.calls++;
+            return;
+        }
+    }
+    phases.push_back({name, seconds, 1});
+}
+
+void Profiler::addSampledFunction(const string& name, unsigned long long ticks, unsigned long long numSamples) {
+    if (not enabled or numSamples == 0) return;
+    lock_guard<mutex> lock(profileMutex);
+    for (SampledFunction& function : sampledFunctions) {
+        if (function.name == name) {
+            function.ticks += ticks;
+            function.numSamples += numSamples;
+            return;
+        }
+    }
+    sampledFunctions.push_back({name, ticks, numSamples});
+}
+
+void Profiler::addCounter(const string& name, double value) {
+    if (not enabled) return;
+    lock_guard<mutex> lock(profileMutex);
+    for (auto& counter : counters) {
+        if (counter.first == name) {
+            counter.second += value;
+            return;
+        }
+    }
+    counters.push_back({name, value});
+}
+
+void Profiler::setCounter(const string& name, double value) {
+    if (not enabled) return;
+    lock_guard<mutex> lock(profileMutex);
+    for (auto& counter : counters) {
+        if (counter.first == name) {
+            counter.second = value;
+            return;
+        }
+    }
+    counters.push_back({name, value});
+}
+
+double Profiler::getCounter(const string& name) {
+    lock_guard<mutex> lock(profileMutex);
+    for (auto& counter : counters) {
+        if (counter.first == name) return counter.second;
+    }
+    return 0;
+}
+
+void Profiler::setInfo(const string& name, const string& value) {
+    if (not enabled) return;
+    lock_guard<mutex> lock(profileMutex);
+    for (auto& info : infos) {
+        if (info.first == name) {
+            info.second = value;
+            return;
+        }
+    }
+    infos.push_back({name, value});
+}
+
+Profiler::ScopedPhase::ScopedPhase(const string& name): name(name), active(Profiler::isEnabled()) {
+    if (active) start = chrono::steady_clock::now();
+}
+
+Profiler::ScopedPhase::~ScopedPhase() { stop(); }
+
+void Profiler::ScopedPhase::stop() {
+    if (not active) return;
+    active = false;
+    chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+    Profiler::addPhase(name, elapsed.count());
+}
+
+string Profiler::tickUnit() {
+#if defined(__x86_64__) or defined(__i386__)
+    return "cycles";
+#else
+    return "nanoseconds";
+#endif
+}
+
+void Profiler::writeJSON(const string& fileName) {
+    if (not enabled) return;
+    lock_guard<mutex> lock(profileMutex);
+    ofstream ofs(fileName);
+    ofs << "{" << endl << "  \"phases\": [";
+    for (uint i = 0; i < phases.size(); i++) {
+        ofs << (i == 0 ? "" : ",") << endl << "    {\"name\": " << jsonString(phases[i].name)
+            << ", \"seconds\": " << phases[i].seconds << ", \"calls\": " << phases[i].calls << "}";
+    }
+    ofs << endl << "  ]," << endl << "  \"tickUnit\": " << jsonString(tickUnit()) << "," << endl;
+    ofs << "  \"sampledFunctions\": [";
+    for (uint i = 0; i < sampledFunctions.size(); i++) {
+        const SampledFunction& f = sampledFunctions[i];
+        ofs << (i == 0 ? "" : ",") << endl << "    {\"name\": " << jsonString(f.name)
+            << ", \"samples\": " << f.numSamples << ", \"meanTicks\": " << f.ticks/(double) f.numSamples << "}";
+    }
+    ofs << endl << "  ]," << endl << "  \"counters\": {";
+    for (uint i = 0; i < counters.size(); i++) {
+        ofs << (i == 0 ? "" : ",") << endl << "    " << jsonString(counters[i].first) << ": " << counters[i].second;
+    }
+    ofs << endl << "  }," << endl << "  \"info\": {";
+    for (uint i = 0; i < infos.size(); i++) {
+        ofs << (i == 0 ? "" : ",") << endl << "    " << jsonString(infos[i].first) << ": " << jsonString(infos[i].second);
+    }
+    ofs << endl << "  }" << endl << "}" << endl;
+    cout << "Profile saved as " << fileName << endl;
+}
@@ -0,0 +1,59 @@
+#ifndef PROFILER_HPP
+#define PROFILER_HPP
+#include <string>
+#include <vector>
+#include <utility>
+#include <chrono>
+#if defined(__x86_64__) or defined(__i386__)
+#include <x86intrin.h>
+#endif
+using namespace std;
+
+/* Process-wide profile of a run, enabled with -profile and saved as JSON next to the report.
+It has three kinds of entries:
+- phases: wall-clock time of the setup and search phases (graph loading, similarity matrices, etc.)
+- sampled functions: mean duration, in ticks, of functions too fast to time individually,
+  measured only on a sample of their calls (see SANA's delta functions)
+- counters: any other numbers (e.g., the accept ratio)
+- info: strings that describe the run (e.g., which SIMD kernel was chosen)
+When the profiler is not enabled, nothing is recorded. All functions are thread-safe */
+class Profiler {
+public:
+    static void enable();
+    static bool isEnabled();
+
+    //phases with the same name are added together
+    static void addPhase(const string& name, double seconds);
+    static void addSampledFunction(const string& name, unsigned long long ticks, unsigned long long numSamples);
+    static void addCounter(const string& name, double value);
+    static void setCounter(const string& name, double value);
+    static double getCounter(const string& name); //0 if it does not exist
+    static void setInfo(const string& name, const string& value);
+
+    //records the time between its construction and destruction as a phase
+    class ScopedPhase {
+    public:
+        ScopedPhase(const string& name);
+        ~ScopedPhase();
+        void stop(); //records the phase now instead of at destruction
+    private:
+        string name;
+        bool active;
+        chrono::steady_clock::time_point start;
+    };
+
+    //a cheap timestamp for sampled functions: CPU cycles on x86, nanoseconds elsewhere
+    static unsigned long long ticks() {
+#if defined(__x86_64__) or defined(__i386__)
+        return __rdtsc();
+#else
+        return chrono::duration_cast<chrono::nanoseconds>(
+                chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+    }
+    static string tickUnit();
+
+    static void writeJSON(const string& fileName);
+};
+
+#endif /* PROFILER_HPP */
@@ -0,0 +1,156 @@
+#include "QuantizedMatrix.hpp"
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#if defined(__x86_64__) and (defined(__GNUC__) or defined(__clang__))
+#include <immintrin.h>
+#define QUANTIZEDMATRIX_X86_KERNELS
+#endif
+
+using namespace std;
+
+SimPrecision parseSimPrecision(const string& name) {
+    if (name == "fp32") return SimPrecision::FP32;
+    if (name == "fp16") return SimPrecision::FP16;
+    if (name == "u8") return SimPrecision::U8;
+    throw runtime_error("unknown similarity precision '"+name+"' (should be fp32, fp16 or u8)");
+}
+
+string simPrecisionName(SimPrecision precision) {
+    switch (precision) {
+        case SimPrecision::FP32: return "fp32";
+        case SimPrecision::FP16: return "fp16";
+        default: return "u8";
+    }
+}
+
+uint16_t QuantizedMatrix::floatToHalf(float value) {
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    uint16_t sign = (bits >> 16) & 0x8000;
+    bits &= 0x7FFFFFFF;
+    if (bits > 0x7F800000) return sign | 0x7E00; //NaN
+    if (bits >= 0x477FF000) return sign | 0x7C00; //infinity, or rounds to it
+    if (bits < 0x38800000) { //below 2^-14, the smallest normal half
+        return bits >= 0x38000000 ? sign | 0x0400 : sign; //rounds to 2^-14 from 2^-15 up
+    }
+    uint32_t half = (((bits >> 23) - 112) << 10) | ((bits >> 13) & 0x3FF);
+    uint32_t rest = bits & 0x1FFF;
+    if (rest > 0x1000 or (rest == 0x1000 and (half & 1))) half++; //to nearest, ties to even
+    return sign | half;
+}
+
+QuantizedMatrix::QuantizedMatrix(): rows(0), cols(0), stride(0), precision(SimPrecision::FP32), scale(1), offset(0) {}
+
+QuantizedMatrix::QuantizedMatrix(const Matrix<float>& m, SimPrecision precision):
+    QuantizedMatrix(m.numRows(), m.numCols(), precision, [&m](uint i, vector<float>& values) {
+        copy(m[i].begin(), m[i].end(), values.begin());
+    }) {}
+
+QuantizedMatrix::QuantizedMatrix(uint numRows, uint numCols, SimPrecision precision,
+        const function<void(uint, vector<float>&)>& row):
+            rows(numRows), cols(numCols), precision(precision), scale(1), offset(0) {
+    if (precision == SimPrecision::FP32) throw runtime_error("QuantizedMatrix: use a Matrix<float> for fp32");
+    size_t entrySize = precision == SimPrecision::U8 ? 1 : 2;
+    size_t entriesPerBlock = CACHE_LINE_SIZE / entrySize;
+    stride = (numCols + entriesPerBlock - 1) / entriesPerBlock * entriesPerBlock;
+
+    vector<float> values(numCols);
+    float smallest = numeric_limits<float>::infinity(), largest = -smallest;
+    for (uint i = 0; i < rows; i++) {
+        row(i, values);
+        for (float value : values) {
+            if (not isfinite(value)) continue;
+            smallest = min(smallest, value);
+            largest = max(largest, value);
+        }
+    }
+    if (smallest > largest) smallest = largest = 0; //no finite values
+
+    if (precision == SimPrecision::U8) {
+        offset = smallest;
+        scale = (largest - smallest) / 255;
+        bytes = vector<uint8_t, AlignedAllocator<uint8_t>> ((size_t) rows * stride, 0);
+    } else {
+        scale = max(abs(smallest), abs(largest));
+        if (scale == 0) scale = 1;
+        halves = vector<uint16_t, AlignedAllocator<uint16_t>> ((size_t) rows * stride, 0);
+    }
+    for (uint i = 0; i < rows; i++) {
+        row(i, values);
+        size_t first = (size_t) i * stride;
+        for (uint j = 0; j < numCols; j++) {
+            if (precision == SimPrecision::U8) {
+                float q = scale > 0 ? round((values[j] - offset) / scale) : 0;
+                bytes[first+j] = q >= 0 and q <= 255 ? (uint8_t) q : (q > 255 ? 255 : 0); //NaN fails both
+            } else {
+                halves[first+j] = floatToHalf(values[j] / scale);
+            }
+        }
+    }
+}
+
+typedef void (*DequantizeU8Function)(const uint8_t*, uint, float, float, float*);
+typedef void (*DequantizeFP16Function)(const uint16_t*, uint, float, float*);
+
+static void dequantizeU8Scalar(const uint8_t* in, uint count, float scale, float offset, float* out) {
+    for (uint i = 0; i < count; i++) out[i] = offset + scale * in[i];
+}
+
+static void dequantizeFP16Scalar(const uint16_t* in, uint count, float scale, float* out) {
+    for (uint i = 0; i < count; i++) out[i] = scale * QuantizedMatrix::halfToFloat(in[i]);
+}
+
+#ifdef QUANTIZEDMATRIX_X86_KERNELS
+__attribute__((target("avx2")))
+static void dequantizeU8AVX2(const uint8_t* in, uint count, float scale, float offset, float* out) {
+    const __m256 scales = _mm256_set1_ps(scale), offsets = _mm256_set1_ps(offset);
+    uint i = 0;
+    for (; i+8 <= count; i += 8) {
+        __m256i q = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*) (in+i)));
+        __m256 value = _mm256_add_ps(offsets, _mm256_mul_ps(scales, _mm256_cvtepi32_ps(q)));
+        _mm256_storeu_ps(out+i, value);
+    }
+    dequantizeU8Scalar(in+i, count-i, scale, offset, out+i);
+}
+
+__attribute__((target("avx2,f16c")))
+static void dequantizeFP16AVX2(const uint16_t* in, uint count, float scale, float* out) {
+    const __m256 scales = _mm256_set1_ps(scale);
+    uint i = 0;
+    for (; i+8 <= count; i += 8) {
+        __m256 value = _mm256_cvtph_ps(_mm_loadu_si128((const __m128i*) (in+i)));
+        _mm256_storeu_ps(out+i, _mm256_mul_ps(scales, value));
+    }
+    dequantizeFP16Scalar(in+i, count-i, scale, out+i);
+}
+#endif
+
+static bool selectDequantizeKernels(DequantizeU8Function& u8, DequantizeFP16Function& fp16, string& name) {
+#ifdef QUANTIZEDMATRIX_X86_KERNELS
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2") and __builtin_cpu_supports("f16c")) {
+        u8 = dequantizeU8AVX2;
+        fp16 = dequantizeFP16AVX2;
+        name = "avx2";
+        return true;
+    }
+#endif
+    u8 = dequantizeU8Scalar;
+    fp16 = dequantizeFP16Scalar;
+    name = "scalar";
+    return false;
+}
+
+static DequantizeU8Function dequantizeU8Impl;
+static DequantizeFP16Function dequantizeFP16Impl;
+static string dequantizeRowName;
+static const bool dequantizeUsesSimd = selectDequantizeKernels(dequantizeU8Impl, dequantizeFP16Impl, dequantizeRowName);
+
+void QuantizedMatrix::dequantizeRow(uint row, float* out) const {
+    size_t first = (size_t) row * stride;
+    if (precision == SimPrecision::U8) dequantizeU8Impl(&bytes[first], cols, scale, offset, out);
+    else dequantizeFP16Impl(&halves[first], cols, scale, out);
+}
+
+string dequantizeRowImplementation() { return dequantizeRowName; }
@@ -0,0 +1,80 @@
+#ifndef QUANTIZEDMATRIX_HPP_
+#define QUANTIZEDMATRIX_HPP_
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+#include <string>
+#include <functional>
+#include "Matrix.hpp"
+#include "AlignedAllocator.hpp"
+
+using namespace std;
+
+//precision of the stored similarity matrices (-simPrecision)
+enum class SimPrecision { FP32, FP16, U8 };
+//"fp32", "fp16" or "u8"; throws runtime_error for anything else
+SimPrecision parseSimPrecision(const string& name);
+string simPrecisionName(SimPrecision precision);
+
+/* Matrix of floats stored in reduced precision, with a single scale for the whole matrix:
+ - FP16: each entry is a 16-bit float holding entry/scale, where scale is the largest absolute
+   value in the matrix, so that the stored values are in [-1, 1] (about 3 significant digits).
+ - U8: each entry is an 8-bit integer q such that entry = offset + q*scale, where offset is the
+   smallest entry and scale = (largest - smallest)/255. NaN entries become the smallest entry.
+It takes 2 or 4 times less memory than a Matrix<float>, so more of it fits in the caches.
+get() dequantizes a single entry; dequantizeRow() a whole row, with AVX2 (and F16C for FP16)
+on CPUs that have them (the implementation is chosen at startup).
+Like Matrix, rows are padded to 64-byte blocks. It cannot be modified after it is built */
+class QuantizedMatrix {
+public:
+    QuantizedMatrix();
+    //precision should be FP16 or U8
+    QuantizedMatrix(const Matrix<float>& m, SimPrecision precision);
+    //row(i, values) should write the numCols entries of row i in values (which already has size numCols);
+    //it is called twice for each row: once to find the range of the values and once to store them
+    QuantizedMatrix(uint numRows, uint numCols, SimPrecision precision,
+                    const function<void(uint, vector<float>&)>& row);
+
+    float get(uint row, uint col) const {
+        size_t i = (size_t) row * stride + col;
+        if (precision == SimPrecision::U8) return offset + scale * bytes[i];
+        return scale * halfToFloat(halves[i]);
+    }
+    //writes the numCols() entries of the row in out
+    void dequantizeRow(uint row, float* out) const;
+
+    uint numRows() const { return rows; }
+    uint numCols() const { return cols; }
+    bool empty() const { return rows == 0; }
+    SimPrecision getPrecision() const { return precision; }
+
+    //without branches, except the select for NaN, which is not taken for similarities.
+    //floatToHalf never produces subnormal halves, so the multiplication never has a subnormal operand (which is slow)
+    static float halfToFloat(uint16_t half) {
+        uint32_t bits = (uint32_t) (half & 0x7FFF) << 13;
+        float res;
+        memcpy(&res, &bits, sizeof(res));
+        res *= 5.192296858534828e33f; //2^112, the difference between the exponent biases
+        memcpy(&bits, &res, sizeof(res));
+        if (res >= 65536.0f) bits |= 0xFF << 23; //infinity or NaN
+        bits |= (uint32_t) (half & 0x8000) << 16;
+        memcpy(&res, &bits, sizeof(res));
+        return res;
+    }
+    //rounds to the nearest 16-bit float; values smaller than the smallest normal one (2^-14) round to it or to 0
+    static uint16_t floatToHalf(float value);
+
+private:
+    uint rows, cols;
+    size_t stride; //entries per row, including the padding
+    SimPrecision precision;
+    float scale, offset;
+    vector<uint8_t, AlignedAllocator<uint8_t>> bytes; //U8
+    vector<uint16_t, AlignedAllocator<uint16_t>> halves; //FP16
+};
+
+//name of the implementation of QuantizedMatrix::dequantizeRow in use ("avx2" or "scalar")
+string dequantizeRowImplementation();
+
+#endif /* QUANTIZEDMATRIX_HPP_ */
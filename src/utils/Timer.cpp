@@ -9,8 +9,8 @@ using namespace std;
 
 Timer::Timer() {}
 
-void Timer::start() {
-    startTime = get();
+void Timer::start(double alreadyElapsed) {
+    startTime = get() - (long long) (alreadyElapsed*1000);
 }
 
 double Timer::elapsed() const {
@@ -7,7 +7,7 @@ class Timer {
 public:
     Timer();
 
-    void start();
+    void start(double alreadyElapsed = 0); //alreadyElapsed: seconds to count as already elapsed
     double elapsed() const;
     string elapsedString() const;
 
@@ -0,0 +1,66 @@
+#include "TopKSimMatrix.hpp"
+#include <algorithm>
+#include <stdexcept>
+#include <limits>
+#include <cmath>
+
+using namespace std;
+
+TopKSimMatrix::TopKSimMatrix(): rows(0), numColumns(0), k(0) {}
+
+TopKSimMatrix::TopKSimMatrix(uint numRows, uint numCols, uint k,
+        const function<void(uint, vector<float>&)>& row):
+            rows(numRows), numColumns(numCols), k(min(k, numCols)) {
+    if (k == 0) throw runtime_error("TopKSimMatrix: k should be positive");
+    cols = vector<uint> ((size_t) rows * this->k);
+    values = vector<float> ((size_t) rows * this->k);
+    floors = vector<float> (rows, 0);
+    if (this->k == 0) return; //no columns
+
+    vector<float> rowValues(numCols);
+    vector<uint> order(numCols);
+    //NaN entries are ranked last, so that the comparison is a strict weak ordering
+    auto rank = [&rowValues](uint j) {
+        float value = rowValues[j];
+        return value == value ? value : -numeric_limits<float>::infinity();
+    };
+    for (uint i = 0; i < rows; i++) {
+        row(i, rowValues);
+        for (uint j = 0; j < numCols; j++) order[j] = j;
+        //largest values first; ties are broken by column so that the result does not depend on the sort
+        nth_element(order.begin(), order.begin() + (this->k - 1), order.end(), [&](uint a, uint b) {
+            return rank(a) > rank(b) or (rank(a) == rank(b) and a < b);
+        });
+        sort(order.begin(), order.begin() + this->k);
+
+        double rowSum = 0, keptSum = 0;
+        uint numFinite = 0, numKeptFinite = 0;
+        for (uint j = 0; j < numCols; j++) {
+            if (isfinite(rowValues[j])) {
+                rowSum += rowValues[j];
+                numFinite++;
+            }
+        }
+        size_t first = (size_t) i * this->k;
+        for (uint j = 0; j < this->k; j++) {
+            cols[first+j] = order[j];
+            values[first+j] = rowValues[order[j]];
+            if (isfinite(rowValues[order[j]])) {
+                keptSum += rowValues[order[j]];
+                numKeptFinite++;
+            }
+        }
+        if (numFinite > numKeptFinite) floors[i] = (rowSum - keptSum) / (numFinite - numKeptFinite);
+    }
+}
+
+TopKSimMatrix::TopKSimMatrix(const Matrix<float>& dense, uint k):
+    TopKSimMatrix(dense.numRows(), dense.numCols(), k, [&dense](uint i, vector<float>& rowValues) {
+        copy(dense[i].begin(), dense[i].end(), rowValues.begin());
+    }) {}
+
+void TopKSimMatrix::getRow(uint row, float* out) const {
+    fill(out, out + numColumns, floors[row]);
+    size_t first = (size_t) row * k;
+    for (uint j = 0; j < k; j++) out[cols[first+j]] = values[first+j];
+}
@@ -0,0 +1,45 @@
+#include "Xoshiro256.hpp"
+
+Xoshiro256::Xoshiro256(uint64_t seed, uint64_t stream) {
+    this->seed(seed, stream);
+}
+
+//the state is initialized with splitmix64, as recommended by the authors of xoshiro,
+//because xoshiro behaves poorly with states that are mostly 0s
+void Xoshiro256::seed(uint64_t seed, uint64_t stream) {
+    uint64_t x = seed;
+    for (int i = 0; i < 4; i++) {
+        uint64_t z = (x += 0x9e3779b97f4a7c15ULL);
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+        s[i] = z ^ (z >> 31);
+    }
+    for (uint64_t i = 0; i < stream; i++) jump();
+}
+
+void Xoshiro256::jump() {
+    static const uint64_t JUMP[] = { 0x180ec6d33cfd0abaULL, 0xd5a61266f0c9392cULL,
+                                     0xa9582618e03fc9aaULL, 0x39abdc4529b1661cULL };
+    uint64_t s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+    for (int i = 0; i < 4; i++) {
+        for (int b = 0; b < 64; b++) {
+            if (JUMP[i] & (1ULL << b)) {
+                s0 ^= s[0];
+                s1 ^= s[1];
+                s2 ^= s[2];
+                s3 ^= s[3];
+            }
+            (*this)();
+        }
+    }
+    s[0] = s0;
+    s[1] = s1;
+    s[2] = s2;
+    s[3] = s3;
+}
+
+const uint64_t* Xoshiro256::getState() const { return s; }
+
+void Xoshiro256::setState(const uint64_t state[4]) {
+    for (int i = 0; i < 4; i++) s[i] = state[i];
+}
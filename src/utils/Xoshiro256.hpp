@@ -0,0 +1,69 @@
+#ifndef XOSHIRO256_HPP
+#define XOSHIRO256_HPP
+#include <cstdint>
+#include <limits>
+using namespace std;
+
+/* xoshiro256** pseudo-random number generator (Blackman and Vigna)
+It is much faster than mt19937 and has a much smaller state (32 bytes), which matters
+in SANA's main loop, where every iteration draws several random numbers.
+Use boundedInt and real01 rather than the standard distributions: they are faster, and
+some versions of libstdc++ reject distributions over a 64-bit generator in strict ANSI mode.
+
+Streams: the generators constructed with the same seed and different stream numbers
+start 2^128 numbers apart in the same sequence, so they never overlap in practice.
+This is used to give independent generators to parallel SANA chains from a single seed */
+class Xoshiro256 {
+public:
+    typedef uint64_t result_type;
+
+    Xoshiro256(uint64_t seed = 0, uint64_t stream = 0);
+    void seed(uint64_t seed, uint64_t stream = 0);
+
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return numeric_limits<uint64_t>::max(); }
+
+    //the functions below are defined in the header so that they can be inlined
+    result_type operator()() {
+        const uint64_t result = rotl(s[1] * 5, 7) * 9;
+        const uint64_t t = s[1] << 17;
+        s[2] ^= s[0];
+        s[3] ^= s[1];
+        s[1] ^= s[2];
+        s[0] ^= s[3];
+        s[2] ^= t;
+        s[3] = rotl(s[3], 45);
+        return result;
+    }
+
+    //uniformly random integer in [0, range-1], for range > 0
+    //Lemire's nearly divisionless method: a division is only needed in a tiny fraction of the calls
+    uint32_t boundedInt(uint32_t range) {
+        uint64_t m = ((*this)() >> 32) * (uint64_t) range;
+        uint32_t low = (uint32_t) m;
+        if (low < range) {
+            uint32_t threshold = -range % range;
+            while (low < threshold) {
+                m = ((*this)() >> 32) * (uint64_t) range;
+                low = (uint32_t) m;
+            }
+        }
+        return m >> 32;
+    }
+
+    //uniformly random real in [0, 1), with 53 random bits
+    double real01() {
+        return ((*this)() >> 11) * (1.0 / 9007199254740992.0); //2^-53
+    }
+
+    //the full state, for checkpointing
+    const uint64_t* getState() const;
+    void setState(const uint64_t state[4]);
+
+private:
+    uint64_t s[4];
+    static uint64_t rotl(const uint64_t x, int k) { return (x << k) | (x >> (64 - k)); }
+    void jump(); //equivalent to 2^128 calls
+};
+
+#endif /* XOSHIRO256_HPP */
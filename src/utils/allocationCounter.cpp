@@ -0,0 +1,31 @@
+#include "allocationCounter.hpp"
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+using namespace std;
+
+#ifdef COUNT_ALLOCATIONS
+
+static atomic<unsigned long long> allocationCount(0);
+
+void* operator new(size_t size) {
+    allocationCount.fetch_add(1, memory_order_relaxed);
+    void* p = malloc(size == 0 ? 1 : size);
+    if (not p) throw bad_alloc();
+    return p;
+}
+
+void* operator new[](size_t size) { return operator new(size); }
+void operator delete(void* p) noexcept { free(p); }
+void operator delete[](void* p) noexcept { free(p); }
+void operator delete(void* p, size_t) noexcept { free(p); }
+void operator delete[](void* p, size_t) noexcept { free(p); }
+
+unsigned long long numAllocations() { return allocationCount.load(); }
+
+#else
+
+unsigned long long numAllocations() { return 0; }
+
+#endif
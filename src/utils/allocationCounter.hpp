@@ -0,0 +1,10 @@
+#ifndef ALLOCATIONCOUNTER_HPP
+#define ALLOCATIONCOUNTER_HPP
+
+//number of calls to the global operator new since the program started.
+//allocations are only counted in builds with "make ALLOCS=1" (-DCOUNT_ALLOCATIONS),
+//which replaces the global operator new. Otherwise, this always returns 0.
+//used to check that SANA's main loop doesn't allocate memory
+unsigned long long numAllocations();
+
+#endif
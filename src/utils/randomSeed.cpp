@@ -1,5 +1,6 @@
 #include "randomSeed.hpp"
 #include <random>
+#include <ctime>
 #include <unistd.h>
 
 using namespace std;
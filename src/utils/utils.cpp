@@ -1,5 +1,6 @@
 #include "utils.hpp"
 #include <random>
+#include <limits>
 #include <vector>
 #include <ctime>
 #include <map>
@@ -7,6 +8,8 @@
 #include <cstdlib>
 #include <iostream>
 #include <sstream>
+#include <fstream>
+#include <iomanip>
 #include <cstdio>
 #include <set>
 #include <algorithm>
@@ -21,16 +24,56 @@ const string AUTOGENEREATED_FILES_FOLDER = "autogenerated/";
 // Note you can't just do (x!=x), because that's always false, NAN or not.
 bool myNan(double x) { return !(x==x); }
 
+//the generators of thread 0 are seeded with the seed alone, which gives the same numbers as
+//when there was a single generator of each kind. those of thread t > 0 also depend on t and on which
+//of the two generators it is, so no two threads or generators share a sequence
+static mt19937 seededGenerator(uint threadIndex, uint stream) {
+    if (threadIndex == 0) return mt19937(getRandomSeed());
+    seed_seq seq{getRandomSeed(), threadIndex, stream};
+    return mt19937(seq);
+}
+
+struct ThreadGenerators {
+    uint index = 0;
+    bool seeded = false;
+    mt19937 intGen, realGen;
+};
+static thread_local ThreadGenerators threadGenerators;
+
+static mt19937& threadGenerator(bool real) {
+    ThreadGenerators& gens = threadGenerators;
+    if (not gens.seeded) {
+        gens.intGen = seededGenerator(gens.index, 0);
+        gens.realGen = seededGenerator(gens.index, 1);
+        gens.seeded = true;
+    }
+    return real ? gens.realGen : gens.intGen;
+}
+
+void setRandomThreadIndex(uint index) {
+    threadGenerators.index = index;
+    threadGenerators.seeded = false;
+}
+
 double randDouble() {
-    static mt19937 gen(getRandomSeed());
-    static uniform_real_distribution<> realDis(0, 1);
-    return realDis(gen);
+    uniform_real_distribution<> realDis(0, 1);
+    return realDis(threadGenerator(true));
 }
 
+//same as uniform_int_distribution<>(low, high) in libstdc++ (Lemire's method over the 32-bit outputs
+//of mt19937), which cannot be used with the Makefile's flags: it instantiates a 128-bit path that
+//does not compile with -U__STRICT_ANSI__ and -std=c++11
 int randInt(int low, int high) {
-    static mt19937 gen(getRandomSeed());
-    uniform_int_distribution<> dis(low, high);
-    return dis(gen);
+    mt19937& gen = threadGenerator(false);
+    uint32_t range = (uint32_t) high - (uint32_t) low;
+    if (range == numeric_limits<uint32_t>::max()) return (int) ((uint32_t) low + (uint32_t) gen());
+    uint32_t numValues = range + 1;
+    uint64_t m = (uint64_t) (uint32_t) gen() * numValues;
+    if ((uint32_t) m < numValues) {
+        uint32_t threshold = -numValues % numValues;
+        while ((uint32_t) m < threshold) m = (uint64_t) (uint32_t) gen() * numValues;
+    }
+    return (int) ((uint32_t) low + (uint32_t) (m >> 32));
 }
 
 int randMod(int n) { return randInt(0, n-1); }
@@ -75,6 +118,39 @@ string currentDateTime() {
     return buf;
 }
 
+uint64_t hashBytes(const void* data, size_t numBytes, uint64_t hash) {
+    const unsigned char* bytes = (const unsigned char*) data;
+    for (size_t i = 0; i < numBytes; i++) {
+        hash ^= bytes[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+uint64_t hashString(const string& s, uint64_t hash) {
+    //the length is included so that, e.g., ("ab","c") and ("a","bc") hash differently
+    uint64_t len = s.size();
+    hash = hashBytes(&len, sizeof(len), hash);
+    return hashBytes(s.data(), s.size(), hash);
+}
+
+string hashToHex(uint64_t hash) {
+    ostringstream oss;
+    oss << hex << setw(16) << setfill('0') << hash;
+    return oss.str();
+}
+
+string cpuModelName() {
+    ifstream ifs("/proc/cpuinfo");
+    string line;
+    while (getline(ifs, line)) {
+        if (line.compare(0, 10, "model name") != 0) continue;
+        size_t pos = line.find(':');
+        if (pos != string::npos and pos+2 <= line.size()) return line.substr(pos+2);
+    }
+    return "unknown";
+}
+
 void normalizeWeights(vector<double>& weights) {
     double sum = 0;
     uint n = weights.size();
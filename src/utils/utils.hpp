@@ -19,8 +19,13 @@ typedef uint32_t uint;
 
 bool myNan(double x);
 
+//randDouble and randInt draw from separate generators, and each thread has its own ones
 double randDouble();
 int randInt(int low, int high);
+//the generators of the calling thread are seeded from the seed and this index, so that runs are
+//reproducible for a given seed. The main thread has index 0; each thread started by SANA that may
+//draw random numbers sets a distinct index before drawing any
+void setRandomThreadIndex(uint index);
 int randMod(int n);
 void randomShuffle(vector<uint>& v);
 
@@ -35,6 +40,13 @@ void printTable(const vector<vector<string>>& table, int colSeparation, ostream&
 
 string currentDateTime();
 
+//64-bit FNV-1a hash of 'numBytes' bytes. to hash several pieces together,
+//pass the hash of the previous pieces as 'hash'. not meant for security, only to identify data
+uint64_t hashBytes(const void* data, size_t numBytes, uint64_t hash = 14695981039346656037ULL);
+uint64_t hashString(const string& s, uint64_t hash = 14695981039346656037ULL);
+string hashToHex(uint64_t hash); //16 hex digits, usable in file names
+string cpuModelName(); //as reported in /proc/cpuinfo, or "unknown" if not available
+
 string exec(string cmd);
 string execWithoutPrintingErr(string cmd);
 void execPrintOutput(string cmd);